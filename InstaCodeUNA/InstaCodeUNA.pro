@@ -1,4 +1,4 @@
-QT += core gui widgets
+QT += core gui widgets concurrent
 
 CONFIG += c++17 console
 CONFIG -= app_bundle
@@ -7,9 +7,18 @@ TARGET = InstaCodeUNA
 
 SOURCES += main.cpp \
            window.cpp \
-           parser.cpp
+           parser.cpp \
+           interpreter.cpp \
+           runner.cpp \
+           batch.cpp \
+           complexity.cpp
 
 HEADERS += window.h \
-           parser.h
+           parser.h \
+           interpreter.h \
+           runner.h \
+           batch.h \
+           complexity.h \
+           vocabulary.h
 
 RESOURCES += resources.qrc
\ No newline at end of file
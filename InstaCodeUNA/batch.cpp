@@ -0,0 +1,304 @@
+#include "batch.h"
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <cstring>
+
+#include "complexity.h"
+#include "interpreter.h"
+#include "parser.h"
+#include "runner.h"
+
+namespace
+{
+
+    bool readText(const QString &path, QString &contents)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            return false;
+        }
+        QTextStream in(&file);
+        contents = in.readAll();
+        return true;
+    }
+
+    bool writeText(const QString &path, const QString &contents)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            return false;
+        }
+        QTextStream out(&file);
+        out << contents;
+        return true;
+    }
+
+    QString indented(const QString &text)
+    {
+        QStringList lines = text.split('\n');
+        while (!lines.isEmpty() && lines.last().isEmpty())
+        {
+            lines.removeLast();
+        }
+        for (QString &line : lines)
+        {
+            line.prepend(QStringLiteral("    "));
+        }
+        return lines.join('\n');
+    }
+
+}
+
+bool Batch::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--batch") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int Batch::run(const QStringList &arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Convierte instrucciones en lenguaje natural a C++ sin abrir la interfaz."));
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption(QStringLiteral("batch"), QStringLiteral("Ejecuta en modo por lotes.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("datos"), QStringLiteral("Archivo de datos para las instrucciones."), QStringLiteral("archivo")));
+    parser.addOption(QCommandLineOption(QStringLiteral("entrada"), QStringLiteral("Entrada estándar para los programas ejecutados."), QStringLiteral("archivo")));
+    parser.addOption(QCommandLineOption(QStringLiteral("salida"), QStringLiteral("Directorio donde guardar cada .cpp generado."), QStringLiteral("directorio")));
+    parser.addOption(QCommandLineOption(QStringLiteral("varios-archivos"), QStringLiteral("Guarda cada programa como un directorio con un archivo por función, tabla de datos y main.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("perfil"), QStringLiteral("Instrumenta cada línea de instrucciones y muestra las más costosas tras ejecutar.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("complejidad"), QStringLiteral("Estima la complejidad ejecutando cada programa con tamaños crecientes.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("generador"), QStringLiteral("Comando que recibe el tamaño n y escribe la entrada del programa (para --complejidad)."), QStringLiteral("comando")));
+    parser.addOption(QCommandLineOption(QStringLiteral("ejecutar"), QStringLiteral("Compila y ejecuta cada programa generado.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("interpretar"), QStringLiteral("Ejecuta cada programa generado con el intérprete integrado, sin compilarlo.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("compilador"), QStringLiteral("g++ o clang++ (por defecto el primero disponible)."), QStringLiteral("nombre")));
+    parser.addOption(QCommandLineOption(QStringLiteral("optimizacion"), QStringLiteral("Nivel de optimización: 0, 2 o 3 (3 incluye -march=native)."), QStringLiteral("nivel"), QStringLiteral("2")));
+    parser.addOption(QCommandLineOption(QStringLiteral("sin-cache"), QStringLiteral("Compila siempre, sin reutilizar binarios de la caché.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("pch"), QStringLiteral("Usa un encabezado paraguas precompilado y reutilizable entre programas.")));
+    parser.addOption(QCommandLineOption(QStringLiteral("tiempo"), QStringLiteral("Límite de tiempo real por programa en ms."), QStringLiteral("ms"), QStringLiteral("10000")));
+    parser.addPositionalArgument(QStringLiteral("archivos"), QStringLiteral("Archivos .txt con instrucciones."), QStringLiteral("archivo.txt..."));
+    parser.process(arguments);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty())
+    {
+        err << "No se indicó ningún archivo de instrucciones.\n";
+        return 2;
+    }
+
+    Parser::Input parserInput;
+    if (parser.isSet(QStringLiteral("datos")))
+    {
+        const QString dataPath = parser.value(QStringLiteral("datos"));
+        if (!readText(dataPath, parserInput.dataFileContents))
+        {
+            err << "No se pudo leer el archivo de datos " << dataPath << ".\n";
+            return 2;
+        }
+        parserInput.dataFileName = QFileInfo(dataPath).fileName();
+    }
+    parserInput.umbrellaHeader = parser.isSet(QStringLiteral("pch"));
+    parserInput.multipleFiles = parser.isSet(QStringLiteral("varios-archivos"));
+    parserInput.profile = parser.isSet(QStringLiteral("perfil"));
+
+    Runner::Input runnerInput;
+    if (parser.isSet(QStringLiteral("entrada")) && !readText(parser.value(QStringLiteral("entrada")), runnerInput.standardInput))
+    {
+        err << "No se pudo leer la entrada " << parser.value(QStringLiteral("entrada")) << ".\n";
+        return 2;
+    }
+    const QString compiler = parser.value(QStringLiteral("compilador"));
+    if (compiler == QStringLiteral("g++") || compiler == QStringLiteral("gcc"))
+    {
+        runnerInput.compiler = Runner::Compiler::Gcc;
+    }
+    else if (compiler == QStringLiteral("clang++") || compiler == QStringLiteral("clang"))
+    {
+        runnerInput.compiler = Runner::Compiler::Clang;
+    }
+    const QString level = parser.value(QStringLiteral("optimizacion"));
+    runnerInput.optimization = level == QStringLiteral("0") ? Runner::OptimizationLevel::O0
+                             : level == QStringLiteral("3") ? Runner::OptimizationLevel::O3Native
+                                                            : Runner::OptimizationLevel::O2;
+    runnerInput.timeLimitMs = qMax(1, parser.value(QStringLiteral("tiempo")).toInt());
+    runnerInput.useCache = !parser.isSet(QStringLiteral("sin-cache"));
+
+    const QString outputDirectory = parser.value(QStringLiteral("salida"));
+    if (!outputDirectory.isEmpty() && !QDir().mkpath(outputDirectory))
+    {
+        err << "No se pudo crear el directorio " << outputDirectory << ".\n";
+        return 2;
+    }
+
+    const bool execute = parser.isSet(QStringLiteral("ejecutar"));
+    const bool interpret = parser.isSet(QStringLiteral("interpretar"));
+    const bool estimateComplexity = parser.isSet(QStringLiteral("complejidad"));
+    int failures = 0;
+    QStringList umbrellaIncludes;
+    for (const QString &path : files)
+    {
+        out << "== " << path << '\n';
+        if (!readText(path, parserInput.instructions))
+        {
+            out << "No se pudo leer el archivo.\n";
+            ++failures;
+            continue;
+        }
+
+        const Parser::Output converted = Parser::convert(parserInput);
+        out << (converted.success ? "Conversión correcta" : "Conversión incompleta");
+        if (!converted.issues.isEmpty())
+        {
+            out << " (" << converted.issues.size() << " observaciones)";
+        }
+        out << '\n';
+        for (const QString &issue : converted.issues)
+        {
+            out << "  - " << issue << '\n';
+        }
+        for (const Parser::Diagnostic &diagnostic : converted.diagnostics)
+        {
+            out << "  ~ " << Parser::describeDiagnostic(diagnostic) << '\n';
+        }
+        if (!outputDirectory.isEmpty())
+        {
+            if (parserInput.multipleFiles)
+            {
+                const QDir project(QDir(outputDirectory).filePath(QFileInfo(path).completeBaseName()));
+                project.mkpath(QStringLiteral("."));
+                QList<Parser::SourceFile> sourceFiles = converted.files;
+                if (parserInput.umbrellaHeader)
+                {
+                    sourceFiles.append({Parser::umbrellaHeaderName(), Parser::umbrellaHeaderContents(converted.includes)});
+                }
+                for (const Parser::SourceFile &source : sourceFiles)
+                {
+                    if (!writeText(project.filePath(source.name), source.contents))
+                    {
+                        out << "No se pudo guardar " << project.filePath(source.name) << ".\n";
+                    }
+                }
+            }
+            else
+            {
+                const QString target = QDir(outputDirectory).filePath(QFileInfo(path).completeBaseName() + QStringLiteral(".cpp"));
+                if (!writeText(target, converted.code))
+                {
+                    out << "No se pudo guardar " << target << ".\n";
+                }
+            }
+            umbrellaIncludes << converted.includes;
+        }
+        if (!converted.success)
+        {
+            ++failures;
+            continue;
+        }
+        if (estimateComplexity)
+        {
+            Complexity::Input complexityInput;
+            complexityInput.program = parserInput;
+            complexityInput.runner = runnerInput;
+            complexityInput.standardInput = runnerInput.standardInput;
+            complexityInput.generatorCommand = parser.value(QStringLiteral("generador"));
+            const Complexity::Output complexity = Complexity::estimate(complexityInput);
+            out << indented(Complexity::describe(complexity)) << '\n';
+            for (const QString &error : complexity.errors)
+            {
+                out << "  ! " << error << '\n';
+            }
+            if (!complexity.success)
+            {
+                ++failures;
+                continue;
+            }
+        }
+        if (interpret)
+        {
+            Interpreter::Input interpreterInput;
+            interpreterInput.code = converted.code;
+            interpreterInput.standardInput = runnerInput.standardInput;
+            QElapsedTimer timer;
+            timer.start();
+            const Interpreter::Output result = Interpreter::run(interpreterInput);
+            out << "Intérprete: " << result.executedInstructions << " instrucciones en " << timer.elapsed() << " ms\n";
+            for (const QString &error : result.errors)
+            {
+                out << "  ! " << error << '\n';
+            }
+            if (!result.standardOutput.isEmpty())
+            {
+                out << "Salida:\n" << indented(result.standardOutput) << '\n';
+            }
+            if (!result.success)
+            {
+                ++failures;
+            }
+            continue;
+        }
+        if (!execute)
+        {
+            continue;
+        }
+
+        runnerInput.code = converted.code;
+        runnerInput.includes = converted.includes;
+        const Runner::Output result = Runner::run(runnerInput);
+        out << Runner::describe(result) << '\n';
+        for (const QString &error : result.errors)
+        {
+            out << "  ! " << error << '\n';
+        }
+        if (!result.compiled && !result.compilerMessages.isEmpty())
+        {
+            out << indented(result.compilerMessages) << '\n';
+        }
+        if (!result.standardOutput.isEmpty())
+        {
+            out << "Salida:\n" << indented(result.standardOutput) << '\n';
+        }
+        if (!result.profile.isEmpty())
+        {
+            out << "Perfil:\n" << indented(Runner::describeProfile(result.profile, 5)) << '\n';
+        }
+        if (!result.success)
+        {
+            ++failures;
+        }
+    }
+
+    // Un solo encabezado paraguas sirve a todos los .cpp guardados en el directorio.
+    if (parserInput.umbrellaHeader && !parserInput.multipleFiles && !outputDirectory.isEmpty())
+    {
+        umbrellaIncludes.removeDuplicates();
+        umbrellaIncludes.sort();
+        const QString header = QDir(outputDirectory).filePath(Parser::umbrellaHeaderName());
+        if (!writeText(header, Parser::umbrellaHeaderContents(umbrellaIncludes)))
+        {
+            out << "No se pudo guardar " << header << ".\n";
+        }
+    }
+
+    out << files.size() - failures << " de " << files.size() << " archivos procesados sin errores.\n";
+    if ((execute || estimateComplexity) && runnerInput.useCache)
+    {
+        const Runner::CacheStatistics cache = Runner::cacheStatistics();
+        out << "Caché de compilación: " << cache.hits << " aciertos, " << cache.misses << " fallos.\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
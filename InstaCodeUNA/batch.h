@@ -0,0 +1,12 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <QStringList>
+
+class Batch {
+public:
+    static bool isRequested(int argc, char *argv[]);
+    static int run(const QStringList &arguments);
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include "complexity.h"
+
+#include <QProcess>
+#include <QRegularExpression>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+    const QRegularExpression &sizeExpression()
+    {
+        static const QRegularExpression sizeRe(QStringLiteral("\\bcon\\s+(\\d+)\\s+elementos\\b"),
+                                               QRegularExpression::CaseInsensitiveOption);
+        return sizeRe;
+    }
+
+    QStringList dataLines(const QString &text)
+    {
+        QStringList lines;
+        for (const QString &line : text.split(QRegularExpression(QStringLiteral("[\\r\\n]+")), Qt::SkipEmptyParts))
+        {
+            if (!line.trimmed().isEmpty())
+            {
+                lines << line;
+            }
+        }
+        return lines;
+    }
+
+    int baseSize(const Parser::Input &program)
+    {
+        const QRegularExpressionMatch match = sizeExpression().match(program.instructions);
+        if (match.hasMatch())
+        {
+            return match.captured(1).toInt();
+        }
+        return dataLines(program.dataFileContents).size();
+    }
+
+    int scaled(int value, double factor)
+    {
+        return qMax(1, static_cast<int>(std::lround(value * factor)));
+    }
+
+    QString scaleInstructions(const QString &instructions, double factor)
+    {
+        QString result;
+        int last = 0;
+        QRegularExpressionMatchIterator it = sizeExpression().globalMatch(instructions);
+        while (it.hasNext())
+        {
+            const QRegularExpressionMatch match = it.next();
+            result += instructions.mid(last, match.capturedStart(1) - last);
+            result += QString::number(scaled(match.captured(1).toInt(), factor));
+            last = match.capturedEnd(1);
+        }
+        return result + instructions.mid(last);
+    }
+
+    QStringList cycled(const QStringList &sample, double factor)
+    {
+        QStringList result;
+        if (sample.isEmpty())
+        {
+            return result;
+        }
+        const int count = scaled(sample.size(), factor);
+        result.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            result << sample[i % sample.size()];
+        }
+        return result;
+    }
+
+    bool generateInput(const QString &command, int size, QString &text, QStringList &errors)
+    {
+        QStringList arguments = QProcess::splitCommand(command);
+        if (arguments.isEmpty())
+        {
+            errors << QStringLiteral("El generador de entradas está vacío.");
+            return false;
+        }
+        const QString program = arguments.takeFirst();
+        arguments << QString::number(size);
+
+        QProcess process;
+        process.start(program, arguments);
+        if (!process.waitForStarted() || !process.waitForFinished(30000) ||
+            process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+        {
+            process.kill();
+            errors << QStringLiteral("El generador de entradas falló con n = %1.").arg(size);
+            return false;
+        }
+        text = QString::fromLocal8Bit(process.readAllStandardOutput());
+        return true;
+    }
+
+    double growth(Complexity::Class complexity, double n)
+    {
+        switch (complexity)
+        {
+        case Complexity::Class::Linear:
+            return n;
+        case Complexity::Class::Linearithmic:
+            return n * std::log2(n);
+        case Complexity::Class::Quadratic:
+            return n * n;
+        default:
+            return 1.0;
+        }
+    }
+
+    // Ajusta t = a + b·f(n) por mínimos cuadrados y devuelve la raíz del error cuadrático medio
+    // relativa al tiempo medio; así pesan más los tamaños grandes, donde domina el término asintótico.
+    double fitError(const QList<Complexity::Sample> &samples, Complexity::Class complexity)
+    {
+        const double scale = growth(complexity, samples.last().size);
+        double meanX = 0.0;
+        double meanY = 0.0;
+        for (const Complexity::Sample &sample : samples)
+        {
+            meanX += growth(complexity, sample.size) / scale;
+            meanY += sample.timeMs;
+        }
+        meanX /= samples.size();
+        meanY /= samples.size();
+
+        double covariance = 0.0;
+        double variance = 0.0;
+        for (const Complexity::Sample &sample : samples)
+        {
+            const double x = growth(complexity, sample.size) / scale - meanX;
+            covariance += x * (sample.timeMs - meanY);
+            variance += x * x;
+        }
+        const double slope = variance > 0.0 ? qMax(0.0, covariance / variance) : 0.0;
+        const double intercept = meanY - slope * meanX;
+
+        double error = 0.0;
+        for (const Complexity::Sample &sample : samples)
+        {
+            const double residual = sample.timeMs - (intercept + slope * growth(complexity, sample.size) / scale);
+            error += residual * residual;
+        }
+        return std::sqrt(error / samples.size()) / qMax(meanY, 0.001);
+    }
+
+}
+
+Complexity::Output Complexity::estimate(const Complexity::Input &input)
+{
+    Output output;
+    int base = baseSize(input.program);
+    if (base <= 0 && input.generatorCommand.isEmpty())
+    {
+        output.errors << QStringLiteral("No hay ningún tamaño que escalar: use una lista \"con N elementos\", un archivo de datos o --generador.");
+        return output;
+    }
+    base = qMax(base, 1);
+
+    const QStringList sampleData = dataLines(input.program.dataFileContents);
+    const QStringList sampleInput = input.standardInput.split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
+    int size = qMax(input.initialSize, base);
+    for (int step = 0; step < input.steps; ++step, size *= 2)
+    {
+        const double factor = static_cast<double>(size) / base;
+        Parser::Input program = input.program;
+        program.instructions = scaleInstructions(program.instructions, factor);
+        if (!sampleData.isEmpty())
+        {
+            program.dataFileContents = cycled(sampleData, factor).join('\n');
+        }
+        program.multipleFiles = false;
+        program.profile = false;
+        const Parser::Output converted = Parser::convert(program);
+        if (!converted.success)
+        {
+            output.errors << QStringLiteral("La conversión falló con n = %1.").arg(size);
+            break;
+        }
+
+        Runner::Input runner = input.runner;
+        runner.code = converted.code;
+        runner.includes = converted.includes;
+        if (!input.generatorCommand.isEmpty())
+        {
+            if (!generateInput(input.generatorCommand, size, runner.standardInput, output.errors))
+            {
+                break;
+            }
+        }
+        else
+        {
+            runner.standardInput = cycled(sampleInput, factor).join(' ');
+        }
+
+        // Se toma el mínimo de varias ejecuciones para descartar ruido del sistema.
+        double best = -1.0;
+        for (int repetition = 0; repetition < qMax(1, input.repetitions); ++repetition)
+        {
+            const Runner::Output result = Runner::run(runner);
+            if (!result.success)
+            {
+                output.errors << QStringLiteral("La ejecución con n = %1 falló: %2").arg(size).arg(result.errors.join(' '));
+                best = -1.0;
+                break;
+            }
+            const double time = result.cpuTimeMs >= 0.0 ? result.cpuTimeMs : result.wallTimeMs;
+            best = best < 0.0 ? time : qMin(best, time);
+        }
+        if (best < 0.0)
+        {
+            break;
+        }
+        output.samples.append({size, best});
+        if (best > input.timeBudgetMs)
+        {
+            break;
+        }
+    }
+
+    if (output.samples.size() < 3)
+    {
+        output.errors << QStringLiteral("Se necesitan al menos tres tamaños medidos para estimar la complejidad.");
+        return output;
+    }
+
+    // Un modelo más complejo solo gana si reduce a la mitad el error de ajuste: entre O(n) y
+    // O(n log n) la diferencia en estos tamaños es pequeña y el ruido no debe decidirla.
+    const Class candidates[] = {Class::Constant, Class::Linear, Class::Linearithmic, Class::Quadratic};
+    output.estimate = Class::Constant;
+    output.fitError = fitError(output.samples, Class::Constant);
+    for (Class candidate : candidates)
+    {
+        const double error = fitError(output.samples, candidate);
+        if (error < output.fitError * 0.5)
+        {
+            output.estimate = candidate;
+            output.fitError = error;
+        }
+    }
+    output.success = true;
+    return output;
+}
+
+QString Complexity::className(Complexity::Class complexity)
+{
+    switch (complexity)
+    {
+    case Class::Constant:
+        return QStringLiteral("O(1)");
+    case Class::Linear:
+        return QStringLiteral("O(n)");
+    case Class::Linearithmic:
+        return QStringLiteral("O(n log n)");
+    case Class::Quadratic:
+        return QStringLiteral("O(n²)");
+    default:
+        return QStringLiteral("desconocida");
+    }
+}
+
+QString Complexity::describe(const Complexity::Output &output)
+{
+    QStringList lines;
+    for (const Sample &sample : output.samples)
+    {
+        lines << QStringLiteral("n = %1: %2 ms").arg(sample.size).arg(sample.timeMs, 0, 'f', 2);
+    }
+    if (output.success)
+    {
+        lines << QStringLiteral("Complejidad estimada: %1 (error de ajuste %2 %)")
+                     .arg(className(output.estimate))
+                     .arg(output.fitError * 100.0, 0, 'f', 1);
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,50 @@
+#ifndef COMPLEXITY_H
+#define COMPLEXITY_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "parser.h"
+#include "runner.h"
+
+class Complexity {
+public:
+    enum class Class {
+        Unknown,
+        Constant,
+        Linear,
+        Linearithmic,
+        Quadratic
+    };
+
+    struct Input {
+        Parser::Input program;
+        Runner::Input runner;
+        QString standardInput;
+        QString generatorCommand;
+        int initialSize = 1000;
+        int steps = 6;
+        int repetitions = 3;
+        double timeBudgetMs = 2000.0;
+    };
+
+    struct Sample {
+        int size = 0;
+        double timeMs = 0.0;
+    };
+
+    struct Output {
+        QList<Sample> samples;
+        QStringList errors;
+        Class estimate = Class::Unknown;
+        double fitError = 0.0;
+        bool success = false;
+    };
+
+    static Output estimate(const Input &input);
+    static QString className(Class complexity);
+    static QString describe(const Output &output);
+};
+
+#endif
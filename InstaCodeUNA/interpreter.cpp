@@ -0,0 +1,5048 @@
+#include "interpreter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+    enum class TokenKind
+    {
+        Identifier,
+        Integer,
+        Floating,
+        Text,
+        Character,
+        Symbol,
+        End
+    };
+
+    struct Token
+    {
+        TokenKind kind = TokenKind::End;
+        std::string text;
+        int line = 0;
+    };
+
+    class Lexer
+    {
+    public:
+        explicit Lexer(std::string source) : m_source(std::move(source)) {}
+
+        std::vector<Token> tokenize(QStringList &errors)
+        {
+            std::vector<Token> tokens;
+            while (errors.isEmpty())
+            {
+                skipSpaceAndComments();
+                if (m_position >= m_source.size())
+                {
+                    break;
+                }
+                Token token;
+                token.line = m_line;
+                const char ch = m_source[m_position];
+                if (isIdentifierStart(ch))
+                {
+                    const std::size_t start = m_position;
+                    while (m_position < m_source.size() && (isIdentifierStart(m_source[m_position]) || isDigit(m_source[m_position])))
+                    {
+                        ++m_position;
+                    }
+                    token.kind = TokenKind::Identifier;
+                    token.text = m_source.substr(start, m_position - start);
+                }
+                else if (isDigit(ch) || (ch == '.' && isDigit(peek(1))))
+                {
+                    readNumber(token);
+                }
+                else if (ch == '"' || ch == '\'')
+                {
+                    if (!readQuoted(token, ch))
+                    {
+                        errors << QStringLiteral("Línea %1: literal sin cerrar.").arg(token.line);
+                    }
+                }
+                else if (!readSymbol(token))
+                {
+                    errors << QStringLiteral("Línea %1: carácter no reconocido en el código.").arg(token.line);
+                }
+                tokens.push_back(token);
+            }
+            Token end;
+            end.line = m_line;
+            tokens.push_back(end);
+            return tokens;
+        }
+
+    private:
+        static bool isDigit(char ch)
+        {
+            return ch >= '0' && ch <= '9';
+        }
+
+        static bool isIdentifierStart(char ch)
+        {
+            return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+        }
+
+        char peek(std::size_t offset) const
+        {
+            return m_position + offset < m_source.size() ? m_source[m_position + offset] : '\0';
+        }
+
+        void skipSpaceAndComments()
+        {
+            while (m_position < m_source.size())
+            {
+                const char ch = m_source[m_position];
+                if (ch == '\n')
+                {
+                    ++m_line;
+                    ++m_position;
+                }
+                else if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\f' || ch == '\v')
+                {
+                    ++m_position;
+                }
+                else if (ch == '#' || (ch == '/' && peek(1) == '/'))
+                {
+                    while (m_position < m_source.size() && m_source[m_position] != '\n')
+                    {
+                        ++m_position;
+                    }
+                }
+                else if (ch == '/' && peek(1) == '*')
+                {
+                    m_position += 2;
+                    while (m_position < m_source.size() && !(m_source[m_position] == '*' && peek(1) == '/'))
+                    {
+                        if (m_source[m_position] == '\n')
+                        {
+                            ++m_line;
+                        }
+                        ++m_position;
+                    }
+                    m_position = std::min(m_position + 2, m_source.size());
+                }
+                else
+                {
+                    break;
+                }
+            }
+        }
+
+        void readNumber(Token &token)
+        {
+            const std::size_t start = m_position;
+            bool floating = false;
+            while (isDigit(peek(0)))
+            {
+                ++m_position;
+            }
+            if (peek(0) == '.')
+            {
+                floating = true;
+                ++m_position;
+                while (isDigit(peek(0)))
+                {
+                    ++m_position;
+                }
+            }
+            if ((peek(0) == 'e' || peek(0) == 'E') &&
+                (isDigit(peek(1)) || ((peek(1) == '+' || peek(1) == '-') && isDigit(peek(2)))))
+            {
+                floating = true;
+                m_position += 2;
+                while (isDigit(peek(0)))
+                {
+                    ++m_position;
+                }
+            }
+            token.text = m_source.substr(start, m_position - start);
+            while (std::string("uUlLfF").find(peek(0)) != std::string::npos && peek(0) != '\0')
+            {
+                if (peek(0) == 'f' || peek(0) == 'F')
+                {
+                    floating = true;
+                }
+                ++m_position;
+            }
+            token.kind = floating ? TokenKind::Floating : TokenKind::Integer;
+        }
+
+        bool readQuoted(Token &token, char quote)
+        {
+            token.kind = quote == '"' ? TokenKind::Text : TokenKind::Character;
+            ++m_position;
+            while (m_position < m_source.size() && m_source[m_position] != quote)
+            {
+                char ch = m_source[m_position++];
+                if (ch == '\n')
+                {
+                    return false;
+                }
+                if (ch == '\\' && m_position < m_source.size())
+                {
+                    const char escaped = m_source[m_position++];
+                    switch (escaped)
+                    {
+                    case 'n':
+                        ch = '\n';
+                        break;
+                    case 't':
+                        ch = '\t';
+                        break;
+                    case 'r':
+                        ch = '\r';
+                        break;
+                    case '0':
+                        ch = '\0';
+                        break;
+                    case 'a':
+                        ch = '\a';
+                        break;
+                    default:
+                        ch = escaped;
+                        break;
+                    }
+                }
+                token.text += ch;
+            }
+            if (m_position >= m_source.size())
+            {
+                return false;
+            }
+            ++m_position;
+            return true;
+        }
+
+        bool readSymbol(Token &token)
+        {
+            static const char *const symbols[] = {
+                "<<=", ">>=", "::", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "++", "--",
+                "+=", "-=", "*=", "/=", "%=", "->"};
+            token.kind = TokenKind::Symbol;
+            for (const char *symbol : symbols)
+            {
+                const std::size_t length = std::char_traits<char>::length(symbol);
+                if (m_source.compare(m_position, length, symbol) == 0)
+                {
+                    token.text = symbol;
+                    m_position += length;
+                    return true;
+                }
+            }
+            const char ch = m_source[m_position];
+            if (std::string("{}()[];,.<>=+-*/%!?:&|^~").find(ch) == std::string::npos)
+            {
+                return false;
+            }
+            token.text = std::string(1, ch);
+            ++m_position;
+            return true;
+        }
+
+        std::string m_source;
+        std::size_t m_position = 0;
+        int m_line = 1;
+    };
+
+    enum class TypeKind : quint8
+    {
+        Void,
+        Integer,
+        Long,
+        Size,
+        Real,
+        Boolean,
+        Character,
+        Text,
+        Automatic,
+        List,
+        Set,
+        Record
+    };
+
+    struct TypeInfo
+    {
+        TypeKind kind = TypeKind::Automatic;
+        int element = -1;
+        int record = -1;
+    };
+
+    bool isScalarKind(TypeKind kind)
+    {
+        return kind >= TypeKind::Integer && kind <= TypeKind::Text;
+    }
+
+    enum class ValueKind : quint8
+    {
+        Empty,
+        Integer,
+        Real,
+        Boolean,
+        Text,
+        List,
+        Record,
+        Set,
+        Iterator,
+        Callable
+    };
+
+    struct Aggregate;
+
+    struct Value
+    {
+        ValueKind kind = ValueKind::Empty;
+        qint64 integer = 0;
+        double real = 0.0;
+        std::string text;
+        std::shared_ptr<Aggregate> aggregate;
+    };
+
+    struct Aggregate
+    {
+        int type = -1;
+        std::vector<Value> items;
+        std::unordered_set<std::string> keys;
+    };
+
+    Value integerValue(qint64 number)
+    {
+        Value value;
+        value.kind = ValueKind::Integer;
+        value.integer = number;
+        return value;
+    }
+
+    Value realValue(double number)
+    {
+        Value value;
+        value.kind = ValueKind::Real;
+        value.real = number;
+        return value;
+    }
+
+    Value booleanValue(bool flag)
+    {
+        Value value;
+        value.kind = ValueKind::Boolean;
+        value.integer = flag ? 1 : 0;
+        return value;
+    }
+
+    Value textValue(std::string text)
+    {
+        Value value;
+        value.kind = ValueKind::Text;
+        value.text = std::move(text);
+        return value;
+    }
+
+    Value iteratorValue(const std::shared_ptr<Aggregate> &target, qint64 position)
+    {
+        Value value;
+        value.kind = ValueKind::Iterator;
+        value.aggregate = target;
+        value.integer = position;
+        return value;
+    }
+
+    bool isIntegral(const Value &value)
+    {
+        return value.kind == ValueKind::Integer || value.kind == ValueKind::Boolean;
+    }
+
+    bool isNumeric(const Value &value)
+    {
+        return isIntegral(value) || value.kind == ValueKind::Real;
+    }
+
+    double toReal(const Value &value)
+    {
+        return value.kind == ValueKind::Real ? value.real : static_cast<double>(value.integer);
+    }
+
+    QString kindName(ValueKind kind)
+    {
+        switch (kind)
+        {
+        case ValueKind::Integer:
+            return QStringLiteral("entero");
+        case ValueKind::Real:
+            return QStringLiteral("decimal");
+        case ValueKind::Boolean:
+            return QStringLiteral("booleano");
+        case ValueKind::Text:
+            return QStringLiteral("texto");
+        case ValueKind::List:
+            return QStringLiteral("lista");
+        case ValueKind::Record:
+            return QStringLiteral("estructura");
+        case ValueKind::Set:
+            return QStringLiteral("conjunto");
+        case ValueKind::Iterator:
+            return QStringLiteral("iterador");
+        case ValueKind::Callable:
+            return QStringLiteral("función");
+        case ValueKind::Empty:
+            break;
+        }
+        return QStringLiteral("vacío");
+    }
+
+    Value deepCopy(const Value &value)
+    {
+        if (value.kind != ValueKind::List && value.kind != ValueKind::Record && value.kind != ValueKind::Set)
+        {
+            return value;
+        }
+        Value copy = value;
+        copy.aggregate = std::make_shared<Aggregate>();
+        copy.aggregate->type = value.aggregate->type;
+        copy.aggregate->keys = value.aggregate->keys;
+        copy.aggregate->items.reserve(value.aggregate->items.size());
+        for (const Value &item : value.aggregate->items)
+        {
+            copy.aggregate->items.push_back(deepCopy(item));
+        }
+        return copy;
+    }
+
+    qint64 truncatedInteger(double number, qint64 fallback)
+    {
+        if (!std::isfinite(number) || number >= 9.2233720368547758e18 || number < -9.2233720368547758e18)
+        {
+            return fallback;
+        }
+        return static_cast<qint64>(number);
+    }
+
+    bool convertValue(Value &value, TypeKind kind, QString &error)
+    {
+        switch (kind)
+        {
+        case TypeKind::Integer:
+        case TypeKind::Long:
+        case TypeKind::Size:
+        {
+            qint64 number = 0;
+            if (isIntegral(value))
+            {
+                number = value.integer;
+            }
+            else if (value.kind == ValueKind::Real)
+            {
+                number = truncatedInteger(value.real, std::numeric_limits<qint64>::min());
+            }
+            else if (value.kind == ValueKind::Text && value.text.size() == 1)
+            {
+                number = static_cast<signed char>(value.text[0]);
+            }
+            else
+            {
+                error = QStringLiteral("No se puede convertir %1 a número entero.").arg(kindName(value.kind));
+                return false;
+            }
+            if (kind == TypeKind::Integer)
+            {
+                number = static_cast<qint32>(static_cast<quint32>(static_cast<quint64>(number)));
+            }
+            value = integerValue(number);
+            return true;
+        }
+        case TypeKind::Real:
+            if (!isNumeric(value))
+            {
+                error = QStringLiteral("No se puede convertir %1 a número decimal.").arg(kindName(value.kind));
+                return false;
+            }
+            value = realValue(toReal(value));
+            return true;
+        case TypeKind::Boolean:
+            if (!isNumeric(value))
+            {
+                error = QStringLiteral("No se puede convertir %1 a booleano.").arg(kindName(value.kind));
+                return false;
+            }
+            value = booleanValue(toReal(value) != 0.0);
+            return true;
+        case TypeKind::Character:
+            if (isIntegral(value))
+            {
+                value = textValue(std::string(1, static_cast<char>(value.integer)));
+                return true;
+            }
+            if (value.kind == ValueKind::Text && value.text.size() == 1)
+            {
+                return true;
+            }
+            error = QStringLiteral("No se puede convertir %1 a carácter.").arg(kindName(value.kind));
+            return false;
+        case TypeKind::Text:
+            if (value.kind != ValueKind::Text)
+            {
+                error = QStringLiteral("No se puede convertir %1 a texto.").arg(kindName(value.kind));
+                return false;
+            }
+            return true;
+        default:
+            return true;
+        }
+    }
+
+    enum class ExpressionKind
+    {
+        Literal,
+        Name,
+        Member,
+        Index,
+        Call,
+        Unary,
+        Postfix,
+        Binary,
+        Assignment,
+        Conditional,
+        Cast,
+        Lambda,
+        BracedList
+    };
+
+    struct Expression;
+    using ExpressionPtr = std::unique_ptr<Expression>;
+
+    struct Expression
+    {
+        ExpressionKind kind = ExpressionKind::Literal;
+        int line = 0;
+        std::string text;
+        Value literal;
+        int type = -1;
+        int function = -1;
+        std::vector<ExpressionPtr> operands;
+    };
+
+    enum class StatementKind
+    {
+        Block,
+        Declaration,
+        Expression,
+        If,
+        For,
+        RangeFor,
+        While,
+        DoWhile,
+        Return,
+        Break,
+        Continue,
+        Empty
+    };
+
+    struct Declarator
+    {
+        std::string name;
+        int line = 0;
+        int type = -1;
+        bool isArray = false;
+        ExpressionPtr arraySize;
+        ExpressionPtr initializer;
+        bool constructed = false;
+        std::vector<ExpressionPtr> arguments;
+    };
+
+    struct Statement;
+    using StatementPtr = std::unique_ptr<Statement>;
+
+    struct Statement
+    {
+        StatementKind kind = StatementKind::Empty;
+        int line = 0;
+        int type = -1;
+        bool reference = false;
+        bool constant = false;
+        std::vector<Declarator> declarators;
+        ExpressionPtr expression;
+        ExpressionPtr step;
+        StatementPtr initializer;
+        StatementPtr body;
+        StatementPtr alternative;
+        std::vector<StatementPtr> statements;
+    };
+
+    struct Parameter
+    {
+        std::string name;
+        int type = -1;
+        bool reference = false;
+        ExpressionPtr defaultValue;
+    };
+
+    struct FunctionDeclaration
+    {
+        std::string name;
+        int line = 0;
+        int returnType = -1;
+        int record = -1;
+        bool constructor = false;
+        bool lambda = false;
+        std::vector<Parameter> parameters;
+        std::vector<std::pair<std::string, std::vector<ExpressionPtr>>> memberInitializers;
+        StatementPtr body;
+    };
+
+    enum class OpCode : quint8
+    {
+        LoadConstant,
+        Move,
+        Copy,
+        Convert,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Modulo,
+        Negate,
+        Not,
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Increment,
+        Jump,
+        JumpIfFalse,
+        JumpIfTrue,
+        CompareJump,
+        ForEach,
+        NewValue,
+        NewList,
+        MakeList,
+        GetIndex,
+        SetIndex,
+        GetField,
+        SetField,
+        Dereference,
+        SetDereference,
+        Call,
+        CallMember,
+        CallLibrary,
+        Return,
+        ReturnVoid,
+        Print,
+        Read
+    };
+
+    struct Instruction
+    {
+        OpCode op = OpCode::ReturnVoid;
+        qint32 a = 0;
+        qint32 b = 0;
+        qint32 c = 0;
+        qint32 d = 0;
+    };
+
+    enum class MemberFunction : quint8
+    {
+        Size,
+        Empty,
+        PushBack,
+        PopBack,
+        Back,
+        Front,
+        Clear,
+        Resize,
+        Reserve,
+        Insert,
+        InsertList,
+        Erase,
+        Begin,
+        End,
+        At,
+        Count,
+        Substring,
+        Append,
+        Find,
+        Unknown
+    };
+
+    enum class LibraryFunction : quint8
+    {
+        Sort,
+        SortDescending,
+        Find,
+        Count,
+        LowerBound,
+        UpperBound,
+        BinarySearch,
+        Max,
+        Min,
+        Abs,
+        Sqrt,
+        Pow,
+        Floor,
+        Ceil,
+        Round,
+        ToString,
+        Reverse,
+        Accumulate,
+        IsFinite,
+        Unknown
+    };
+
+    struct MemberCall
+    {
+        std::string name;
+        MemberFunction function = MemberFunction::Unknown;
+        int argumentCount = 0;
+    };
+
+    struct CompiledFunction
+    {
+        std::string name;
+        int registerCount = 0;
+        std::vector<Instruction> code;
+        std::vector<int> lines;
+    };
+
+    struct RecordLayout
+    {
+        std::string name;
+        std::vector<std::string> fields;
+        std::vector<int> fieldTypes;
+        std::vector<Value> fieldDefaults;
+        std::unordered_map<std::string, int> fieldIndex;
+        std::unordered_map<std::string, int> methods;
+        std::vector<int> constructors;
+    };
+
+    struct Program
+    {
+        std::vector<TypeInfo> types;
+        std::vector<RecordLayout> records;
+        std::vector<CompiledFunction> functions;
+        std::vector<Value> constants;
+        std::vector<MemberCall> memberCalls;
+        int entry = -1;
+
+        Program()
+        {
+            for (int kind = 0; kind <= static_cast<int>(TypeKind::Automatic); ++kind)
+            {
+                TypeInfo info;
+                info.kind = static_cast<TypeKind>(kind);
+                types.push_back(info);
+            }
+        }
+
+        int internType(TypeKind kind, int element, int record)
+        {
+            if (kind <= TypeKind::Automatic)
+            {
+                return static_cast<int>(kind);
+            }
+            for (int i = 0; i < static_cast<int>(types.size()); ++i)
+            {
+                if (types[i].kind == kind && types[i].element == element && types[i].record == record)
+                {
+                    return i;
+                }
+            }
+            TypeInfo info;
+            info.kind = kind;
+            info.element = element;
+            info.record = record;
+            types.push_back(info);
+            return static_cast<int>(types.size()) - 1;
+        }
+
+        TypeKind kindOf(int type) const
+        {
+            return type >= 0 ? types[type].kind : TypeKind::Automatic;
+        }
+    };
+
+    MemberFunction memberFunctionFor(const std::string &name)
+    {
+        static const std::unordered_map<std::string, MemberFunction> table = {
+            {"size", MemberFunction::Size},
+            {"length", MemberFunction::Size},
+            {"empty", MemberFunction::Empty},
+            {"push_back", MemberFunction::PushBack},
+            {"emplace_back", MemberFunction::PushBack},
+            {"pop_back", MemberFunction::PopBack},
+            {"back", MemberFunction::Back},
+            {"front", MemberFunction::Front},
+            {"clear", MemberFunction::Clear},
+            {"resize", MemberFunction::Resize},
+            {"reserve", MemberFunction::Reserve},
+            {"shrink_to_fit", MemberFunction::Reserve},
+            {"insert", MemberFunction::Insert},
+            {"erase", MemberFunction::Erase},
+            {"begin", MemberFunction::Begin},
+            {"cbegin", MemberFunction::Begin},
+            {"end", MemberFunction::End},
+            {"cend", MemberFunction::End},
+            {"at", MemberFunction::At},
+            {"count", MemberFunction::Count},
+            {"substr", MemberFunction::Substring},
+            {"append", MemberFunction::Append},
+            {"find", MemberFunction::Find}};
+        const auto it = table.find(name);
+        return it == table.end() ? MemberFunction::Unknown : it->second;
+    }
+
+    LibraryFunction libraryFunctionFor(std::string name)
+    {
+        static const std::unordered_map<std::string, LibraryFunction> table = {
+            {"sort", LibraryFunction::Sort},
+            {"stable_sort", LibraryFunction::Sort},
+            {"find", LibraryFunction::Find},
+            {"count", LibraryFunction::Count},
+            {"lower_bound", LibraryFunction::LowerBound},
+            {"upper_bound", LibraryFunction::UpperBound},
+            {"binary_search", LibraryFunction::BinarySearch},
+            {"max", LibraryFunction::Max},
+            {"min", LibraryFunction::Min},
+            {"abs", LibraryFunction::Abs},
+            {"fabs", LibraryFunction::Abs},
+            {"sqrt", LibraryFunction::Sqrt},
+            {"pow", LibraryFunction::Pow},
+            {"floor", LibraryFunction::Floor},
+            {"ceil", LibraryFunction::Ceil},
+            {"round", LibraryFunction::Round},
+            {"to_string", LibraryFunction::ToString},
+            {"reverse", LibraryFunction::Reverse},
+            {"accumulate", LibraryFunction::Accumulate},
+            {"isfinite", LibraryFunction::IsFinite}};
+        if (name.compare(0, 5, "std::") == 0)
+        {
+            name.erase(0, 5);
+        }
+        const auto it = table.find(name);
+        return it == table.end() ? LibraryFunction::Unknown : it->second;
+    }
+
+    class SourceParser
+    {
+    public:
+        SourceParser(std::vector<Token> tokens, Program &program, std::vector<FunctionDeclaration> &functions, QStringList &errors)
+            : m_tokens(std::move(tokens)), m_program(program), m_functions(functions), m_errors(errors)
+        {
+        }
+
+        void parse()
+        {
+            declareRecords();
+            while (!atEnd())
+            {
+                if (accept(";"))
+                {
+                    continue;
+                }
+                if (check("using"))
+                {
+                    while (!atEnd() && !accept(";"))
+                    {
+                        advance();
+                    }
+                    continue;
+                }
+                if (check("struct"))
+                {
+                    parseRecord();
+                    continue;
+                }
+                const int returnType = parseType();
+                const std::string name = expectIdentifier();
+                if (!check("("))
+                {
+                    fail(QStringLiteral("Las variables globales no están soportadas."));
+                    break;
+                }
+                parseFunction(name, returnType, -1, false);
+            }
+        }
+
+    private:
+        const Token &current() const
+        {
+            return m_tokens[m_position];
+        }
+
+        const Token &lookAhead(std::size_t offset) const
+        {
+            return m_tokens[std::min(m_position + offset, m_tokens.size() - 1)];
+        }
+
+        bool atEnd() const
+        {
+            return current().kind == TokenKind::End;
+        }
+
+        void advance()
+        {
+            if (!atEnd())
+            {
+                ++m_position;
+            }
+        }
+
+        static bool matches(const Token &token, const char *text)
+        {
+            return (token.kind == TokenKind::Symbol || token.kind == TokenKind::Identifier) && token.text == text;
+        }
+
+        bool check(const char *text) const
+        {
+            return matches(current(), text);
+        }
+
+        bool accept(const char *text)
+        {
+            if (!check(text))
+            {
+                return false;
+            }
+            advance();
+            return true;
+        }
+
+        void expect(const char *text)
+        {
+            if (!accept(text))
+            {
+                fail(QStringLiteral("se esperaba '%1'.").arg(QString::fromStdString(text)));
+            }
+        }
+
+        std::string expectIdentifier()
+        {
+            if (current().kind != TokenKind::Identifier)
+            {
+                fail(QStringLiteral("se esperaba un identificador."));
+                return std::string();
+            }
+            std::string name = current().text;
+            advance();
+            return name;
+        }
+
+        void fail(const QString &message)
+        {
+            if (m_failed)
+            {
+                return;
+            }
+            m_failed = true;
+            m_errors << QStringLiteral("Línea %1: %2").arg(current().line).arg(message);
+            m_position = m_tokens.size() - 1;
+        }
+
+        void expectOpenAngle()
+        {
+            expect("<");
+        }
+
+        void expectCloseAngle()
+        {
+            if (check(">>"))
+            {
+                m_tokens[m_position].text = ">";
+                return;
+            }
+            expect(">");
+        }
+
+        void declareRecords()
+        {
+            for (std::size_t i = 0; i + 1 < m_tokens.size(); ++i)
+            {
+                if (matches(m_tokens[i], "struct") && m_tokens[i + 1].kind == TokenKind::Identifier)
+                {
+                    RecordLayout layout;
+                    layout.name = m_tokens[i + 1].text;
+                    m_program.records.push_back(layout);
+                    const int record = static_cast<int>(m_program.records.size()) - 1;
+                    m_recordTypes[layout.name] = m_program.internType(TypeKind::Record, -1, record);
+                }
+            }
+        }
+
+        std::string parseQualifiedName()
+        {
+            std::string name = expectIdentifier();
+            while (check("::") && lookAhead(1).kind == TokenKind::Identifier)
+            {
+                advance();
+                name += "::" + current().text;
+                advance();
+            }
+            return name;
+        }
+
+        bool isTypeStart() const
+        {
+            static const std::unordered_set<std::string> keywords = {
+                "const", "static", "constexpr", "int", "long", "short", "unsigned", "signed",
+                "double", "float", "bool", "char", "void", "auto", "size_t"};
+            static const std::unordered_set<std::string> standardTypes = {
+                "string", "vector", "size_t", "unordered_set", "set", "int64_t", "int32_t", "uint64_t"};
+            const Token &token = current();
+            if (token.kind != TokenKind::Identifier)
+            {
+                return false;
+            }
+            if (keywords.count(token.text) > 0)
+            {
+                return true;
+            }
+            if (token.text == "std")
+            {
+                return matches(lookAhead(1), "::") && standardTypes.count(lookAhead(2).text) > 0;
+            }
+            if (standardTypes.count(token.text) > 0)
+            {
+                return matches(lookAhead(1), "<") || lookAhead(1).kind == TokenKind::Identifier || matches(lookAhead(1), "&");
+            }
+            if (m_recordTypes.count(token.text) > 0)
+            {
+                return lookAhead(1).kind == TokenKind::Identifier || matches(lookAhead(1), "&");
+            }
+            return false;
+        }
+
+        int parseType(bool *constant = nullptr, bool *reference = nullptr)
+        {
+            bool isConst = false;
+            while (check("const") || check("static") || check("constexpr") || check("inline"))
+            {
+                isConst = isConst || check("const") || check("constexpr");
+                advance();
+            }
+            std::string name = parseQualifiedName();
+            if (name.compare(0, 5, "std::") == 0)
+            {
+                name.erase(0, 5);
+            }
+            int type = -1;
+            if (name == "int" || name == "short" || name == "int32_t")
+            {
+                type = static_cast<int>(TypeKind::Integer);
+            }
+            else if (name == "signed")
+            {
+                accept("int");
+                type = static_cast<int>(TypeKind::Integer);
+            }
+            else if (name == "long" || name == "int64_t")
+            {
+                accept("long");
+                accept("int");
+                type = static_cast<int>(TypeKind::Long);
+            }
+            else if (name == "unsigned")
+            {
+                if (accept("long"))
+                {
+                    accept("long");
+                }
+                accept("int");
+                type = static_cast<int>(TypeKind::Size);
+            }
+            else if (name == "size_t" || name == "uint64_t")
+            {
+                type = static_cast<int>(TypeKind::Size);
+            }
+            else if (name == "double" || name == "float")
+            {
+                type = static_cast<int>(TypeKind::Real);
+            }
+            else if (name == "bool")
+            {
+                type = static_cast<int>(TypeKind::Boolean);
+            }
+            else if (name == "char")
+            {
+                type = static_cast<int>(TypeKind::Character);
+            }
+            else if (name == "string")
+            {
+                type = static_cast<int>(TypeKind::Text);
+            }
+            else if (name == "void")
+            {
+                type = static_cast<int>(TypeKind::Void);
+            }
+            else if (name == "auto")
+            {
+                type = static_cast<int>(TypeKind::Automatic);
+            }
+            else if (name == "vector" || name == "unordered_set" || name == "set")
+            {
+                expectOpenAngle();
+                const int element = parseType();
+                expectCloseAngle();
+                type = m_program.internType(name == "vector" ? TypeKind::List : TypeKind::Set, element, -1);
+            }
+            else if (m_recordTypes.count(name) > 0)
+            {
+                type = m_recordTypes.at(name);
+            }
+            else
+            {
+                fail(QStringLiteral("tipo no soportado: %1.").arg(QString::fromStdString(name)));
+            }
+            while (accept("const"))
+            {
+                isConst = true;
+            }
+            const bool isReference = accept("&") || accept("&&");
+            if (check("*"))
+            {
+                fail(QStringLiteral("los punteros no están soportados."));
+            }
+            if (constant)
+            {
+                *constant = isConst;
+            }
+            if (reference)
+            {
+                *reference = isReference;
+            }
+            return type;
+        }
+
+        void parseRecord()
+        {
+            expect("struct");
+            const std::string name = expectIdentifier();
+            if (m_failed)
+            {
+                return;
+            }
+            const int record = m_program.records.empty() ? -1 : m_program.types[m_recordTypes.at(name)].record;
+            expect("{");
+            while (!atEnd() && !check("}"))
+            {
+                if ((check("public") || check("private")) && matches(lookAhead(1), ":"))
+                {
+                    advance();
+                    advance();
+                    continue;
+                }
+                accept("explicit");
+                if (check(name.c_str()) && matches(lookAhead(1), "("))
+                {
+                    advance();
+                    parseFunction(name, static_cast<int>(TypeKind::Void), record, true);
+                    continue;
+                }
+                const int type = parseType();
+                std::string member = expectIdentifier();
+                if (check("("))
+                {
+                    parseFunction(member, type, record, false);
+                    continue;
+                }
+                while (!m_failed)
+                {
+                    RecordLayout &layout = m_program.records[record];
+                    Value defaultValue;
+                    if (accept("="))
+                    {
+                        defaultValue = constantInitializer(*parseAssignment());
+                    }
+                    else if (check("{"))
+                    {
+                        defaultValue = constantInitializer(*parseBracedList());
+                    }
+                    layout.fieldIndex[member] = static_cast<int>(layout.fields.size());
+                    layout.fields.push_back(member);
+                    layout.fieldTypes.push_back(type);
+                    layout.fieldDefaults.push_back(defaultValue);
+                    if (!accept(","))
+                    {
+                        break;
+                    }
+                    member = expectIdentifier();
+                }
+                expect(";");
+            }
+            expect("}");
+            expect(";");
+        }
+
+        Value constantInitializer(const Expression &expression)
+        {
+            if (expression.kind == ExpressionKind::Literal)
+            {
+                return expression.literal;
+            }
+            if (expression.kind == ExpressionKind::BracedList && expression.operands.empty())
+            {
+                return Value();
+            }
+            if (expression.kind == ExpressionKind::BracedList && expression.operands.size() == 1)
+            {
+                return constantInitializer(*expression.operands.front());
+            }
+            if (expression.kind == ExpressionKind::Unary && expression.text == "-" &&
+                expression.operands.front()->kind == ExpressionKind::Literal)
+            {
+                Value value = expression.operands.front()->literal;
+                if (value.kind == ValueKind::Real)
+                {
+                    value.real = -value.real;
+                }
+                else
+                {
+                    value.integer = -value.integer;
+                }
+                return value;
+            }
+            fail(QStringLiteral("inicializador de campo no soportado."));
+            return Value();
+        }
+
+        void parseFunction(const std::string &name, int returnType, int record, bool constructor)
+        {
+            FunctionDeclaration declaration;
+            declaration.name = name;
+            declaration.line = current().line;
+            declaration.returnType = returnType;
+            declaration.record = record;
+            declaration.constructor = constructor;
+            parseParameters(declaration);
+            accept("const");
+            if (constructor && accept(":"))
+            {
+                do
+                {
+                    std::string member = expectIdentifier();
+                    std::vector<ExpressionPtr> arguments;
+                    if (accept("("))
+                    {
+                        arguments = parseArguments(")");
+                    }
+                    else if (accept("{"))
+                    {
+                        arguments = parseArguments("}");
+                    }
+                    else
+                    {
+                        fail(QStringLiteral("inicializador de miembro no válido."));
+                    }
+                    declaration.memberInitializers.emplace_back(member, std::move(arguments));
+                } while (accept(","));
+            }
+            if (accept(";"))
+            {
+                return;
+            }
+            declaration.body = parseBlock();
+            if (m_failed)
+            {
+                return;
+            }
+            const int index = static_cast<int>(m_functions.size());
+            m_functions.push_back(std::move(declaration));
+            if (record >= 0)
+            {
+                if (constructor)
+                {
+                    m_program.records[record].constructors.push_back(index);
+                }
+                else
+                {
+                    m_program.records[record].methods[name] = index;
+                }
+            }
+        }
+
+        void parseParameters(FunctionDeclaration &declaration)
+        {
+            expect("(");
+            if (check("void") && matches(lookAhead(1), ")"))
+            {
+                advance();
+            }
+            if (!check(")"))
+            {
+                do
+                {
+                    Parameter parameter;
+                    parameter.type = parseType(nullptr, &parameter.reference);
+                    if (current().kind == TokenKind::Identifier)
+                    {
+                        parameter.name = expectIdentifier();
+                    }
+                    if (accept("="))
+                    {
+                        parameter.defaultValue = parseAssignment();
+                    }
+                    declaration.parameters.push_back(std::move(parameter));
+                } while (accept(",") && !m_failed);
+            }
+            expect(")");
+        }
+
+        StatementPtr makeStatement(StatementKind kind)
+        {
+            StatementPtr statement = std::make_unique<Statement>();
+            statement->kind = kind;
+            statement->line = current().line;
+            return statement;
+        }
+
+        StatementPtr parseBlock()
+        {
+            StatementPtr block = makeStatement(StatementKind::Block);
+            expect("{");
+            while (!atEnd() && !check("}"))
+            {
+                block->statements.push_back(parseStatement());
+            }
+            expect("}");
+            return block;
+        }
+
+        StatementPtr parseStatement()
+        {
+            if (check("{"))
+            {
+                return parseBlock();
+            }
+            StatementPtr statement = makeStatement(StatementKind::Empty);
+            if (accept(";"))
+            {
+                return statement;
+            }
+            if (accept("if"))
+            {
+                statement->kind = StatementKind::If;
+                expect("(");
+                statement->expression = parseExpression();
+                expect(")");
+                statement->body = parseStatement();
+                if (accept("else"))
+                {
+                    statement->alternative = parseStatement();
+                }
+                return statement;
+            }
+            if (accept("while"))
+            {
+                statement->kind = StatementKind::While;
+                expect("(");
+                statement->expression = parseExpression();
+                expect(")");
+                statement->body = parseStatement();
+                return statement;
+            }
+            if (accept("do"))
+            {
+                statement->kind = StatementKind::DoWhile;
+                statement->body = parseStatement();
+                expect("while");
+                expect("(");
+                statement->expression = parseExpression();
+                expect(")");
+                expect(";");
+                return statement;
+            }
+            if (accept("for"))
+            {
+                parseFor(*statement);
+                return statement;
+            }
+            if (accept("return"))
+            {
+                statement->kind = StatementKind::Return;
+                if (!check(";"))
+                {
+                    statement->expression = parseExpression();
+                }
+                expect(";");
+                return statement;
+            }
+            if (accept("break"))
+            {
+                statement->kind = StatementKind::Break;
+                expect(";");
+                return statement;
+            }
+            if (accept("continue"))
+            {
+                statement->kind = StatementKind::Continue;
+                expect(";");
+                return statement;
+            }
+            if (isTypeStart())
+            {
+                statement->type = parseType(&statement->constant, &statement->reference);
+                parseDeclarators(*statement);
+                expect(";");
+                return statement;
+            }
+            statement->kind = StatementKind::Expression;
+            statement->expression = parseExpression();
+            expect(";");
+            return statement;
+        }
+
+        void parseFor(Statement &statement)
+        {
+            statement.kind = StatementKind::For;
+            expect("(");
+            if (!accept(";"))
+            {
+                if (isTypeStart())
+                {
+                    StatementPtr declaration = makeStatement(StatementKind::Declaration);
+                    declaration->type = parseType(&declaration->constant, &declaration->reference);
+                    if (current().kind == TokenKind::Identifier && matches(lookAhead(1), ":"))
+                    {
+                        statement.kind = StatementKind::RangeFor;
+                        statement.type = declaration->type;
+                        statement.constant = declaration->constant;
+                        statement.reference = declaration->reference;
+                        Declarator variable;
+                        variable.line = current().line;
+                        variable.name = expectIdentifier();
+                        variable.type = declaration->type;
+                        statement.declarators.push_back(std::move(variable));
+                        expect(":");
+                        statement.expression = parseExpression();
+                        expect(")");
+                        statement.body = parseStatement();
+                        return;
+                    }
+                    parseDeclarators(*declaration);
+                    statement.initializer = std::move(declaration);
+                }
+                else
+                {
+                    StatementPtr initializer = makeStatement(StatementKind::Expression);
+                    initializer->expression = parseExpression();
+                    statement.initializer = std::move(initializer);
+                }
+                expect(";");
+            }
+            if (!check(";"))
+            {
+                statement.expression = parseExpression();
+            }
+            expect(";");
+            if (!check(")"))
+            {
+                statement.step = parseExpression();
+            }
+            expect(")");
+            statement.body = parseStatement();
+        }
+
+        void parseDeclarators(Statement &statement)
+        {
+            statement.kind = StatementKind::Declaration;
+            do
+            {
+                Declarator declarator;
+                declarator.line = current().line;
+                declarator.name = expectIdentifier();
+                declarator.type = statement.type;
+                if (accept("["))
+                {
+                    declarator.isArray = true;
+                    if (!check("]"))
+                    {
+                        declarator.arraySize = parseExpression();
+                    }
+                    expect("]");
+                    declarator.type = m_program.internType(TypeKind::List, statement.type, -1);
+                }
+                if (accept("="))
+                {
+                    declarator.initializer = check("{") ? parseBracedList() : parseAssignment();
+                }
+                else if (accept("("))
+                {
+                    declarator.constructed = true;
+                    declarator.arguments = parseArguments(")");
+                }
+                else if (check("{"))
+                {
+                    declarator.initializer = parseBracedList();
+                }
+                statement.declarators.push_back(std::move(declarator));
+            } while (accept(",") && !m_failed);
+        }
+
+        std::vector<ExpressionPtr> parseArguments(const char *closing)
+        {
+            std::vector<ExpressionPtr> arguments;
+            if (!check(closing))
+            {
+                do
+                {
+                    arguments.push_back(parseAssignment());
+                } while (accept(",") && !m_failed);
+            }
+            expect(closing);
+            return arguments;
+        }
+
+        ExpressionPtr makeExpression(ExpressionKind kind, int line)
+        {
+            ExpressionPtr expression = std::make_unique<Expression>();
+            expression->kind = kind;
+            expression->line = line;
+            return expression;
+        }
+
+        ExpressionPtr parseExpression()
+        {
+            return parseAssignment();
+        }
+
+        ExpressionPtr parseAssignment()
+        {
+            ExpressionPtr target = parseConditional();
+            static const char *const operators[] = {"=", "+=", "-=", "*=", "/=", "%="};
+            for (const char *op : operators)
+            {
+                if (check(op))
+                {
+                    ExpressionPtr assignment = makeExpression(ExpressionKind::Assignment, current().line);
+                    assignment->text = op;
+                    advance();
+                    assignment->operands.push_back(std::move(target));
+                    assignment->operands.push_back(check("{") ? parseBracedList() : parseAssignment());
+                    return assignment;
+                }
+            }
+            return target;
+        }
+
+        ExpressionPtr parseConditional()
+        {
+            ExpressionPtr condition = parseBinary(1);
+            if (!check("?"))
+            {
+                return condition;
+            }
+            ExpressionPtr conditional = makeExpression(ExpressionKind::Conditional, current().line);
+            advance();
+            conditional->operands.push_back(std::move(condition));
+            conditional->operands.push_back(parseAssignment());
+            expect(":");
+            conditional->operands.push_back(parseConditional());
+            return conditional;
+        }
+
+        static int binaryPrecedence(const Token &token)
+        {
+            static const std::unordered_map<std::string, int> precedence = {
+                {"||", 1}, {"&&", 2}, {"==", 3}, {"!=", 3}, {"<", 4}, {"<=", 4}, {">", 4}, {">=", 4},
+                {"<<", 5}, {">>", 5}, {"+", 6}, {"-", 6}, {"*", 7}, {"/", 7}, {"%", 7}};
+            if (token.kind != TokenKind::Symbol)
+            {
+                return -1;
+            }
+            const auto it = precedence.find(token.text);
+            return it == precedence.end() ? -1 : it->second;
+        }
+
+        ExpressionPtr parseBinary(int minimumPrecedence)
+        {
+            ExpressionPtr left = parseUnary();
+            while (!m_failed)
+            {
+                const int precedence = binaryPrecedence(current());
+                if (precedence < minimumPrecedence)
+                {
+                    break;
+                }
+                ExpressionPtr binary = makeExpression(ExpressionKind::Binary, current().line);
+                binary->text = current().text;
+                advance();
+                binary->operands.push_back(std::move(left));
+                binary->operands.push_back(parseBinary(precedence + 1));
+                left = std::move(binary);
+            }
+            return left;
+        }
+
+        ExpressionPtr parseUnary()
+        {
+            static const char *const operators[] = {"!", "-", "+", "++", "--", "*"};
+            for (const char *op : operators)
+            {
+                if (check(op))
+                {
+                    ExpressionPtr unary = makeExpression(ExpressionKind::Unary, current().line);
+                    unary->text = op;
+                    advance();
+                    unary->operands.push_back(parseUnary());
+                    return unary;
+                }
+            }
+            if (check("&"))
+            {
+                fail(QStringLiteral("el operador de dirección no está soportado."));
+            }
+            return parsePostfix();
+        }
+
+        ExpressionPtr parsePostfix()
+        {
+            ExpressionPtr expression = parsePrimary();
+            while (!m_failed)
+            {
+                const int line = current().line;
+                if (accept("("))
+                {
+                    ExpressionPtr call = makeExpression(ExpressionKind::Call, line);
+                    call->operands.push_back(std::move(expression));
+                    for (ExpressionPtr &argument : parseArguments(")"))
+                    {
+                        call->operands.push_back(std::move(argument));
+                    }
+                    expression = std::move(call);
+                }
+                else if (accept("["))
+                {
+                    ExpressionPtr index = makeExpression(ExpressionKind::Index, line);
+                    index->operands.push_back(std::move(expression));
+                    index->operands.push_back(parseExpression());
+                    expect("]");
+                    expression = std::move(index);
+                }
+                else if (accept("."))
+                {
+                    ExpressionPtr member = makeExpression(ExpressionKind::Member, line);
+                    member->text = expectIdentifier();
+                    member->operands.push_back(std::move(expression));
+                    expression = std::move(member);
+                }
+                else if (check("++") || check("--"))
+                {
+                    ExpressionPtr postfix = makeExpression(ExpressionKind::Postfix, line);
+                    postfix->text = current().text;
+                    advance();
+                    postfix->operands.push_back(std::move(expression));
+                    expression = std::move(postfix);
+                }
+                else
+                {
+                    if (check("->"))
+                    {
+                        fail(QStringLiteral("los punteros no están soportados."));
+                    }
+                    break;
+                }
+            }
+            return expression;
+        }
+
+        ExpressionPtr parseBracedList()
+        {
+            ExpressionPtr list = makeExpression(ExpressionKind::BracedList, current().line);
+            expect("{");
+            while (!atEnd() && !check("}"))
+            {
+                list->operands.push_back(check("{") ? parseBracedList() : parseAssignment());
+                if (!accept(","))
+                {
+                    break;
+                }
+            }
+            expect("}");
+            return list;
+        }
+
+        ExpressionPtr parseLambda()
+        {
+            const int line = current().line;
+            expect("[");
+            while (!atEnd() && !accept("]"))
+            {
+                advance();
+            }
+            FunctionDeclaration declaration;
+            declaration.name = "lambda";
+            declaration.line = line;
+            declaration.lambda = true;
+            declaration.returnType = static_cast<int>(TypeKind::Automatic);
+            parseParameters(declaration);
+            if (accept("->"))
+            {
+                declaration.returnType = parseType();
+            }
+            declaration.body = parseBlock();
+            ExpressionPtr lambda = makeExpression(ExpressionKind::Lambda, line);
+            lambda->function = static_cast<int>(m_functions.size());
+            m_functions.push_back(std::move(declaration));
+            return lambda;
+        }
+
+        ExpressionPtr parsePrimary()
+        {
+            const Token token = current();
+            ExpressionPtr expression = makeExpression(ExpressionKind::Literal, token.line);
+            switch (token.kind)
+            {
+            case TokenKind::Integer:
+                advance();
+                expression->literal = integerValue(static_cast<qint64>(std::strtoull(token.text.c_str(), nullptr, 10)));
+                return expression;
+            case TokenKind::Floating:
+                advance();
+                expression->literal = realValue(std::strtod(token.text.c_str(), nullptr));
+                return expression;
+            case TokenKind::Text:
+            {
+                std::string text;
+                while (current().kind == TokenKind::Text)
+                {
+                    text += current().text;
+                    advance();
+                }
+                expression->literal = textValue(text);
+                return expression;
+            }
+            case TokenKind::Character:
+                advance();
+                expression->literal = textValue(token.text);
+                return expression;
+            case TokenKind::End:
+                fail(QStringLiteral("expresión incompleta."));
+                return expression;
+            default:
+                break;
+            }
+            if (accept("("))
+            {
+                expression = parseExpression();
+                expect(")");
+                return expression;
+            }
+            if (check("{"))
+            {
+                return parseBracedList();
+            }
+            if (check("["))
+            {
+                return parseLambda();
+            }
+            if (token.kind != TokenKind::Identifier)
+            {
+                fail(QStringLiteral("símbolo inesperado '%1'.").arg(QString::fromStdString(token.text)));
+                return expression;
+            }
+            if (accept("true") || accept("false"))
+            {
+                expression->literal = booleanValue(token.text == "true");
+                return expression;
+            }
+            if (isTemporaryConstruction())
+            {
+                expression->kind = ExpressionKind::Cast;
+                expression->type = parseType();
+                if (check("{"))
+                {
+                    expression->operands.push_back(parseBracedList());
+                }
+                else
+                {
+                    expect("(");
+                    expression->operands = parseArguments(")");
+                }
+                return expression;
+            }
+            const std::string name = parseQualifiedName();
+            if (name == "static_cast" || name == "std::static_cast")
+            {
+                expression->kind = ExpressionKind::Cast;
+                expectOpenAngle();
+                expression->type = parseType();
+                expectCloseAngle();
+                expect("(");
+                expression->operands.push_back(parseExpression());
+                expect(")");
+                return expression;
+            }
+            if (name == "std::numeric_limits")
+            {
+                expectOpenAngle();
+                const TypeKind kind = m_program.kindOf(parseType());
+                expectCloseAngle();
+                expect("::");
+                const std::string limit = expectIdentifier();
+                expect("(");
+                expect(")");
+                expression->literal = numericLimit(kind, limit);
+                return expression;
+            }
+            expression->kind = ExpressionKind::Name;
+            expression->text = name;
+            return expression;
+        }
+
+        // "Punto(1, 2)", "std::vector<int>(3, 0)" o "std::string{}" construyen un temporal.
+        bool isTemporaryConstruction() const
+        {
+            static const std::unordered_set<std::string> templates = {"vector", "unordered_set", "set"};
+            std::size_t offset = 0;
+            if (current().text == "std" && matches(lookAhead(1), "::"))
+            {
+                offset = 2;
+            }
+            const std::string &name = lookAhead(offset).text;
+            const Token &next = lookAhead(offset + 1);
+            if (templates.count(name) > 0)
+            {
+                return matches(next, "<");
+            }
+            return (name == "string" || m_recordTypes.count(name) > 0) && (matches(next, "(") || matches(next, "{"));
+        }
+
+        Value numericLimit(TypeKind kind, const std::string &limit)
+        {
+            if (kind == TypeKind::Real)
+            {
+                if (limit == "max")
+                    return realValue(std::numeric_limits<double>::max());
+                if (limit == "lowest")
+                    return realValue(std::numeric_limits<double>::lowest());
+                if (limit == "min")
+                    return realValue(std::numeric_limits<double>::min());
+                if (limit == "infinity")
+                    return realValue(std::numeric_limits<double>::infinity());
+                if (limit == "epsilon")
+                    return realValue(std::numeric_limits<double>::epsilon());
+            }
+            else if (kind == TypeKind::Integer)
+            {
+                if (limit == "max")
+                    return integerValue(std::numeric_limits<qint32>::max());
+                if (limit == "min" || limit == "lowest")
+                    return integerValue(std::numeric_limits<qint32>::min());
+            }
+            else if (kind == TypeKind::Long || kind == TypeKind::Size)
+            {
+                if (limit == "max")
+                    return integerValue(std::numeric_limits<qint64>::max());
+                if (limit == "min" || limit == "lowest")
+                    return integerValue(kind == TypeKind::Size ? 0 : std::numeric_limits<qint64>::min());
+            }
+            fail(QStringLiteral("límite numérico no soportado: %1.").arg(QString::fromStdString(limit)));
+            return Value();
+        }
+
+        std::vector<Token> m_tokens;
+        std::size_t m_position = 0;
+        Program &m_program;
+        std::vector<FunctionDeclaration> &m_functions;
+        QStringList &m_errors;
+        std::unordered_map<std::string, int> m_recordTypes;
+        bool m_failed = false;
+    };
+
+    class BytecodeCompiler
+    {
+    public:
+        BytecodeCompiler(Program &program, const std::vector<FunctionDeclaration> &declarations, QStringList &errors)
+            : m_program(program), m_declarations(declarations), m_errors(errors)
+        {
+        }
+
+        bool compile()
+        {
+            for (int i = 0; i < static_cast<int>(m_declarations.size()); ++i)
+            {
+                const FunctionDeclaration &declaration = m_declarations[i];
+                if (declaration.record < 0 && !declaration.lambda)
+                {
+                    m_functionIndex[declaration.name] = i;
+                }
+            }
+            const auto entry = m_functionIndex.find("main");
+            if (entry == m_functionIndex.end())
+            {
+                m_errors << QStringLiteral("No se encontró la función main.");
+                return false;
+            }
+            m_program.entry = entry->second;
+            m_program.functions.resize(m_declarations.size());
+            for (int i = 0; i < static_cast<int>(m_declarations.size()) && !m_failed; ++i)
+            {
+                compileFunction(i);
+            }
+            return !m_failed;
+        }
+
+    private:
+        struct Local
+        {
+            std::string name;
+            int reg = 0;
+            int type = -1;
+            bool reference = false;
+        };
+
+        struct LoopContext
+        {
+            std::vector<int> breaks;
+            std::vector<int> continues;
+        };
+
+        enum class LValueKind
+        {
+            Local,
+            Field,
+            Element,
+            Dereference
+        };
+
+        struct LValue
+        {
+            LValueKind kind = LValueKind::Local;
+            int reg = -1;
+            int object = -1;
+            int key = -1;
+            int field = -1;
+            int name = -1;
+            int type = -1;
+        };
+
+        void fail(const QString &message)
+        {
+            if (!m_failed)
+            {
+                m_errors << QStringLiteral("Línea %1: %2").arg(m_line).arg(message);
+            }
+            m_failed = true;
+        }
+
+        QString quoted(const std::string &text) const
+        {
+            return QString::fromStdString(text);
+        }
+
+        int append(OpCode op, int a = 0, int b = 0, int c = 0, int d = 0)
+        {
+            Instruction instruction;
+            instruction.op = op;
+            instruction.a = a;
+            instruction.b = b;
+            instruction.c = c;
+            instruction.d = d;
+            m_function->code.push_back(instruction);
+            m_function->lines.push_back(m_line);
+            return static_cast<int>(m_function->code.size()) - 1;
+        }
+
+        int here() const
+        {
+            return static_cast<int>(m_function->code.size());
+        }
+
+        void patch(int position, int target)
+        {
+            Instruction &instruction = m_function->code[position];
+            switch (instruction.op)
+            {
+            case OpCode::Jump:
+                instruction.a = target;
+                break;
+            case OpCode::JumpIfFalse:
+            case OpCode::JumpIfTrue:
+                instruction.b = target;
+                break;
+            case OpCode::CompareJump:
+                instruction.c = target;
+                break;
+            case OpCode::ForEach:
+                instruction.d = target;
+                break;
+            default:
+                break;
+            }
+        }
+
+        void patchAll(const std::vector<int> &positions, int target)
+        {
+            for (int position : positions)
+            {
+                patch(position, target);
+            }
+        }
+
+        int allocate()
+        {
+            const int reg = m_nextRegister++;
+            m_function->registerCount = std::max(m_function->registerCount, m_nextRegister);
+            return reg;
+        }
+
+        int allocateBlock(int count)
+        {
+            const int base = m_nextRegister;
+            m_nextRegister += count;
+            m_function->registerCount = std::max(m_function->registerCount, m_nextRegister);
+            return base;
+        }
+
+        int targetOr(int target)
+        {
+            return target >= 0 ? target : allocate();
+        }
+
+        int constant(const Value &value)
+        {
+            std::string key;
+            switch (value.kind)
+            {
+            case ValueKind::Integer:
+                key = "i" + std::to_string(value.integer);
+                break;
+            case ValueKind::Boolean:
+                key = "b" + std::to_string(value.integer);
+                break;
+            case ValueKind::Real:
+            {
+                char buffer[40];
+                std::snprintf(buffer, sizeof(buffer), "r%.17g", value.real);
+                key = buffer;
+                break;
+            }
+            case ValueKind::Text:
+                key = "s" + value.text;
+                break;
+            case ValueKind::Callable:
+                key = "f" + std::to_string(value.integer);
+                break;
+            default:
+                m_program.constants.push_back(value);
+                return static_cast<int>(m_program.constants.size()) - 1;
+            }
+            const auto it = m_constantIndex.find(key);
+            if (it != m_constantIndex.end())
+            {
+                return it->second;
+            }
+            m_program.constants.push_back(value);
+            const int index = static_cast<int>(m_program.constants.size()) - 1;
+            m_constantIndex[key] = index;
+            return index;
+        }
+
+        TypeKind kindOf(int type) const
+        {
+            return m_program.kindOf(type);
+        }
+
+        void openScope()
+        {
+            m_scopes.emplace_back();
+            m_scopeMarks.push_back(m_nextRegister);
+        }
+
+        void closeScope()
+        {
+            m_nextRegister = m_scopeMarks.back();
+            m_scopeMarks.pop_back();
+            m_scopes.pop_back();
+        }
+
+        const Local *findLocal(const std::string &name) const
+        {
+            for (auto scope = m_scopes.rbegin(); scope != m_scopes.rend(); ++scope)
+            {
+                for (auto local = scope->rbegin(); local != scope->rend(); ++local)
+                {
+                    if (local->name == name)
+                    {
+                        return &*local;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        int declareLocal(const std::string &name, int type, int reg, bool reference = false)
+        {
+            Local local;
+            local.name = name;
+            local.reg = reg;
+            local.type = type;
+            local.reference = reference;
+            m_scopes.back().push_back(local);
+            return reg;
+        }
+
+        const RecordLayout *recordOf(int type) const
+        {
+            if (type < 0 || m_program.types[type].kind != TypeKind::Record)
+            {
+                return nullptr;
+            }
+            return &m_program.records[m_program.types[type].record];
+        }
+
+        int fieldOfThis(const std::string &name) const
+        {
+            if (m_record < 0)
+            {
+                return -1;
+            }
+            const RecordLayout &layout = m_program.records[m_record];
+            const auto it = layout.fieldIndex.find(name);
+            return it == layout.fieldIndex.end() ? -1 : it->second;
+        }
+
+        void compileFunction(int index)
+        {
+            const FunctionDeclaration &declaration = m_declarations[index];
+            m_function = &m_program.functions[index];
+            m_function->name = declaration.name;
+            m_declaration = &declaration;
+            m_scopes.clear();
+            m_scopeMarks.clear();
+            m_loops.clear();
+            m_nextRegister = 0;
+            m_line = declaration.line;
+            m_record = declaration.record;
+            openScope();
+            if (m_record >= 0)
+            {
+                allocate();
+            }
+            for (const Parameter &parameter : declaration.parameters)
+            {
+                declareLocal(parameter.name, parameter.type, allocate(), parameter.reference);
+            }
+            if (declaration.constructor)
+            {
+                const RecordLayout &layout = m_program.records[m_record];
+                for (const auto &initializer : declaration.memberInitializers)
+                {
+                    const int field = fieldOfThis(initializer.first);
+                    if (field < 0)
+                    {
+                        fail(QStringLiteral("campo desconocido en el constructor: %1.").arg(quoted(initializer.first)));
+                        return;
+                    }
+                    const int mark = m_nextRegister;
+                    const int value = allocate();
+                    std::vector<const Expression *> arguments;
+                    for (const ExpressionPtr &argument : initializer.second)
+                    {
+                        arguments.push_back(argument.get());
+                    }
+                    compileConstruction(layout.fieldTypes[field], arguments, value);
+                    append(OpCode::SetField, 0, value, field, -1);
+                    m_nextRegister = mark;
+                }
+            }
+            compileStatement(*declaration.body);
+            append(OpCode::ReturnVoid);
+            closeScope();
+        }
+
+        int typeOf(const Expression &expression) const
+        {
+            switch (expression.kind)
+            {
+            case ExpressionKind::Literal:
+                switch (expression.literal.kind)
+                {
+                case ValueKind::Integer:
+                    return static_cast<int>(TypeKind::Integer);
+                case ValueKind::Real:
+                    return static_cast<int>(TypeKind::Real);
+                case ValueKind::Boolean:
+                    return static_cast<int>(TypeKind::Boolean);
+                case ValueKind::Text:
+                    return static_cast<int>(TypeKind::Text);
+                default:
+                    return -1;
+                }
+            case ExpressionKind::Name:
+            {
+                if (const Local *local = findLocal(expression.text))
+                {
+                    return local->type;
+                }
+                const int field = fieldOfThis(expression.text);
+                return field >= 0 ? m_program.records[m_record].fieldTypes[field] : -1;
+            }
+            case ExpressionKind::Member:
+            {
+                const RecordLayout *layout = recordOf(typeOf(*expression.operands.front()));
+                if (!layout)
+                {
+                    return -1;
+                }
+                const auto it = layout->fieldIndex.find(expression.text);
+                return it == layout->fieldIndex.end() ? -1 : layout->fieldTypes[it->second];
+            }
+            case ExpressionKind::Index:
+            {
+                const int base = typeOf(*expression.operands.front());
+                if (kindOf(base) == TypeKind::List)
+                {
+                    return m_program.types[base].element;
+                }
+                return kindOf(base) == TypeKind::Text ? static_cast<int>(TypeKind::Character) : -1;
+            }
+            case ExpressionKind::Call:
+                return callType(expression);
+            case ExpressionKind::Unary:
+                if (expression.text == "!")
+                {
+                    return static_cast<int>(TypeKind::Boolean);
+                }
+                return expression.text == "*" ? -1 : typeOf(*expression.operands.front());
+            case ExpressionKind::Postfix:
+            case ExpressionKind::Assignment:
+                return typeOf(*expression.operands.front());
+            case ExpressionKind::Binary:
+                return binaryType(expression);
+            case ExpressionKind::Conditional:
+                return typeOf(*expression.operands[1]);
+            case ExpressionKind::Cast:
+                return expression.type;
+            default:
+                return -1;
+            }
+        }
+
+        int binaryType(const Expression &expression) const
+        {
+            static const std::unordered_set<std::string> logical = {"==", "!=", "<", "<=", ">", ">=", "&&", "||"};
+            if (logical.count(expression.text) > 0)
+            {
+                return static_cast<int>(TypeKind::Boolean);
+            }
+            const TypeKind left = kindOf(typeOf(*expression.operands[0]));
+            const TypeKind right = kindOf(typeOf(*expression.operands[1]));
+            if (left == TypeKind::Text || right == TypeKind::Text)
+            {
+                return static_cast<int>(TypeKind::Text);
+            }
+            if (left == TypeKind::Real || right == TypeKind::Real)
+            {
+                return static_cast<int>(TypeKind::Real);
+            }
+            const auto integral = [](TypeKind kind)
+            {
+                return kind == TypeKind::Integer || kind == TypeKind::Long || kind == TypeKind::Size ||
+                       kind == TypeKind::Boolean || kind == TypeKind::Character;
+            };
+            if (integral(left) && integral(right))
+            {
+                const TypeKind wider = std::max(std::max(left, right), TypeKind::Integer);
+                return static_cast<int>(wider == TypeKind::Boolean || wider == TypeKind::Character ? TypeKind::Integer : wider);
+            }
+            return -1;
+        }
+
+        int callType(const Expression &call) const
+        {
+            const Expression &callee = *call.operands.front();
+            if (callee.kind == ExpressionKind::Name)
+            {
+                const auto function = m_functionIndex.find(callee.text);
+                if (function != m_functionIndex.end())
+                {
+                    return m_declarations[function->second].returnType;
+                }
+                switch (libraryFunctionFor(callee.text))
+                {
+                case LibraryFunction::Max:
+                case LibraryFunction::Min:
+                case LibraryFunction::Abs:
+                    return call.operands.size() > 1 ? typeOf(*call.operands[1]) : -1;
+                case LibraryFunction::Sqrt:
+                case LibraryFunction::Pow:
+                case LibraryFunction::Floor:
+                case LibraryFunction::Ceil:
+                case LibraryFunction::Round:
+                    return static_cast<int>(TypeKind::Real);
+                case LibraryFunction::ToString:
+                    return static_cast<int>(TypeKind::Text);
+                case LibraryFunction::BinarySearch:
+                case LibraryFunction::IsFinite:
+                    return static_cast<int>(TypeKind::Boolean);
+                case LibraryFunction::Count:
+                    return static_cast<int>(TypeKind::Long);
+                default:
+                    return (callee.text == "std::move" && call.operands.size() > 1) ? typeOf(*call.operands[1]) : -1;
+                }
+            }
+            if (callee.kind != ExpressionKind::Member)
+            {
+                return -1;
+            }
+            const int objectType = typeOf(*callee.operands.front());
+            if (const RecordLayout *layout = recordOf(objectType))
+            {
+                const auto method = layout->methods.find(callee.text);
+                return method == layout->methods.end() ? -1 : m_declarations[method->second].returnType;
+            }
+            switch (memberFunctionFor(callee.text))
+            {
+            case MemberFunction::Size:
+            case MemberFunction::Count:
+                return static_cast<int>(TypeKind::Size);
+            case MemberFunction::Empty:
+                return static_cast<int>(TypeKind::Boolean);
+            case MemberFunction::Back:
+            case MemberFunction::Front:
+            case MemberFunction::At:
+                if (kindOf(objectType) == TypeKind::List)
+                {
+                    return m_program.types[objectType].element;
+                }
+                return kindOf(objectType) == TypeKind::Text ? static_cast<int>(TypeKind::Character) : -1;
+            case MemberFunction::Substring:
+                return static_cast<int>(TypeKind::Text);
+            default:
+                return -1;
+            }
+        }
+
+        bool isLvalue(const Expression &expression) const
+        {
+            switch (expression.kind)
+            {
+            case ExpressionKind::Name:
+            case ExpressionKind::Member:
+            case ExpressionKind::Index:
+                return true;
+            case ExpressionKind::Unary:
+                return expression.text == "*";
+            case ExpressionKind::Conditional:
+                return isLvalue(*expression.operands[1]) || isLvalue(*expression.operands[2]);
+            default:
+                return false;
+            }
+        }
+
+        bool conversionNeeded(TypeKind kind, const Expression &value) const
+        {
+            const TypeKind source = kindOf(typeOf(value));
+            if (kind == TypeKind::Real || kind == TypeKind::Text || kind == TypeKind::Boolean)
+            {
+                return source != kind;
+            }
+            if (source != kind)
+            {
+                return true;
+            }
+            return value.kind == ExpressionKind::Binary || value.kind == ExpressionKind::Unary;
+        }
+
+        void compileStatement(const Statement &statement)
+        {
+            if (m_failed)
+            {
+                return;
+            }
+            m_line = statement.line;
+            const int mark = m_nextRegister;
+            switch (statement.kind)
+            {
+            case StatementKind::Block:
+                openScope();
+                for (const StatementPtr &child : statement.statements)
+                {
+                    compileStatement(*child);
+                }
+                closeScope();
+                break;
+            case StatementKind::Declaration:
+                for (const Declarator &declarator : statement.declarators)
+                {
+                    compileDeclarator(statement, declarator);
+                }
+                return;
+            case StatementKind::Expression:
+                compileEffect(*statement.expression);
+                break;
+            case StatementKind::If:
+            {
+                const std::vector<int> otherwise = compileBranch(*statement.expression, false);
+                m_nextRegister = mark;
+                compileStatement(*statement.body);
+                if (statement.alternative)
+                {
+                    const int skip = append(OpCode::Jump, -1);
+                    patchAll(otherwise, here());
+                    compileStatement(*statement.alternative);
+                    patch(skip, here());
+                }
+                else
+                {
+                    patchAll(otherwise, here());
+                }
+                break;
+            }
+            case StatementKind::While:
+            {
+                const int start = here();
+                const std::vector<int> exits = compileBranch(*statement.expression, false);
+                m_nextRegister = mark;
+                m_loops.emplace_back();
+                compileStatement(*statement.body);
+                append(OpCode::Jump, start);
+                finishLoop(start, exits);
+                break;
+            }
+            case StatementKind::DoWhile:
+            {
+                const int start = here();
+                m_loops.emplace_back();
+                compileStatement(*statement.body);
+                const int condition = here();
+                patchAll(compileBranch(*statement.expression, true), start);
+                finishLoop(condition, {});
+                break;
+            }
+            case StatementKind::For:
+                compileFor(statement);
+                break;
+            case StatementKind::RangeFor:
+                compileRangeFor(statement);
+                break;
+            case StatementKind::Return:
+                compileReturn(statement);
+                break;
+            case StatementKind::Break:
+            case StatementKind::Continue:
+                if (m_loops.empty())
+                {
+                    fail(QStringLiteral("'break' o 'continue' fuera de un ciclo."));
+                    return;
+                }
+                (statement.kind == StatementKind::Break ? m_loops.back().breaks : m_loops.back().continues).push_back(append(OpCode::Jump, -1));
+                break;
+            case StatementKind::Empty:
+                break;
+            }
+            m_nextRegister = mark;
+        }
+
+        void finishLoop(int continueTarget, const std::vector<int> &exits)
+        {
+            const LoopContext loop = m_loops.back();
+            m_loops.pop_back();
+            patchAll(loop.continues, continueTarget);
+            patchAll(loop.breaks, here());
+            patchAll(exits, here());
+        }
+
+        void compileFor(const Statement &statement)
+        {
+            openScope();
+            if (statement.initializer)
+            {
+                compileStatement(*statement.initializer);
+            }
+            const int mark = m_nextRegister;
+            const int start = here();
+            std::vector<int> exits;
+            if (statement.expression)
+            {
+                exits = compileBranch(*statement.expression, false);
+                m_nextRegister = mark;
+            }
+            m_loops.emplace_back();
+            compileStatement(*statement.body);
+            const int continueTarget = here();
+            if (statement.step)
+            {
+                m_line = statement.line;
+                compileEffect(*statement.step);
+                m_nextRegister = mark;
+            }
+            append(OpCode::Jump, start);
+            finishLoop(continueTarget, exits);
+            closeScope();
+        }
+
+        void compileRangeFor(const Statement &statement)
+        {
+            openScope();
+            const Declarator &variable = statement.declarators.front();
+            const int collection = allocate();
+            compileExpression(*statement.expression, collection);
+            const int position = allocate();
+            append(OpCode::LoadConstant, position, constant(integerValue(0)));
+            int type = variable.type;
+            const int rangeType = typeOf(*statement.expression);
+            if (kindOf(type) == TypeKind::Automatic)
+            {
+                if (kindOf(rangeType) == TypeKind::List)
+                {
+                    type = m_program.types[rangeType].element;
+                }
+                else if (kindOf(rangeType) == TypeKind::Text)
+                {
+                    type = static_cast<int>(TypeKind::Character);
+                }
+            }
+            const int element = declareLocal(variable.name, type, allocate(), statement.reference);
+            const int start = append(OpCode::ForEach, element, collection, position, -1);
+            if (!statement.reference)
+            {
+                append(OpCode::Copy, element, element);
+            }
+            const int elementType = kindOf(rangeType) == TypeKind::List ? m_program.types[rangeType].element : -1;
+            if (isScalarKind(kindOf(variable.type)) && kindOf(variable.type) != kindOf(elementType))
+            {
+                append(OpCode::Convert, element, element, static_cast<int>(kindOf(variable.type)));
+            }
+            m_loops.emplace_back();
+            compileStatement(*statement.body);
+            const int continueTarget = here();
+            if (statement.reference && !statement.constant)
+            {
+                append(OpCode::SetIndex, collection, position, element);
+            }
+            append(OpCode::Increment, position, 1);
+            append(OpCode::Jump, start);
+            finishLoop(continueTarget, {start});
+            closeScope();
+        }
+
+        void compileReturn(const Statement &statement)
+        {
+            if (!statement.expression)
+            {
+                append(OpCode::ReturnVoid);
+                return;
+            }
+            const Expression &value = *statement.expression;
+            const int returnType = m_declaration->returnType;
+            const TypeKind kind = kindOf(returnType);
+            int result = compileExpression(value, -1);
+            if (isScalarKind(kind) && conversionNeeded(kind, value))
+            {
+                const int converted = allocate();
+                append(OpCode::Convert, converted, result, static_cast<int>(kind));
+                result = converted;
+            }
+            else if (isLvalue(value))
+            {
+                const Local *local = value.kind == ExpressionKind::Name ? findLocal(value.text) : nullptr;
+                if (!local || local->reference)
+                {
+                    const int copy = allocate();
+                    append(OpCode::Copy, copy, result);
+                    result = copy;
+                }
+            }
+            append(OpCode::Return, result);
+        }
+
+        void compileDeclarator(const Statement &statement, const Declarator &declarator)
+        {
+            m_line = declarator.line;
+            const int reg = allocate();
+            int type = declarator.type;
+            if (declarator.isArray)
+            {
+                if (declarator.initializer)
+                {
+                    compileBracedInitialization(type, *declarator.initializer, reg);
+                    if (declarator.arraySize)
+                    {
+                        const int base = allocateBlock(2);
+                        append(OpCode::Move, base, reg);
+                        compileExpression(*declarator.arraySize, base + 1);
+                        append(OpCode::CallMember, allocate(), memberCall("resize", MemberFunction::Resize, 1), base);
+                    }
+                }
+                else if (declarator.arraySize)
+                {
+                    const int size = compileExpression(*declarator.arraySize, -1);
+                    append(OpCode::NewList, reg, type, size, -1);
+                }
+                else
+                {
+                    fail(QStringLiteral("arreglo sin tamaño: %1.").arg(quoted(declarator.name)));
+                }
+            }
+            else if (declarator.constructed)
+            {
+                std::vector<const Expression *> arguments;
+                for (const ExpressionPtr &argument : declarator.arguments)
+                {
+                    arguments.push_back(argument.get());
+                }
+                compileConstruction(type, arguments, reg);
+            }
+            else if (declarator.initializer && declarator.initializer->kind == ExpressionKind::BracedList)
+            {
+                compileBracedInitialization(type, *declarator.initializer, reg);
+            }
+            else if (declarator.initializer)
+            {
+                if (kindOf(type) == TypeKind::Automatic)
+                {
+                    const int inferred = typeOf(*declarator.initializer);
+                    if (inferred >= 0)
+                    {
+                        type = inferred;
+                    }
+                }
+                compileAssignedValue(statement.reference ? -1 : type, *declarator.initializer, reg, statement.reference);
+            }
+            else
+            {
+                compileConstruction(type, {}, reg);
+            }
+            declareLocal(declarator.name, type, reg, statement.reference);
+            m_nextRegister = reg + 1;
+        }
+
+        void compileAssignedValue(int type, const Expression &value, int reg, bool alias = false)
+        {
+            const TypeKind kind = kindOf(type);
+            if (value.kind == ExpressionKind::Literal && isScalarKind(kind))
+            {
+                Value literal = value.literal;
+                QString error;
+                if (!convertValue(literal, kind, error))
+                {
+                    fail(error);
+                    return;
+                }
+                append(OpCode::LoadConstant, reg, constant(literal));
+                return;
+            }
+            if (isScalarKind(kind) && conversionNeeded(kind, value))
+            {
+                const int source = compileExpression(value, -1);
+                append(OpCode::Convert, reg, source, static_cast<int>(kind));
+                return;
+            }
+            if (!alias && !isScalarKind(kind) && isLvalue(value))
+            {
+                const int source = compileExpression(value, -1);
+                append(OpCode::Copy, reg, source);
+                return;
+            }
+            compileExpression(value, reg);
+        }
+
+        void compileConstruction(int type, const std::vector<const Expression *> &arguments, int reg)
+        {
+            switch (kindOf(type))
+            {
+            case TypeKind::List:
+                if (arguments.empty())
+                {
+                    append(OpCode::NewValue, reg, type);
+                }
+                else
+                {
+                    const int size = compileExpression(*arguments[0], -1);
+                    const int fill = arguments.size() > 1 ? compileExpression(*arguments[1], -1) : -1;
+                    append(OpCode::NewList, reg, type, size, fill);
+                }
+                return;
+            case TypeKind::Set:
+                append(OpCode::NewValue, reg, type);
+                if (arguments.size() == 2)
+                {
+                    const int base = allocateBlock(3);
+                    append(OpCode::Move, base, reg);
+                    compileExpression(*arguments[0], base + 1);
+                    compileExpression(*arguments[1], base + 2);
+                    append(OpCode::CallMember, allocate(), memberCall("insert", MemberFunction::Insert, 2), base);
+                }
+                else if (!arguments.empty())
+                {
+                    fail(QStringLiteral("constructor de conjunto no soportado."));
+                }
+                return;
+            case TypeKind::Record:
+            {
+                append(OpCode::NewValue, reg, type);
+                const RecordLayout &layout = m_program.records[m_program.types[type].record];
+                for (int constructor : layout.constructors)
+                {
+                    const FunctionDeclaration &declaration = m_declarations[constructor];
+                    int required = 0;
+                    for (const Parameter &parameter : declaration.parameters)
+                    {
+                        required += parameter.defaultValue ? 0 : 1;
+                    }
+                    if (static_cast<int>(arguments.size()) >= required && arguments.size() <= declaration.parameters.size())
+                    {
+                        emitUserCall(constructor, reg, arguments, allocate());
+                        return;
+                    }
+                }
+                if (!arguments.empty())
+                {
+                    fail(QStringLiteral("no hay un constructor de %1 con %2 argumentos.").arg(quoted(layout.name)).arg(arguments.size()));
+                }
+                return;
+            }
+            default:
+                if (arguments.empty())
+                {
+                    append(OpCode::NewValue, reg, type);
+                }
+                else
+                {
+                    compileAssignedValue(type, *arguments[0], reg);
+                }
+                return;
+            }
+        }
+
+        void compileBracedInitialization(int type, const Expression &list, int reg)
+        {
+            const TypeKind kind = kindOf(type);
+            if (kind == TypeKind::Record)
+            {
+                const RecordLayout &layout = m_program.records[m_program.types[type].record];
+                if (list.operands.size() > layout.fields.size())
+                {
+                    fail(QStringLiteral("demasiados valores para la estructura %1.").arg(quoted(layout.name)));
+                    return;
+                }
+                append(OpCode::NewValue, reg, type);
+                for (int i = 0; i < static_cast<int>(list.operands.size()); ++i)
+                {
+                    const int mark = m_nextRegister;
+                    const int value = allocate();
+                    compileElement(layout.fieldTypes[i], *list.operands[i], value);
+                    append(OpCode::SetField, reg, value, i, -1);
+                    m_nextRegister = mark;
+                }
+                return;
+            }
+            if (kind == TypeKind::List || kind == TypeKind::Set || kind == TypeKind::Automatic)
+            {
+                const int element = type >= 0 ? m_program.types[type].element : -1;
+                const int count = static_cast<int>(list.operands.size());
+                const int base = allocateBlock(count);
+                for (int i = 0; i < count; ++i)
+                {
+                    compileElement(element, *list.operands[i], base + i);
+                }
+                append(OpCode::MakeList, reg, type, base, count);
+                return;
+            }
+            if (list.operands.empty())
+            {
+                append(OpCode::NewValue, reg, type);
+                return;
+            }
+            compileAssignedValue(type, *list.operands.front(), reg);
+        }
+
+        void compileElement(int type, const Expression &value, int reg)
+        {
+            if (value.kind == ExpressionKind::BracedList)
+            {
+                compileBracedInitialization(type, value, reg);
+                return;
+            }
+            compileAssignedValue(type, value, reg);
+        }
+
+        int memberCall(const std::string &name, MemberFunction function, int argumentCount)
+        {
+            for (int i = 0; i < static_cast<int>(m_program.memberCalls.size()); ++i)
+            {
+                const MemberCall &call = m_program.memberCalls[i];
+                if (call.name == name && call.function == function && call.argumentCount == argumentCount)
+                {
+                    return i;
+                }
+            }
+            MemberCall call;
+            call.name = name;
+            call.function = function;
+            call.argumentCount = argumentCount;
+            m_program.memberCalls.push_back(call);
+            return static_cast<int>(m_program.memberCalls.size()) - 1;
+        }
+
+        void emitUserCall(int function, int object, const std::vector<const Expression *> &arguments, int target)
+        {
+            const FunctionDeclaration &callee = m_declarations[function];
+            const int offset = callee.record >= 0 ? 1 : 0;
+            const int count = static_cast<int>(callee.parameters.size()) + offset;
+            if (arguments.size() > callee.parameters.size())
+            {
+                fail(QStringLiteral("demasiados argumentos en la llamada a %1.").arg(quoted(callee.name)));
+                return;
+            }
+            const int base = allocateBlock(count);
+            if (offset > 0)
+            {
+                append(OpCode::Move, base, object);
+            }
+            for (int i = 0; i < static_cast<int>(callee.parameters.size()); ++i)
+            {
+                const Parameter &parameter = callee.parameters[i];
+                const Expression *argument = i < static_cast<int>(arguments.size()) ? arguments[i] : parameter.defaultValue.get();
+                if (!argument)
+                {
+                    fail(QStringLiteral("faltan argumentos en la llamada a %1.").arg(quoted(callee.name)));
+                    return;
+                }
+                compileAssignedValue(parameter.type, *argument, base + offset + i, parameter.reference);
+            }
+            append(OpCode::Call, target, function, base, count);
+        }
+
+        static OpCode binaryOpCode(const std::string &op)
+        {
+            static const std::unordered_map<std::string, OpCode> table = {
+                {"+", OpCode::Add}, {"-", OpCode::Subtract}, {"*", OpCode::Multiply}, {"/", OpCode::Divide},
+                {"%", OpCode::Modulo}, {"==", OpCode::Equal}, {"!=", OpCode::NotEqual}, {"<", OpCode::Less},
+                {"<=", OpCode::LessEqual}, {">", OpCode::Greater}, {">=", OpCode::GreaterEqual}};
+            const auto it = table.find(op);
+            return it == table.end() ? OpCode::ReturnVoid : it->second;
+        }
+
+        static bool isComparison(OpCode op)
+        {
+            return op >= OpCode::Equal && op <= OpCode::GreaterEqual;
+        }
+
+        void compileEffect(const Expression &expression)
+        {
+            if (expression.kind == ExpressionKind::Postfix)
+            {
+                compileIncrement(*expression.operands.front(), expression.text == "++" ? 1 : -1, true, -1);
+                return;
+            }
+            compileExpression(expression, -1);
+        }
+
+        std::vector<int> compileBranch(const Expression &condition, bool jumpWhen)
+        {
+            if (condition.kind == ExpressionKind::Binary && (condition.text == "&&" || condition.text == "||"))
+            {
+                const bool conjunction = condition.text == "&&";
+                if (conjunction != jumpWhen)
+                {
+                    std::vector<int> jumps = compileBranch(*condition.operands[0], jumpWhen);
+                    const std::vector<int> second = compileBranch(*condition.operands[1], jumpWhen);
+                    jumps.insert(jumps.end(), second.begin(), second.end());
+                    return jumps;
+                }
+                const std::vector<int> shortCircuit = compileBranch(*condition.operands[0], !jumpWhen);
+                const std::vector<int> jumps = compileBranch(*condition.operands[1], jumpWhen);
+                patchAll(shortCircuit, here());
+                return jumps;
+            }
+            if (condition.kind == ExpressionKind::Unary && condition.text == "!")
+            {
+                return compileBranch(*condition.operands.front(), !jumpWhen);
+            }
+            if (condition.kind == ExpressionKind::Binary && isComparison(binaryOpCode(condition.text)))
+            {
+                const int mark = m_nextRegister;
+                const int left = compileExpression(*condition.operands[0], -1);
+                const int right = compileExpression(*condition.operands[1], -1);
+                m_nextRegister = mark;
+                const int comparison = static_cast<int>(binaryOpCode(condition.text)) | (jumpWhen ? 0x100 : 0);
+                return {append(OpCode::CompareJump, left, right, -1, comparison)};
+            }
+            if (condition.kind == ExpressionKind::Literal && condition.literal.kind == ValueKind::Boolean)
+            {
+                if ((condition.literal.integer != 0) == jumpWhen)
+                {
+                    return {append(OpCode::Jump, -1)};
+                }
+                return {};
+            }
+            const int mark = m_nextRegister;
+            const int value = compileExpression(condition, -1);
+            m_nextRegister = mark;
+            return {append(jumpWhen ? OpCode::JumpIfTrue : OpCode::JumpIfFalse, value, -1)};
+        }
+
+        static const Expression *streamRoot(const Expression &expression, const char *op)
+        {
+            const Expression *node = &expression;
+            while (node->kind == ExpressionKind::Binary && node->text == op)
+            {
+                node = node->operands.front().get();
+            }
+            return node;
+        }
+
+        static std::vector<const Expression *> streamItems(const Expression &expression)
+        {
+            std::vector<const Expression *> items;
+            const Expression *node = &expression;
+            while (node->kind == ExpressionKind::Binary && node->text == expression.text)
+            {
+                items.push_back(node->operands[1].get());
+                node = node->operands[0].get();
+            }
+            std::reverse(items.begin(), items.end());
+            return items;
+        }
+
+        static bool isNamed(const Expression &expression, const char *name)
+        {
+            return expression.kind == ExpressionKind::Name &&
+                   (expression.text == name || expression.text == std::string("std::") + name);
+        }
+
+        int compileExpression(const Expression &expression, int target)
+        {
+            if (m_failed)
+            {
+                return targetOr(target);
+            }
+            m_line = expression.line;
+            switch (expression.kind)
+            {
+            case ExpressionKind::Literal:
+            {
+                const int reg = targetOr(target);
+                append(OpCode::LoadConstant, reg, constant(expression.literal));
+                return reg;
+            }
+            case ExpressionKind::Name:
+                return compileName(expression, target);
+            case ExpressionKind::Member:
+            case ExpressionKind::Index:
+            {
+                const LValue place = compileLValue(expression);
+                return loadLValue(place, targetOr(target));
+            }
+            case ExpressionKind::Call:
+                return compileCall(expression, target);
+            case ExpressionKind::Unary:
+                return compileUnary(expression, target);
+            case ExpressionKind::Postfix:
+                return compileIncrement(*expression.operands.front(), expression.text == "++" ? 1 : -1, false, target);
+            case ExpressionKind::Binary:
+                return compileBinary(expression, target);
+            case ExpressionKind::Assignment:
+                return compileAssignment(expression, target);
+            case ExpressionKind::Conditional:
+            {
+                const int reg = targetOr(target);
+                const std::vector<int> otherwise = compileBranch(*expression.operands[0], false);
+                compileExpression(*expression.operands[1], reg);
+                const int skip = append(OpCode::Jump, -1);
+                patchAll(otherwise, here());
+                compileExpression(*expression.operands[2], reg);
+                patch(skip, here());
+                return reg;
+            }
+            case ExpressionKind::Cast:
+            {
+                const int reg = targetOr(target);
+                if (expression.operands.size() == 1 && expression.operands.front()->kind == ExpressionKind::BracedList)
+                {
+                    compileBracedInitialization(expression.type, *expression.operands.front(), reg);
+                }
+                else if (expression.operands.size() == 1 && isScalarKind(kindOf(expression.type)))
+                {
+                    compileAssignedValue(expression.type, *expression.operands.front(), reg);
+                }
+                else
+                {
+                    std::vector<const Expression *> arguments;
+                    for (const ExpressionPtr &operand : expression.operands)
+                    {
+                        arguments.push_back(operand.get());
+                    }
+                    compileConstruction(expression.type, arguments, reg);
+                }
+                return reg;
+            }
+            case ExpressionKind::Lambda:
+            {
+                Value callable;
+                callable.kind = ValueKind::Callable;
+                callable.integer = expression.function;
+                const int reg = targetOr(target);
+                append(OpCode::LoadConstant, reg, constant(callable));
+                return reg;
+            }
+            case ExpressionKind::BracedList:
+            {
+                const int reg = targetOr(target);
+                compileBracedInitialization(-1, expression, reg);
+                return reg;
+            }
+            }
+            return targetOr(target);
+        }
+
+        int compileName(const Expression &expression, int target)
+        {
+            if (const Local *local = findLocal(expression.text))
+            {
+                if (target >= 0 && target != local->reg)
+                {
+                    append(OpCode::Move, target, local->reg);
+                    return target;
+                }
+                return local->reg;
+            }
+            const int field = fieldOfThis(expression.text);
+            if (field >= 0)
+            {
+                const int reg = targetOr(target);
+                append(OpCode::GetField, reg, 0, field, -1);
+                return reg;
+            }
+            fail(QStringLiteral("identificador desconocido: %1.").arg(quoted(expression.text)));
+            return targetOr(target);
+        }
+
+        int compileUnary(const Expression &expression, int target)
+        {
+            const Expression &operand = *expression.operands.front();
+            if (expression.text == "++" || expression.text == "--")
+            {
+                return compileIncrement(operand, expression.text == "++" ? 1 : -1, true, target);
+            }
+            if (expression.text == "+")
+            {
+                return compileExpression(operand, target);
+            }
+            if (expression.text == "-" && operand.kind == ExpressionKind::Literal && isNumeric(operand.literal))
+            {
+                Value negated = operand.literal;
+                if (negated.kind == ValueKind::Real)
+                {
+                    negated.real = -negated.real;
+                }
+                else
+                {
+                    negated = integerValue(-negated.integer);
+                }
+                const int reg = targetOr(target);
+                append(OpCode::LoadConstant, reg, constant(negated));
+                return reg;
+            }
+            const int value = compileExpression(operand, -1);
+            const int reg = targetOr(target);
+            if (expression.text == "!")
+            {
+                append(OpCode::Not, reg, value);
+            }
+            else if (expression.text == "-")
+            {
+                append(OpCode::Negate, reg, value);
+            }
+            else
+            {
+                append(OpCode::Dereference, reg, value);
+            }
+            return reg;
+        }
+
+        int compileBinary(const Expression &expression, int target)
+        {
+            const Expression *root = streamRoot(expression, expression.text.c_str());
+            if (expression.text == "<<" && (isNamed(*root, "cout") || isNamed(*root, "cerr")))
+            {
+                compileOutput(expression, isNamed(*root, "cerr") ? 1 : 0);
+                return targetOr(target);
+            }
+            if (expression.text == ">>" && isNamed(*root, "cin"))
+            {
+                compileInput(expression);
+                return targetOr(target);
+            }
+            if (expression.text == "&&" || expression.text == "||")
+            {
+                const int reg = targetOr(target);
+                const std::vector<int> otherwise = compileBranch(expression, false);
+                append(OpCode::LoadConstant, reg, constant(booleanValue(true)));
+                const int skip = append(OpCode::Jump, -1);
+                patchAll(otherwise, here());
+                append(OpCode::LoadConstant, reg, constant(booleanValue(false)));
+                patch(skip, here());
+                return reg;
+            }
+            const OpCode op = binaryOpCode(expression.text);
+            if (op == OpCode::ReturnVoid)
+            {
+                fail(QStringLiteral("operador no soportado: %1.").arg(quoted(expression.text)));
+                return targetOr(target);
+            }
+            const int left = compileExpression(*expression.operands[0], -1);
+            const int right = compileExpression(*expression.operands[1], -1);
+            const int reg = targetOr(target);
+            append(op, reg, left, right);
+            return reg;
+        }
+
+        void compileOutput(const Expression &expression, int stream)
+        {
+            for (const Expression *item : streamItems(expression))
+            {
+                const int mark = m_nextRegister;
+                if (isNamed(*item, "endl"))
+                {
+                    append(OpCode::Print, -1, stream, constant(textValue("\n")));
+                }
+                else if (isNamed(*item, "flush"))
+                {
+                    continue;
+                }
+                else if (item->kind == ExpressionKind::Literal)
+                {
+                    append(OpCode::Print, -1, stream, constant(item->literal));
+                }
+                else
+                {
+                    append(OpCode::Print, compileExpression(*item, -1), stream, -1);
+                }
+                m_nextRegister = mark;
+            }
+        }
+
+        void compileInput(const Expression &expression)
+        {
+            for (const Expression *item : streamItems(expression))
+            {
+                const int mark = m_nextRegister;
+                const LValue place = compileLValue(*item);
+                TypeKind kind = kindOf(place.type);
+                if (!isScalarKind(kind))
+                {
+                    kind = TypeKind::Text;
+                }
+                if (place.kind == LValueKind::Local)
+                {
+                    append(OpCode::Read, place.reg, static_cast<int>(kind));
+                }
+                else
+                {
+                    const int value = loadLValue(place, allocate());
+                    append(OpCode::Read, value, static_cast<int>(kind));
+                    storeLValue(place, value);
+                }
+                m_nextRegister = mark;
+            }
+        }
+
+        LValue compileLValue(const Expression &expression)
+        {
+            LValue place;
+            place.type = typeOf(expression);
+            switch (expression.kind)
+            {
+            case ExpressionKind::Name:
+                if (const Local *local = findLocal(expression.text))
+                {
+                    place.reg = local->reg;
+                    return place;
+                }
+                place.kind = LValueKind::Field;
+                place.object = 0;
+                place.field = fieldOfThis(expression.text);
+                if (place.field < 0)
+                {
+                    fail(QStringLiteral("identificador desconocido: %1.").arg(quoted(expression.text)));
+                }
+                return place;
+            case ExpressionKind::Member:
+            {
+                const Expression &object = *expression.operands.front();
+                place.kind = LValueKind::Field;
+                place.object = compileExpression(object, -1);
+                if (const RecordLayout *layout = recordOf(typeOf(object)))
+                {
+                    const auto it = layout->fieldIndex.find(expression.text);
+                    if (it == layout->fieldIndex.end())
+                    {
+                        fail(QStringLiteral("la estructura %1 no tiene el campo %2.").arg(quoted(layout->name), quoted(expression.text)));
+                        return place;
+                    }
+                    place.field = it->second;
+                }
+                else
+                {
+                    place.name = constant(textValue(expression.text));
+                }
+                return place;
+            }
+            case ExpressionKind::Index:
+                place.kind = LValueKind::Element;
+                place.object = compileExpression(*expression.operands[0], -1);
+                place.key = compileExpression(*expression.operands[1], -1);
+                return place;
+            case ExpressionKind::Unary:
+                if (expression.text == "*")
+                {
+                    place.kind = LValueKind::Dereference;
+                    place.object = compileExpression(*expression.operands.front(), -1);
+                    return place;
+                }
+                break;
+            default:
+                break;
+            }
+            fail(QStringLiteral("la expresión no se puede asignar."));
+            return place;
+        }
+
+        int loadLValue(const LValue &place, int target)
+        {
+            switch (place.kind)
+            {
+            case LValueKind::Local:
+                if (target >= 0 && target != place.reg)
+                {
+                    append(OpCode::Move, target, place.reg);
+                    return target;
+                }
+                return place.reg;
+            case LValueKind::Field:
+                target = targetOr(target);
+                append(OpCode::GetField, target, place.object, place.field, place.name);
+                return target;
+            case LValueKind::Element:
+                target = targetOr(target);
+                append(OpCode::GetIndex, target, place.object, place.key);
+                return target;
+            case LValueKind::Dereference:
+                target = targetOr(target);
+                append(OpCode::Dereference, target, place.object);
+                return target;
+            }
+            return target;
+        }
+
+        void storeLValue(const LValue &place, int value)
+        {
+            switch (place.kind)
+            {
+            case LValueKind::Local:
+                if (isScalarKind(kindOf(place.type)))
+                {
+                    append(OpCode::Convert, place.reg, value, static_cast<int>(kindOf(place.type)));
+                }
+                else if (value != place.reg)
+                {
+                    append(OpCode::Move, place.reg, value);
+                }
+                break;
+            case LValueKind::Field:
+                append(OpCode::SetField, place.object, value, place.field, place.name);
+                break;
+            case LValueKind::Element:
+                append(OpCode::SetIndex, place.object, place.key, value);
+                break;
+            case LValueKind::Dereference:
+                append(OpCode::SetDereference, place.object, value);
+                break;
+            }
+        }
+
+        int compileAssignment(const Expression &expression, int target)
+        {
+            const Expression &value = *expression.operands[1];
+            const LValue place = compileLValue(*expression.operands[0]);
+            const TypeKind kind = kindOf(place.type);
+            int result = place.reg;
+            if (expression.text == "=")
+            {
+                if (place.kind == LValueKind::Local)
+                {
+                    compileElement(place.type, value, place.reg);
+                }
+                else
+                {
+                    result = allocate();
+                    compileElement(place.type, value, result);
+                    storeLValue(place, result);
+                }
+            }
+            else
+            {
+                const OpCode op = binaryOpCode(expression.text.substr(0, 1));
+                const int operand = compileExpression(value, -1);
+                if (place.kind == LValueKind::Local)
+                {
+                    append(op, place.reg, place.reg, operand);
+                    if (isScalarKind(kind) && (kind == TypeKind::Integer || conversionNeeded(kind, value)))
+                    {
+                        append(OpCode::Convert, place.reg, place.reg, static_cast<int>(kind));
+                    }
+                }
+                else
+                {
+                    const int current = loadLValue(place, -1);
+                    result = allocate();
+                    append(op, result, current, operand);
+                    storeLValue(place, result);
+                }
+            }
+            if (target >= 0 && target != result)
+            {
+                append(OpCode::Move, target, result);
+                return target;
+            }
+            return result;
+        }
+
+        int compileIncrement(const Expression &operand, int delta, bool prefix, int target)
+        {
+            const LValue place = compileLValue(operand);
+            const int value = place.kind == LValueKind::Local ? place.reg : loadLValue(place, allocate());
+            int result = value;
+            if (!prefix)
+            {
+                result = targetOr(target);
+                append(OpCode::Move, result, value);
+            }
+            append(OpCode::Increment, value, delta);
+            if (place.kind != LValueKind::Local)
+            {
+                storeLValue(place, value);
+            }
+            if (target >= 0 && target != result)
+            {
+                append(OpCode::Move, target, result);
+                return target;
+            }
+            return result;
+        }
+
+        int compileCall(const Expression &call, int target)
+        {
+            const Expression &callee = *call.operands.front();
+            std::vector<const Expression *> arguments;
+            for (std::size_t i = 1; i < call.operands.size(); ++i)
+            {
+                arguments.push_back(call.operands[i].get());
+            }
+            if (callee.kind == ExpressionKind::Member)
+            {
+                return compileMemberCall(callee, arguments, target);
+            }
+            if (callee.kind != ExpressionKind::Name)
+            {
+                fail(QStringLiteral("llamada no soportada."));
+                return targetOr(target);
+            }
+            if (isNamed(callee, "move") && arguments.size() == 1)
+            {
+                return compileExpression(*arguments.front(), target);
+            }
+            if (isNamed(callee, "swap") && arguments.size() == 2)
+            {
+                const LValue first = compileLValue(*arguments[0]);
+                const LValue second = compileLValue(*arguments[1]);
+                const int firstValue = loadLValue(first, allocate());
+                const int secondValue = loadLValue(second, allocate());
+                storeLValue(first, secondValue);
+                storeLValue(second, firstValue);
+                return targetOr(target);
+            }
+            if (m_record >= 0 && !findLocal(callee.text))
+            {
+                const RecordLayout &layout = m_program.records[m_record];
+                const auto method = layout.methods.find(callee.text);
+                if (method != layout.methods.end())
+                {
+                    const int reg = targetOr(target);
+                    emitUserCall(method->second, 0, arguments, reg);
+                    return reg;
+                }
+            }
+            const auto function = m_functionIndex.find(callee.text);
+            if (function != m_functionIndex.end())
+            {
+                const int reg = targetOr(target);
+                emitUserCall(function->second, -1, arguments, reg);
+                return reg;
+            }
+            LibraryFunction library = libraryFunctionFor(callee.text);
+            if (library == LibraryFunction::Unknown)
+            {
+                fail(QStringLiteral("función desconocida: %1.").arg(quoted(callee.text)));
+                return targetOr(target);
+            }
+            if (library == LibraryFunction::Sort && arguments.size() == 3)
+            {
+                const int order = comparatorOrder(*arguments[2]);
+                if (order != 0)
+                {
+                    library = order > 0 ? LibraryFunction::Sort : LibraryFunction::SortDescending;
+                    arguments.pop_back();
+                }
+            }
+            const int count = static_cast<int>(arguments.size());
+            const int base = allocateBlock(count);
+            for (int i = 0; i < count; ++i)
+            {
+                compileExpression(*arguments[i], base + i);
+            }
+            const int reg = targetOr(target);
+            append(OpCode::CallLibrary, reg, static_cast<int>(library), base, count);
+            return reg;
+        }
+
+        // 1 si el comparador es "a < b", -1 si es "a > b" y 0 si hay que invocarlo.
+        int comparatorOrder(const Expression &comparator) const
+        {
+            if (comparator.kind != ExpressionKind::Lambda)
+            {
+                return 0;
+            }
+            const FunctionDeclaration &lambda = m_declarations[comparator.function];
+            if (lambda.parameters.size() != 2 || lambda.body->statements.size() != 1)
+            {
+                return 0;
+            }
+            const Statement &statement = *lambda.body->statements.front();
+            if (statement.kind != StatementKind::Return || !statement.expression ||
+                statement.expression->kind != ExpressionKind::Binary)
+            {
+                return 0;
+            }
+            const Expression &comparison = *statement.expression;
+            const Expression &left = *comparison.operands[0];
+            const Expression &right = *comparison.operands[1];
+            if (left.kind != ExpressionKind::Name || right.kind != ExpressionKind::Name)
+            {
+                return 0;
+            }
+            const std::string &first = lambda.parameters[0].name;
+            const std::string &second = lambda.parameters[1].name;
+            const bool direct = left.text == first && right.text == second;
+            const bool swapped = left.text == second && right.text == first;
+            if (!direct && !swapped)
+            {
+                return 0;
+            }
+            if (comparison.text == "<")
+            {
+                return direct ? 1 : -1;
+            }
+            if (comparison.text == ">")
+            {
+                return direct ? -1 : 1;
+            }
+            return 0;
+        }
+
+        int compileMemberCall(const Expression &callee, const std::vector<const Expression *> &arguments, int target)
+        {
+            const Expression &object = *callee.operands.front();
+            const int objectType = typeOf(object);
+            if (const RecordLayout *layout = recordOf(objectType))
+            {
+                const auto method = layout->methods.find(callee.text);
+                if (method == layout->methods.end())
+                {
+                    fail(QStringLiteral("la estructura %1 no tiene el método %2.").arg(quoted(layout->name), quoted(callee.text)));
+                    return targetOr(target);
+                }
+                const int reg = targetOr(target);
+                emitUserCall(method->second, compileExpression(object, -1), arguments, reg);
+                return reg;
+            }
+            MemberFunction function = memberFunctionFor(callee.text);
+            if (function == MemberFunction::Insert && arguments.size() == 2 && arguments[1]->kind == ExpressionKind::BracedList)
+            {
+                function = MemberFunction::InsertList;
+            }
+            if (function == MemberFunction::Unknown && kindOf(objectType) != TypeKind::Automatic)
+            {
+                fail(QStringLiteral("método no soportado: %1.").arg(quoted(callee.text)));
+                return targetOr(target);
+            }
+            const bool mutatesText = kindOf(objectType) == TypeKind::Text && isLvalue(object) &&
+                                     (function == MemberFunction::PushBack || function == MemberFunction::PopBack ||
+                                      function == MemberFunction::Clear || function == MemberFunction::Resize ||
+                                      function == MemberFunction::Insert || function == MemberFunction::Erase ||
+                                      function == MemberFunction::Append);
+            const bool storesArguments = function == MemberFunction::PushBack || function == MemberFunction::Insert ||
+                                         function == MemberFunction::Resize;
+            const int count = static_cast<int>(arguments.size());
+            const int base = allocateBlock(count + 1);
+            LValue place;
+            if (mutatesText)
+            {
+                place = compileLValue(object);
+                loadLValue(place, base);
+            }
+            else
+            {
+                compileExpression(object, base);
+            }
+            for (int i = 0; i < count; ++i)
+            {
+                if (storesArguments && isLvalue(*arguments[i]))
+                {
+                    append(OpCode::Copy, base + 1 + i, compileExpression(*arguments[i], -1));
+                }
+                else
+                {
+                    compileExpression(*arguments[i], base + 1 + i);
+                }
+            }
+            const int reg = targetOr(target);
+            append(OpCode::CallMember, reg, memberCall(callee.text, function, count), base);
+            if (mutatesText)
+            {
+                storeLValue(place, base);
+            }
+            return reg;
+        }
+
+        Program &m_program;
+        const std::vector<FunctionDeclaration> &m_declarations;
+        QStringList &m_errors;
+        std::unordered_map<std::string, int> m_functionIndex;
+        std::unordered_map<std::string, int> m_constantIndex;
+        CompiledFunction *m_function = nullptr;
+        const FunctionDeclaration *m_declaration = nullptr;
+        std::vector<std::vector<Local>> m_scopes;
+        std::vector<int> m_scopeMarks;
+        std::vector<LoopContext> m_loops;
+        int m_nextRegister = 0;
+        int m_record = -1;
+        int m_line = 0;
+        bool m_failed = false;
+    };
+
+    class VirtualMachine
+    {
+    public:
+        VirtualMachine(const Program &program, const std::string &input, qint64 instructionLimit, int outputLimit)
+            : m_program(program), m_input(input), m_instructionLimit(instructionLimit), m_outputLimit(outputLimit)
+        {
+        }
+
+        bool run(int &exitCode)
+        {
+            const Value result = execute(m_program.entry, nullptr, 0);
+            if (m_failed)
+            {
+                return false;
+            }
+            exitCode = isIntegral(result) ? static_cast<int>(result.integer) : 0;
+            return true;
+        }
+
+        const std::string &output() const
+        {
+            return m_output;
+        }
+
+        const QStringList &errors() const
+        {
+            return m_errors;
+        }
+
+        qint64 executedInstructions() const
+        {
+            return m_executed;
+        }
+
+    private:
+        static constexpr int MaximumDepth = 2000;
+
+        bool raise(const QString &message)
+        {
+            if (m_pendingError.isEmpty())
+            {
+                m_pendingError = message;
+            }
+            return false;
+        }
+
+        Value abort(const CompiledFunction &function, int pc)
+        {
+            if (!m_failed)
+            {
+                m_failed = true;
+                m_errors << QStringLiteral("Línea %1: %2").arg(function.lines[pc]).arg(m_pendingError);
+            }
+            return Value();
+        }
+
+        Value execute(int index, Value *arguments, int count)
+        {
+            const CompiledFunction &function = m_program.functions[index];
+            if (m_depth >= MaximumDepth)
+            {
+                raise(QStringLiteral("se superó la profundidad máxima de %1 llamadas anidadas.").arg(MaximumDepth));
+                return abort(function, 0);
+            }
+            std::vector<Value> registers(std::max(function.registerCount, count));
+            for (int i = 0; i < count; ++i)
+            {
+                registers[i] = std::move(arguments[i]);
+            }
+            ++m_depth;
+            Value result = loop(function, registers.data());
+            --m_depth;
+            return result;
+        }
+
+        Value loop(const CompiledFunction &function, Value *r)
+        {
+            const Instruction *code = function.code.data();
+            int pc = 0;
+            while (true)
+            {
+                if (++m_executed > m_instructionLimit)
+                {
+                    raise(QStringLiteral("se alcanzó el límite de %1 instrucciones; el programa podría tener un ciclo infinito.").arg(m_instructionLimit));
+                    return abort(function, pc);
+                }
+                const Instruction &in = code[pc++];
+                switch (in.op)
+                {
+                case OpCode::LoadConstant:
+                    r[in.a] = m_program.constants[in.b];
+                    break;
+                case OpCode::Move:
+                    r[in.a] = r[in.b];
+                    break;
+                case OpCode::Copy:
+                    r[in.a] = deepCopy(r[in.b]);
+                    break;
+                case OpCode::Convert:
+                {
+                    Value value = r[in.b];
+                    if (!convertValue(value, static_cast<TypeKind>(in.c), m_pendingError))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = std::move(value);
+                    break;
+                }
+                case OpCode::Add:
+                case OpCode::Subtract:
+                case OpCode::Multiply:
+                case OpCode::Divide:
+                case OpCode::Modulo:
+                {
+                    const Value &x = r[in.b];
+                    const Value &y = r[in.c];
+                    if (x.kind == ValueKind::Integer && y.kind == ValueKind::Integer && in.op <= OpCode::Multiply)
+                    {
+                        const quint64 a = static_cast<quint64>(x.integer);
+                        const quint64 b = static_cast<quint64>(y.integer);
+                        const quint64 value = in.op == OpCode::Add ? a + b : in.op == OpCode::Subtract ? a - b : a * b;
+                        r[in.a] = integerValue(static_cast<qint64>(value));
+                        break;
+                    }
+                    Value value;
+                    if (!arithmetic(in.op, x, y, value))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = std::move(value);
+                    break;
+                }
+                case OpCode::Negate:
+                    if (r[in.b].kind == ValueKind::Real)
+                    {
+                        r[in.a] = realValue(-r[in.b].real);
+                    }
+                    else if (isIntegral(r[in.b]))
+                    {
+                        r[in.a] = integerValue(static_cast<qint64>(0 - static_cast<quint64>(r[in.b].integer)));
+                    }
+                    else
+                    {
+                        raise(QStringLiteral("no se puede negar un valor de tipo %1.").arg(kindName(r[in.b].kind)));
+                        return abort(function, pc - 1);
+                    }
+                    break;
+                case OpCode::Not:
+                {
+                    bool flag = false;
+                    if (!truth(r[in.b], flag))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = booleanValue(!flag);
+                    break;
+                }
+                case OpCode::Equal:
+                case OpCode::NotEqual:
+                case OpCode::Less:
+                case OpCode::LessEqual:
+                case OpCode::Greater:
+                case OpCode::GreaterEqual:
+                {
+                    bool flag = false;
+                    if (!compare(in.op, r[in.b], r[in.c], flag))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = booleanValue(flag);
+                    break;
+                }
+                case OpCode::Increment:
+                {
+                    Value &value = r[in.a];
+                    if (value.kind == ValueKind::Integer || value.kind == ValueKind::Iterator)
+                    {
+                        value.integer += in.b;
+                    }
+                    else if (value.kind == ValueKind::Real)
+                    {
+                        value.real += in.b;
+                    }
+                    else
+                    {
+                        raise(QStringLiteral("no se puede incrementar un valor de tipo %1.").arg(kindName(value.kind)));
+                        return abort(function, pc - 1);
+                    }
+                    break;
+                }
+                case OpCode::Jump:
+                    pc = in.a;
+                    break;
+                case OpCode::JumpIfFalse:
+                case OpCode::JumpIfTrue:
+                {
+                    bool flag = false;
+                    if (!truth(r[in.a], flag))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    if (flag == (in.op == OpCode::JumpIfTrue))
+                    {
+                        pc = in.b;
+                    }
+                    break;
+                }
+                case OpCode::CompareJump:
+                {
+                    const Value &x = r[in.a];
+                    const Value &y = r[in.b];
+                    const OpCode comparison = static_cast<OpCode>(in.d & 0xff);
+                    bool flag = false;
+                    if (x.kind == ValueKind::Integer && y.kind == ValueKind::Integer)
+                    {
+                        flag = integerComparison(comparison, x.integer, y.integer);
+                    }
+                    else if (!compare(comparison, x, y, flag))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    if (flag == ((in.d & 0x100) != 0))
+                    {
+                        pc = in.c;
+                    }
+                    break;
+                }
+                case OpCode::ForEach:
+                {
+                    const Value &container = r[in.b];
+                    const qint64 position = r[in.c].integer;
+                    if (container.kind == ValueKind::List)
+                    {
+                        if (position >= static_cast<qint64>(container.aggregate->items.size()))
+                        {
+                            pc = in.d;
+                            break;
+                        }
+                        r[in.a] = container.aggregate->items[position];
+                    }
+                    else if (container.kind == ValueKind::Text)
+                    {
+                        if (position >= static_cast<qint64>(container.text.size()))
+                        {
+                            pc = in.d;
+                            break;
+                        }
+                        r[in.a] = textValue(std::string(1, container.text[position]));
+                    }
+                    else
+                    {
+                        raise(QStringLiteral("no se puede recorrer un valor de tipo %1.").arg(kindName(container.kind)));
+                        return abort(function, pc - 1);
+                    }
+                    break;
+                }
+                case OpCode::NewValue:
+                    r[in.a] = makeDefault(in.b);
+                    break;
+                case OpCode::NewList:
+                {
+                    Value list;
+                    if (!newList(in.b, in.c >= 0 ? &r[in.c] : nullptr, in.d >= 0 ? &r[in.d] : nullptr, list))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = std::move(list);
+                    break;
+                }
+                case OpCode::MakeList:
+                {
+                    Value list;
+                    if (!makeList(in.b, r + in.c, in.d, list))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = std::move(list);
+                    break;
+                }
+                case OpCode::GetIndex:
+                {
+                    Value value;
+                    if (!getIndex(r[in.b], r[in.c], value))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = std::move(value);
+                    break;
+                }
+                case OpCode::SetIndex:
+                    if (!setIndex(r[in.a], r[in.b], r[in.c]))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    break;
+                case OpCode::GetField:
+                {
+                    const int field = fieldIndex(r[in.b], in.c, in.d);
+                    if (field < 0)
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = r[in.b].aggregate->items[field];
+                    break;
+                }
+                case OpCode::SetField:
+                {
+                    const int field = fieldIndex(r[in.a], in.c, in.d);
+                    if (field < 0)
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    Value value = r[in.b];
+                    const RecordLayout &layout = m_program.records[m_program.types[r[in.a].aggregate->type].record];
+                    if (!coerce(value, layout.fieldTypes[field]))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a].aggregate->items[field] = std::move(value);
+                    break;
+                }
+                case OpCode::Dereference:
+                {
+                    Value *element = iteratorTarget(r[in.b]);
+                    if (!element)
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = *element;
+                    break;
+                }
+                case OpCode::SetDereference:
+                {
+                    Value *element = iteratorTarget(r[in.a]);
+                    if (!element)
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    Value value = r[in.b];
+                    if (!coerce(value, elementType(*r[in.a].aggregate)))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    *element = std::move(value);
+                    break;
+                }
+                case OpCode::Call:
+                {
+                    Value result = execute(in.b, r + in.c, in.d);
+                    if (m_failed)
+                    {
+                        return Value();
+                    }
+                    r[in.a] = std::move(result);
+                    break;
+                }
+                case OpCode::CallMember:
+                {
+                    Value result;
+                    if (!callMember(m_program.memberCalls[in.b], r + in.c, result))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = std::move(result);
+                    break;
+                }
+                case OpCode::CallLibrary:
+                {
+                    Value result;
+                    if (!callLibrary(static_cast<LibraryFunction>(in.b), r + in.c, in.d, result))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    r[in.a] = std::move(result);
+                    break;
+                }
+                case OpCode::Return:
+                    return std::move(r[in.a]);
+                case OpCode::ReturnVoid:
+                    return Value();
+                case OpCode::Print:
+                    if (!print(in.a >= 0 ? r[in.a] : m_program.constants[in.c]))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    break;
+                case OpCode::Read:
+                    if (!read(r[in.a], static_cast<TypeKind>(in.b)))
+                    {
+                        return abort(function, pc - 1);
+                    }
+                    break;
+                }
+            }
+        }
+
+        static bool integerComparison(OpCode op, qint64 x, qint64 y)
+        {
+            switch (op)
+            {
+            case OpCode::Equal:
+                return x == y;
+            case OpCode::NotEqual:
+                return x != y;
+            case OpCode::Less:
+                return x < y;
+            case OpCode::LessEqual:
+                return x <= y;
+            case OpCode::Greater:
+                return x > y;
+            default:
+                return x >= y;
+            }
+        }
+
+        bool arithmetic(OpCode op, const Value &x, const Value &y, Value &result)
+        {
+            if (op == OpCode::Add && x.kind == ValueKind::Text && y.kind == ValueKind::Text)
+            {
+                result = textValue(x.text + y.text);
+                return true;
+            }
+            if ((x.kind == ValueKind::Iterator || x.kind == ValueKind::List) && isIntegral(y) &&
+                (op == OpCode::Add || op == OpCode::Subtract))
+            {
+                const qint64 position = x.kind == ValueKind::Iterator ? x.integer : 0;
+                result = iteratorValue(x.aggregate, op == OpCode::Add ? position + y.integer : position - y.integer);
+                return true;
+            }
+            if (x.kind == ValueKind::Iterator && y.kind == ValueKind::Iterator && op == OpCode::Subtract)
+            {
+                result = integerValue(x.integer - y.integer);
+                return true;
+            }
+            if (!isNumeric(x) || !isNumeric(y))
+            {
+                return raise(QStringLiteral("operación no válida entre %1 y %2.").arg(kindName(x.kind), kindName(y.kind)));
+            }
+            if (isIntegral(x) && isIntegral(y))
+            {
+                const quint64 a = static_cast<quint64>(x.integer);
+                const quint64 b = static_cast<quint64>(y.integer);
+                switch (op)
+                {
+                case OpCode::Add:
+                    result = integerValue(static_cast<qint64>(a + b));
+                    return true;
+                case OpCode::Subtract:
+                    result = integerValue(static_cast<qint64>(a - b));
+                    return true;
+                case OpCode::Multiply:
+                    result = integerValue(static_cast<qint64>(a * b));
+                    return true;
+                default:
+                    if (y.integer == 0)
+                    {
+                        return raise(QStringLiteral("división entera entre cero."));
+                    }
+                    if (y.integer == -1)
+                    {
+                        result = integerValue(op == OpCode::Divide ? static_cast<qint64>(0 - a) : 0);
+                        return true;
+                    }
+                    result = integerValue(op == OpCode::Divide ? x.integer / y.integer : x.integer % y.integer);
+                    return true;
+                }
+            }
+            const double a = toReal(x);
+            const double b = toReal(y);
+            switch (op)
+            {
+            case OpCode::Add:
+                result = realValue(a + b);
+                break;
+            case OpCode::Subtract:
+                result = realValue(a - b);
+                break;
+            case OpCode::Multiply:
+                result = realValue(a * b);
+                break;
+            case OpCode::Divide:
+                result = realValue(a / b);
+                break;
+            default:
+                result = realValue(std::fmod(a, b));
+                break;
+            }
+            return true;
+        }
+
+        bool compare(OpCode op, const Value &x, const Value &y, bool &result)
+        {
+            if (isIntegral(x) && isIntegral(y))
+            {
+                result = integerComparison(op, x.integer, y.integer);
+                return true;
+            }
+            if (isNumeric(x) && isNumeric(y))
+            {
+                const double a = toReal(x);
+                const double b = toReal(y);
+                switch (op)
+                {
+                case OpCode::Equal:
+                    result = a == b;
+                    break;
+                case OpCode::NotEqual:
+                    result = a != b;
+                    break;
+                case OpCode::Less:
+                    result = a < b;
+                    break;
+                case OpCode::LessEqual:
+                    result = a <= b;
+                    break;
+                case OpCode::Greater:
+                    result = a > b;
+                    break;
+                default:
+                    result = a >= b;
+                    break;
+                }
+                return true;
+            }
+            if (x.kind == ValueKind::Text && y.kind == ValueKind::Text)
+            {
+                const int order = x.text.compare(y.text);
+                result = integerComparison(op, order, 0);
+                return true;
+            }
+            if (x.kind == ValueKind::Iterator && y.kind == ValueKind::Iterator)
+            {
+                result = integerComparison(op, x.integer, y.integer);
+                return true;
+            }
+            return raise(QStringLiteral("no se puede comparar %1 con %2.").arg(kindName(x.kind), kindName(y.kind)));
+        }
+
+        bool truth(const Value &value, bool &result)
+        {
+            if (!isNumeric(value))
+            {
+                return raise(QStringLiteral("se esperaba una condición y se obtuvo %1.").arg(kindName(value.kind)));
+            }
+            result = toReal(value) != 0.0;
+            return true;
+        }
+
+        bool lessThan(const Value &x, const Value &y)
+        {
+            bool result = false;
+            compare(OpCode::Less, x, y, result);
+            return result;
+        }
+
+        Value makeDefault(int type) const
+        {
+            const TypeKind kind = m_program.kindOf(type);
+            switch (kind)
+            {
+            case TypeKind::Integer:
+            case TypeKind::Long:
+            case TypeKind::Size:
+                return integerValue(0);
+            case TypeKind::Real:
+                return realValue(0.0);
+            case TypeKind::Boolean:
+                return booleanValue(false);
+            case TypeKind::Character:
+            case TypeKind::Text:
+                return textValue(std::string());
+            case TypeKind::List:
+            case TypeKind::Set:
+            case TypeKind::Record:
+            {
+                Value value;
+                value.kind = kind == TypeKind::List ? ValueKind::List : kind == TypeKind::Set ? ValueKind::Set : ValueKind::Record;
+                value.aggregate = std::make_shared<Aggregate>();
+                value.aggregate->type = type;
+                if (kind == TypeKind::Record)
+                {
+                    const RecordLayout &layout = m_program.records[m_program.types[type].record];
+                    for (std::size_t i = 0; i < layout.fields.size(); ++i)
+                    {
+                        const Value &initial = layout.fieldDefaults[i];
+                        value.aggregate->items.push_back(initial.kind == ValueKind::Empty ? makeDefault(layout.fieldTypes[i]) : initial);
+                    }
+                }
+                return value;
+            }
+            default:
+                return Value();
+            }
+        }
+
+        int elementType(const Aggregate &aggregate) const
+        {
+            return aggregate.type >= 0 ? m_program.types[aggregate.type].element : -1;
+        }
+
+        bool coerce(Value &value, int type)
+        {
+            const TypeKind kind = m_program.kindOf(type);
+            if (!isScalarKind(kind))
+            {
+                return true;
+            }
+            return convertValue(value, kind, m_pendingError);
+        }
+
+        static std::string setKey(const Value &value)
+        {
+            if (isIntegral(value))
+            {
+                return "n" + std::to_string(value.integer);
+            }
+            if (value.kind == ValueKind::Real)
+            {
+                if (value.real == std::floor(value.real) && std::fabs(value.real) < 9.0e18)
+                {
+                    return "n" + std::to_string(static_cast<qint64>(value.real));
+                }
+                char buffer[40];
+                std::snprintf(buffer, sizeof(buffer), "r%.17g", value.real);
+                return buffer;
+            }
+            return "s" + value.text;
+        }
+
+        bool insertIntoSet(Aggregate &set, Value value)
+        {
+            if (!coerce(value, elementType(set)))
+            {
+                return false;
+            }
+            if (value.kind != ValueKind::Text && !isNumeric(value))
+            {
+                return raise(QStringLiteral("un conjunto solo puede guardar números o texto."));
+            }
+            set.keys.insert(setKey(value));
+            return true;
+        }
+
+        bool newList(int type, const Value *size, const Value *fill, Value &result)
+        {
+            result = makeDefault(type);
+            Aggregate &list = *result.aggregate;
+            if (!size)
+            {
+                return true;
+            }
+            if (fill && (size->kind == ValueKind::Iterator || size->kind == ValueKind::List))
+            {
+                std::shared_ptr<Aggregate> source;
+                qint64 begin = 0;
+                qint64 end = 0;
+                if (!rangeOf(*size, *fill, source, begin, end))
+                {
+                    return false;
+                }
+                for (qint64 i = begin; i < end; ++i)
+                {
+                    Value item = deepCopy(source->items[i]);
+                    if (!coerce(item, elementType(list)))
+                    {
+                        return false;
+                    }
+                    list.items.push_back(std::move(item));
+                }
+                return true;
+            }
+            if (!isIntegral(*size) || size->integer < 0 || size->integer > 100000000)
+            {
+                return raise(QStringLiteral("tamaño de lista no válido."));
+            }
+            Value value = fill ? *fill : makeDefault(elementType(list));
+            if (!coerce(value, elementType(list)))
+            {
+                return false;
+            }
+            list.items.reserve(size->integer);
+            for (qint64 i = 0; i < size->integer; ++i)
+            {
+                list.items.push_back(deepCopy(value));
+            }
+            return true;
+        }
+
+        bool makeList(int type, const Value *values, int count, Value &result)
+        {
+            if (type < 0)
+            {
+                result.kind = ValueKind::List;
+                result.aggregate = std::make_shared<Aggregate>();
+                result.aggregate->items.assign(values, values + count);
+                return true;
+            }
+            result = makeDefault(type);
+            Aggregate &aggregate = *result.aggregate;
+            for (int i = 0; i < count; ++i)
+            {
+                if (result.kind == ValueKind::Set)
+                {
+                    if (!insertIntoSet(aggregate, values[i]))
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                Value item = values[i];
+                if (!coerce(item, elementType(aggregate)))
+                {
+                    return false;
+                }
+                aggregate.items.push_back(std::move(item));
+            }
+            return true;
+        }
+
+        bool checkedPosition(const Value &index, std::size_t size, qint64 &position)
+        {
+            if (!isIntegral(index))
+            {
+                return raise(QStringLiteral("el índice debe ser un número entero."));
+            }
+            position = index.integer;
+            if (position < 0 || position >= static_cast<qint64>(size))
+            {
+                return raise(QStringLiteral("índice fuera de rango: %1 (tamaño %2).").arg(position).arg(static_cast<qint64>(size)));
+            }
+            return true;
+        }
+
+        bool getIndex(const Value &container, const Value &index, Value &result)
+        {
+            qint64 position = 0;
+            if (container.kind == ValueKind::List)
+            {
+                if (!checkedPosition(index, container.aggregate->items.size(), position))
+                {
+                    return false;
+                }
+                result = container.aggregate->items[position];
+                return true;
+            }
+            if (container.kind == ValueKind::Text)
+            {
+                if (!checkedPosition(index, container.text.size(), position))
+                {
+                    return false;
+                }
+                result = textValue(std::string(1, container.text[position]));
+                return true;
+            }
+            return raise(QStringLiteral("no se puede indexar un valor de tipo %1.").arg(kindName(container.kind)));
+        }
+
+        bool setIndex(Value &container, const Value &index, Value value)
+        {
+            qint64 position = 0;
+            if (container.kind == ValueKind::List)
+            {
+                if (!checkedPosition(index, container.aggregate->items.size(), position) ||
+                    !coerce(value, elementType(*container.aggregate)))
+                {
+                    return false;
+                }
+                container.aggregate->items[position] = std::move(value);
+                return true;
+            }
+            if (container.kind == ValueKind::Text)
+            {
+                if (!checkedPosition(index, container.text.size(), position) || !convertValue(value, TypeKind::Character, m_pendingError))
+                {
+                    return false;
+                }
+                container.text[position] = value.text.empty() ? '\0' : value.text[0];
+                return true;
+            }
+            return raise(QStringLiteral("no se puede indexar un valor de tipo %1.").arg(kindName(container.kind)));
+        }
+
+        int fieldIndex(const Value &record, int field, int name)
+        {
+            if (record.kind != ValueKind::Record)
+            {
+                raise(QStringLiteral("se esperaba una estructura y se obtuvo %1.").arg(kindName(record.kind)));
+                return -1;
+            }
+            if (field >= 0)
+            {
+                return field;
+            }
+            const RecordLayout &layout = m_program.records[m_program.types[record.aggregate->type].record];
+            const auto it = layout.fieldIndex.find(m_program.constants[name].text);
+            if (it == layout.fieldIndex.end())
+            {
+                raise(QStringLiteral("la estructura %1 no tiene el campo %2.")
+                          .arg(QString::fromStdString(layout.name), QString::fromStdString(m_program.constants[name].text)));
+                return -1;
+            }
+            return it->second;
+        }
+
+        Value *iteratorTarget(const Value &iterator)
+        {
+            if (iterator.kind != ValueKind::Iterator || !iterator.aggregate ||
+                iterator.integer < 0 || iterator.integer >= static_cast<qint64>(iterator.aggregate->items.size()))
+            {
+                raise(QStringLiteral("se accedió a un iterador fuera de rango."));
+                return nullptr;
+            }
+            return &iterator.aggregate->items[iterator.integer];
+        }
+
+        bool iteratorPosition(const Value &value, std::shared_ptr<Aggregate> &target, qint64 &position)
+        {
+            if (value.kind == ValueKind::Iterator || value.kind == ValueKind::List)
+            {
+                target = value.aggregate;
+                position = value.kind == ValueKind::Iterator ? value.integer : 0;
+                return true;
+            }
+            return raise(QStringLiteral("se esperaba un iterador y se obtuvo %1.").arg(kindName(value.kind)));
+        }
+
+        bool rangeOf(const Value &first, const Value &last, std::shared_ptr<Aggregate> &target, qint64 &begin, qint64 &end)
+        {
+            std::shared_ptr<Aggregate> other;
+            if (!iteratorPosition(first, target, begin) || !iteratorPosition(last, other, end))
+            {
+                return false;
+            }
+            if (target != other || begin < 0 || begin > end || end > static_cast<qint64>(target->items.size()))
+            {
+                return raise(QStringLiteral("rango de iteradores no válido."));
+            }
+            return true;
+        }
+
+        bool callMember(const MemberCall &call, Value *arguments, Value &result)
+        {
+            Value &object = arguments[0];
+            const int count = call.argumentCount;
+            switch (object.kind)
+            {
+            case ValueKind::List:
+                return listMember(call, *object.aggregate, object, arguments + 1, count, result);
+            case ValueKind::Text:
+                return textMember(call, object.text, arguments + 1, count, result);
+            case ValueKind::Set:
+                return setMember(call, *object.aggregate, arguments + 1, count, result);
+            case ValueKind::Record:
+            {
+                const RecordLayout &layout = m_program.records[m_program.types[object.aggregate->type].record];
+                const auto method = layout.methods.find(call.name);
+                if (method != layout.methods.end())
+                {
+                    result = execute(method->second, arguments, count + 1);
+                    return !m_failed;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+            return unsupportedMember(call, object);
+        }
+
+        bool unsupportedMember(const MemberCall &call, const Value &object)
+        {
+            return raise(QStringLiteral("el método %1 no está disponible para %2.")
+                             .arg(QString::fromStdString(call.name), kindName(object.kind)));
+        }
+
+        bool listMember(const MemberCall &call, Aggregate &list, const Value &object, Value *arguments, int count, Value &result)
+        {
+            std::vector<Value> &items = list.items;
+            switch (call.function)
+            {
+            case MemberFunction::Size:
+                result = integerValue(static_cast<qint64>(items.size()));
+                return true;
+            case MemberFunction::Empty:
+                result = booleanValue(items.empty());
+                return true;
+            case MemberFunction::PushBack:
+            {
+                Value value = arguments[0];
+                if (!coerce(value, elementType(list)))
+                {
+                    return false;
+                }
+                items.push_back(std::move(value));
+                return true;
+            }
+            case MemberFunction::PopBack:
+                if (items.empty())
+                {
+                    return raise(QStringLiteral("pop_back sobre una lista vacía."));
+                }
+                items.pop_back();
+                return true;
+            case MemberFunction::Back:
+            case MemberFunction::Front:
+                if (items.empty())
+                {
+                    return raise(QStringLiteral("se pidió un elemento de una lista vacía."));
+                }
+                result = call.function == MemberFunction::Back ? items.back() : items.front();
+                return true;
+            case MemberFunction::Clear:
+                items.clear();
+                return true;
+            case MemberFunction::Reserve:
+                return true;
+            case MemberFunction::Resize:
+            {
+                if (!isIntegral(arguments[0]) || arguments[0].integer < 0 || arguments[0].integer > 100000000)
+                {
+                    return raise(QStringLiteral("tamaño de lista no válido."));
+                }
+                Value fill = count > 1 ? arguments[1] : makeDefault(elementType(list));
+                if (!coerce(fill, elementType(list)))
+                {
+                    return false;
+                }
+                const std::size_t size = static_cast<std::size_t>(arguments[0].integer);
+                while (items.size() < size)
+                {
+                    items.push_back(deepCopy(fill));
+                }
+                items.resize(size);
+                return true;
+            }
+            case MemberFunction::Begin:
+            case MemberFunction::End:
+                result = iteratorValue(object.aggregate, call.function == MemberFunction::Begin ? 0 : static_cast<qint64>(items.size()));
+                return true;
+            case MemberFunction::At:
+            {
+                qint64 position = 0;
+                if (!checkedPosition(arguments[0], items.size(), position))
+                {
+                    return false;
+                }
+                result = items[position];
+                return true;
+            }
+            case MemberFunction::Insert:
+            case MemberFunction::InsertList:
+                return insertIntoList(call, list, object, arguments, count, result);
+            case MemberFunction::Erase:
+            {
+                std::shared_ptr<Aggregate> target;
+                qint64 begin = 0;
+                qint64 end = 0;
+                if (count == 2)
+                {
+                    if (!rangeOf(arguments[0], arguments[1], target, begin, end))
+                    {
+                        return false;
+                    }
+                }
+                else if (!iteratorPosition(arguments[0], target, begin))
+                {
+                    return false;
+                }
+                else
+                {
+                    end = begin + 1;
+                }
+                if (target != object.aggregate || begin < 0 || end > static_cast<qint64>(items.size()))
+                {
+                    return raise(QStringLiteral("erase con un iterador no válido."));
+                }
+                items.erase(items.begin() + begin, items.begin() + end);
+                result = iteratorValue(object.aggregate, begin);
+                return true;
+            }
+            default:
+                return unsupportedMember(call, object);
+            }
+        }
+
+        bool insertIntoList(const MemberCall &call, Aggregate &list, const Value &object, Value *arguments, int count, Value &result)
+        {
+            std::shared_ptr<Aggregate> target;
+            qint64 position = 0;
+            if (count < 2 || !iteratorPosition(arguments[0], target, position))
+            {
+                return count < 2 ? unsupportedMember(call, object) : false;
+            }
+            if (target != object.aggregate || position < 0 || position > static_cast<qint64>(list.items.size()))
+            {
+                return raise(QStringLiteral("insert con un iterador no válido."));
+            }
+            std::vector<Value> values;
+            if (call.function == MemberFunction::InsertList)
+            {
+                values = arguments[1].aggregate->items;
+            }
+            else if (count == 3)
+            {
+                std::shared_ptr<Aggregate> source;
+                qint64 begin = 0;
+                qint64 end = 0;
+                if (!rangeOf(arguments[1], arguments[2], source, begin, end))
+                {
+                    return false;
+                }
+                for (qint64 i = begin; i < end; ++i)
+                {
+                    values.push_back(deepCopy(source->items[i]));
+                }
+            }
+            else
+            {
+                values.push_back(arguments[1]);
+            }
+            for (Value &value : values)
+            {
+                if (!coerce(value, elementType(list)))
+                {
+                    return false;
+                }
+            }
+            list.items.insert(list.items.begin() + position, values.begin(), values.end());
+            result = iteratorValue(object.aggregate, position);
+            return true;
+        }
+
+        bool textMember(const MemberCall &call, std::string &text, Value *arguments, int count, Value &result)
+        {
+            switch (call.function)
+            {
+            case MemberFunction::Size:
+                result = integerValue(static_cast<qint64>(text.size()));
+                return true;
+            case MemberFunction::Empty:
+                result = booleanValue(text.empty());
+                return true;
+            case MemberFunction::Clear:
+                text.clear();
+                return true;
+            case MemberFunction::Reserve:
+                return true;
+            case MemberFunction::PushBack:
+            case MemberFunction::Append:
+                if (arguments[0].kind != ValueKind::Text)
+                {
+                    return raise(QStringLiteral("solo se puede agregar texto a un texto."));
+                }
+                text += arguments[0].text;
+                return true;
+            case MemberFunction::PopBack:
+                if (text.empty())
+                {
+                    return raise(QStringLiteral("pop_back sobre un texto vacío."));
+                }
+                text.pop_back();
+                return true;
+            case MemberFunction::Back:
+            case MemberFunction::Front:
+                if (text.empty())
+                {
+                    return raise(QStringLiteral("se pidió un carácter de un texto vacío."));
+                }
+                result = textValue(std::string(1, call.function == MemberFunction::Back ? text.back() : text.front()));
+                return true;
+            case MemberFunction::At:
+            {
+                qint64 position = 0;
+                if (!checkedPosition(arguments[0], text.size(), position))
+                {
+                    return false;
+                }
+                result = textValue(std::string(1, text[position]));
+                return true;
+            }
+            case MemberFunction::Substring:
+            {
+                const qint64 start = count > 0 && isIntegral(arguments[0]) ? arguments[0].integer : 0;
+                if (start < 0 || start > static_cast<qint64>(text.size()))
+                {
+                    return raise(QStringLiteral("substr fuera de rango."));
+                }
+                const qint64 length = count > 1 && isIntegral(arguments[1]) ? arguments[1].integer : static_cast<qint64>(text.size());
+                result = textValue(text.substr(start, static_cast<std::size_t>(std::max<qint64>(length, 0))));
+                return true;
+            }
+            case MemberFunction::Find:
+            {
+                if (arguments[0].kind != ValueKind::Text)
+                {
+                    return raise(QStringLiteral("find sobre texto requiere un texto."));
+                }
+                const std::size_t found = text.find(arguments[0].text);
+                result = integerValue(found == std::string::npos ? -1 : static_cast<qint64>(found));
+                return true;
+            }
+            default:
+                return raise(QStringLiteral("el método %1 no está disponible para texto.").arg(QString::fromStdString(call.name)));
+            }
+        }
+
+        bool setMember(const MemberCall &call, Aggregate &set, Value *arguments, int count, Value &result)
+        {
+            switch (call.function)
+            {
+            case MemberFunction::Size:
+                result = integerValue(static_cast<qint64>(set.keys.size()));
+                return true;
+            case MemberFunction::Empty:
+                result = booleanValue(set.keys.empty());
+                return true;
+            case MemberFunction::Clear:
+                set.keys.clear();
+                return true;
+            case MemberFunction::Reserve:
+                return true;
+            case MemberFunction::Count:
+            {
+                Value key = arguments[0];
+                if (!coerce(key, elementType(set)))
+                {
+                    return false;
+                }
+                result = integerValue(set.keys.count(setKey(key)) > 0 ? 1 : 0);
+                return true;
+            }
+            case MemberFunction::Insert:
+                if (count == 2)
+                {
+                    std::shared_ptr<Aggregate> source;
+                    qint64 begin = 0;
+                    qint64 end = 0;
+                    if (!rangeOf(arguments[0], arguments[1], source, begin, end))
+                    {
+                        return false;
+                    }
+                    for (qint64 i = begin; i < end; ++i)
+                    {
+                        if (!insertIntoSet(set, source->items[i]))
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+                return insertIntoSet(set, arguments[0]);
+            case MemberFunction::Erase:
+            {
+                Value key = arguments[0];
+                if (!coerce(key, elementType(set)))
+                {
+                    return false;
+                }
+                result = integerValue(static_cast<qint64>(set.keys.erase(setKey(key))));
+                return true;
+            }
+            default:
+                return raise(QStringLiteral("el método %1 no está disponible para conjuntos.").arg(QString::fromStdString(call.name)));
+            }
+        }
+
+        bool callLibrary(LibraryFunction function, Value *arguments, int count, Value &result)
+        {
+            std::shared_ptr<Aggregate> target;
+            qint64 begin = 0;
+            qint64 end = 0;
+            switch (function)
+            {
+            case LibraryFunction::Sort:
+            case LibraryFunction::SortDescending:
+            case LibraryFunction::Reverse:
+            {
+                if (count < 2 || !rangeOf(arguments[0], arguments[1], target, begin, end))
+                {
+                    return count < 2 ? raise(QStringLiteral("se esperaba un rango de iteradores.")) : false;
+                }
+                const auto first = target->items.begin() + begin;
+                const auto last = target->items.begin() + end;
+                if (function == LibraryFunction::Reverse)
+                {
+                    std::reverse(first, last);
+                    return true;
+                }
+                if (count > 2 && arguments[2].kind == ValueKind::Callable)
+                {
+                    const int comparator = static_cast<int>(arguments[2].integer);
+                    std::stable_sort(first, last, [this, comparator](const Value &x, const Value &y) {
+                        if (m_failed)
+                        {
+                            return false;
+                        }
+                        Value pair[2] = {x, y};
+                        bool before = false;
+                        truth(execute(comparator, pair, 2), before);
+                        return before;
+                    });
+                    return !m_failed && m_pendingError.isEmpty();
+                }
+                if (function == LibraryFunction::SortDescending)
+                {
+                    std::stable_sort(first, last, [this](const Value &x, const Value &y) { return lessThan(y, x); });
+                }
+                else
+                {
+                    std::stable_sort(first, last, [this](const Value &x, const Value &y) { return lessThan(x, y); });
+                }
+                return m_pendingError.isEmpty();
+            }
+            case LibraryFunction::Find:
+            case LibraryFunction::Count:
+            case LibraryFunction::LowerBound:
+            case LibraryFunction::UpperBound:
+            case LibraryFunction::BinarySearch:
+            {
+                if (count < 3 || !rangeOf(arguments[0], arguments[1], target, begin, end))
+                {
+                    return count < 3 ? raise(QStringLiteral("se esperaba un rango y un valor.")) : false;
+                }
+                return searchRange(function, target, begin, end, arguments[2], result);
+            }
+            case LibraryFunction::Accumulate:
+            {
+                if (count < 3 || !rangeOf(arguments[0], arguments[1], target, begin, end))
+                {
+                    return count < 3 ? raise(QStringLiteral("accumulate necesita un rango y un valor inicial.")) : false;
+                }
+                result = arguments[2];
+                for (qint64 i = begin; i < end; ++i)
+                {
+                    Value sum;
+                    if (!arithmetic(OpCode::Add, result, target->items[i], sum))
+                    {
+                        return false;
+                    }
+                    result = std::move(sum);
+                }
+                return true;
+            }
+            case LibraryFunction::Max:
+            case LibraryFunction::Min:
+            {
+                if (count < 2)
+                {
+                    return raise(QStringLiteral("max y min necesitan dos valores."));
+                }
+                const bool second = function == LibraryFunction::Max ? lessThan(arguments[0], arguments[1])
+                                                                      : lessThan(arguments[1], arguments[0]);
+                result = second ? arguments[1] : arguments[0];
+                return m_pendingError.isEmpty();
+            }
+            case LibraryFunction::ToString:
+                if (isIntegral(arguments[0]))
+                {
+                    result = textValue(std::to_string(arguments[0].integer));
+                    return true;
+                }
+                if (arguments[0].kind == ValueKind::Real)
+                {
+                    result = textValue(std::to_string(arguments[0].real));
+                    return true;
+                }
+                return raise(QStringLiteral("to_string necesita un número."));
+            default:
+                return mathFunction(function, arguments, count, result);
+            }
+        }
+
+        bool searchRange(LibraryFunction function, const std::shared_ptr<Aggregate> &target, qint64 begin, qint64 end,
+                         const Value &value, Value &result)
+        {
+            const std::vector<Value> &items = target->items;
+            bool equal = false;
+            switch (function)
+            {
+            case LibraryFunction::Find:
+                for (qint64 i = begin; i < end; ++i)
+                {
+                    if (!compare(OpCode::Equal, items[i], value, equal))
+                    {
+                        return false;
+                    }
+                    if (equal)
+                    {
+                        result = iteratorValue(target, i);
+                        return true;
+                    }
+                }
+                result = iteratorValue(target, end);
+                return true;
+            case LibraryFunction::Count:
+            {
+                qint64 found = 0;
+                for (qint64 i = begin; i < end; ++i)
+                {
+                    if (!compare(OpCode::Equal, items[i], value, equal))
+                    {
+                        return false;
+                    }
+                    found += equal ? 1 : 0;
+                }
+                result = integerValue(found);
+                return true;
+            }
+            default:
+                break;
+            }
+            const auto first = items.begin() + begin;
+            const auto last = items.begin() + end;
+            const auto less = [this](const Value &x, const Value &y) { return lessThan(x, y); };
+            const auto position = function == LibraryFunction::UpperBound ? std::upper_bound(first, last, value, less)
+                                                                           : std::lower_bound(first, last, value, less);
+            if (!m_pendingError.isEmpty())
+            {
+                return false;
+            }
+            if (function == LibraryFunction::BinarySearch)
+            {
+                result = booleanValue(position != last && !lessThan(value, *position));
+                return m_pendingError.isEmpty();
+            }
+            result = iteratorValue(target, static_cast<qint64>(position - items.begin()));
+            return true;
+        }
+
+        bool mathFunction(LibraryFunction function, Value *arguments, int count, Value &result)
+        {
+            if (count < 1 || !isNumeric(arguments[0]) || (function == LibraryFunction::Pow && (count < 2 || !isNumeric(arguments[1]))))
+            {
+                return raise(QStringLiteral("la función matemática necesita argumentos numéricos."));
+            }
+            const double x = toReal(arguments[0]);
+            switch (function)
+            {
+            case LibraryFunction::Abs:
+                result = isIntegral(arguments[0]) ? integerValue(arguments[0].integer < 0 ? -arguments[0].integer : arguments[0].integer)
+                                                  : realValue(std::fabs(x));
+                return true;
+            case LibraryFunction::Sqrt:
+                result = realValue(std::sqrt(x));
+                return true;
+            case LibraryFunction::Pow:
+                result = realValue(std::pow(x, toReal(arguments[1])));
+                return true;
+            case LibraryFunction::Floor:
+                result = realValue(std::floor(x));
+                return true;
+            case LibraryFunction::Ceil:
+                result = realValue(std::ceil(x));
+                return true;
+            case LibraryFunction::Round:
+                result = realValue(std::round(x));
+                return true;
+            case LibraryFunction::IsFinite:
+                result = booleanValue(std::isfinite(x));
+                return true;
+            default:
+                return raise(QStringLiteral("función de biblioteca no soportada."));
+            }
+        }
+
+        bool print(const Value &value)
+        {
+            switch (value.kind)
+            {
+            case ValueKind::Integer:
+                m_output += std::to_string(value.integer);
+                break;
+            case ValueKind::Boolean:
+                m_output += value.integer ? '1' : '0';
+                break;
+            case ValueKind::Real:
+            {
+                char buffer[40];
+                std::snprintf(buffer, sizeof(buffer), "%g", value.real);
+                m_output += buffer;
+                break;
+            }
+            case ValueKind::Text:
+                m_output += value.text;
+                break;
+            default:
+                return raise(QStringLiteral("no se puede mostrar un valor de tipo %1.").arg(kindName(value.kind)));
+            }
+            if (static_cast<qint64>(m_output.size()) > m_outputLimit)
+            {
+                return raise(QStringLiteral("la salida superó el límite de %1 bytes.").arg(m_outputLimit));
+            }
+            return true;
+        }
+
+        bool read(Value &target, TypeKind kind)
+        {
+            if (m_inputFailed)
+            {
+                return true;
+            }
+            while (m_inputPosition < m_input.size() && std::isspace(static_cast<unsigned char>(m_input[m_inputPosition])))
+            {
+                ++m_inputPosition;
+            }
+            const char *start = m_input.c_str() + m_inputPosition;
+            char *stop = nullptr;
+            switch (kind)
+            {
+            case TypeKind::Text:
+            case TypeKind::Character:
+            {
+                std::size_t length = 0;
+                while (m_inputPosition + length < m_input.size() &&
+                       !std::isspace(static_cast<unsigned char>(m_input[m_inputPosition + length])) &&
+                       (kind == TypeKind::Text || length == 0))
+                {
+                    ++length;
+                }
+                if (length == 0)
+                {
+                    m_inputFailed = true;
+                    return true;
+                }
+                target = textValue(m_input.substr(m_inputPosition, length));
+                m_inputPosition += length;
+                return true;
+            }
+            case TypeKind::Real:
+            {
+                const double number = std::strtod(start, &stop);
+                m_inputFailed = stop == start;
+                target = realValue(m_inputFailed ? 0.0 : number);
+                break;
+            }
+            default:
+            {
+                const long long number = std::strtoll(start, &stop, 10);
+                m_inputFailed = stop == start || (kind == TypeKind::Integer &&
+                                                  (number < std::numeric_limits<int>::min() || number > std::numeric_limits<int>::max()));
+                if (kind == TypeKind::Boolean)
+                {
+                    m_inputFailed = m_inputFailed || (number != 0 && number != 1);
+                    target = booleanValue(!m_inputFailed && number == 1);
+                }
+                else
+                {
+                    target = integerValue(m_inputFailed && stop == start ? 0 : number);
+                }
+                if (m_inputFailed && stop != start && kind == TypeKind::Integer)
+                {
+                    target = integerValue(number < 0 ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max());
+                }
+                break;
+            }
+            }
+            m_inputPosition += static_cast<std::size_t>(stop - start);
+            return true;
+        }
+
+        const Program &m_program;
+        std::string m_input;
+        std::size_t m_inputPosition = 0;
+        bool m_inputFailed = false;
+        std::string m_output;
+        qint64 m_instructionLimit;
+        int m_outputLimit;
+        qint64 m_executed = 0;
+        int m_depth = 0;
+        bool m_failed = false;
+        QString m_pendingError;
+        QStringList m_errors;
+    };
+}
+
+Interpreter::Output Interpreter::run(const Interpreter::Input &input)
+{
+    Output output;
+    Lexer lexer(input.code.toStdString());
+    const std::vector<Token> tokens = lexer.tokenize(output.errors);
+    Program program;
+    std::vector<FunctionDeclaration> functions;
+    if (output.errors.isEmpty())
+    {
+        SourceParser parser(tokens, program, functions, output.errors);
+        parser.parse();
+    }
+    if (output.errors.isEmpty())
+    {
+        BytecodeCompiler compiler(program, functions, output.errors);
+        compiler.compile();
+    }
+    if (!output.errors.isEmpty())
+    {
+        output.success = false;
+        return output;
+    }
+
+    for (const CompiledFunction &function : program.functions)
+    {
+        output.bytecodeSize += static_cast<int>(function.code.size());
+    }
+
+    VirtualMachine machine(program, input.standardInput.toStdString(), input.instructionLimit, input.outputLimit);
+    output.success = machine.run(output.exitCode);
+    output.standardOutput = QString::fromStdString(machine.output());
+    output.errors = machine.errors();
+    output.executedInstructions = machine.executedInstructions();
+    return output;
+}
@@ -0,0 +1,29 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+class Interpreter {
+public:
+    struct Input {
+        QString code;
+        QString standardInput;
+        qint64 instructionLimit = 50000000;
+        int outputLimit = 4 * 1024 * 1024;
+    };
+
+    struct Output {
+        QString standardOutput;
+        QStringList errors;
+        int exitCode = 0;
+        qint64 executedInstructions = 0;
+        int bytecodeSize = 0;
+        bool success = true;
+    };
+
+    static Output run(const Input &input);
+};
+
+#endif
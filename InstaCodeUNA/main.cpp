@@ -1,10 +1,24 @@
 #include <QApplication>
+#include <QCoreApplication>
 #include <QFile>
 #include <QTextStream>
+#include "batch.h"
+#include "runner.h"
 #include "window.h"
 
 int main(int argc, char *argv[])
 {
+    if (Runner::isMeasurementRequest(argc, argv))
+    {
+        return Runner::measure(argc, argv);
+    }
+
+    if (Batch::isRequested(argc, argv))
+    {
+        QCoreApplication app(argc, argv);
+        return Batch::run(app.arguments());
+    }
+
     QApplication app(argc, argv);
 
     QFile styleFile(":/light.qss");
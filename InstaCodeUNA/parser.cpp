@@ -1,6 +1,7 @@
 #include "parser.h"
 
 #include <QChar>
+#include <QHash>
 #include <QMap>
 #include <QPair>
 #include <QRegularExpression>
@@ -10,6 +11,13 @@
 #include <QVector>
 #include <QtGlobal>
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+
+#include "vocabulary.h"
 
 namespace
 {
@@ -142,199 +150,3615 @@ namespace
         return text.split(QRegularExpression("[\\r\\n]+"), Qt::SkipEmptyParts);
     }
 
-    enum class BlockType
+    // Cada línea generada guarda la línea de instrucciones (base 0) que la produjo. Texto y origen
+    // solo cambian juntos: mover una línea es takeAt seguido de insert.
+    class CodeLines
     {
-        Generic,
-        If,
-        Loop
+    public:
+        struct Line
+        {
+            QString text;
+            int origin = -1;
+        };
+
+        int size() const
+        {
+            return m_lines.size();
+        }
+
+        bool isEmpty() const
+        {
+            return m_lines.isEmpty();
+        }
+
+        const QString &operator[](int index) const
+        {
+            return m_lines[index];
+        }
+
+        const QString &last() const
+        {
+            return m_lines.last();
+        }
+
+        const QStringList &texts() const
+        {
+            return m_lines;
+        }
+
+        QStringList mid(int position, int length = -1) const
+        {
+            return m_lines.mid(position, length);
+        }
+
+        QString join(QChar separator) const
+        {
+            return m_lines.join(separator);
+        }
+
+        int origin(int index) const
+        {
+            return index >= 0 && index < m_origins.size() ? m_origins[index] : -1;
+        }
+
+        const QVector<int> &origins() const
+        {
+            return m_origins;
+        }
+
+        void replace(int index, const QString &text)
+        {
+            m_lines[index] = text;
+        }
+
+        void append(const QString &line, int origin)
+        {
+            m_lines.append(line);
+            m_origins.append(origin);
+        }
+
+        void appendLines(const QStringList &lines, int origin)
+        {
+            for (const QString &line : lines)
+            {
+                append(line, origin);
+            }
+        }
+
+        void appendLines(const CodeLines &lines)
+        {
+            for (int i = 0; i < lines.size(); ++i)
+            {
+                append(lines[i], lines.origin(i));
+            }
+        }
+
+        void insert(int index, const QString &line, int origin)
+        {
+            m_lines.insert(index, line);
+            m_origins.insert(index, origin);
+        }
+
+        void insert(int index, const Line &line)
+        {
+            insert(index, line.text, line.origin);
+        }
+
+        Line takeAt(int index)
+        {
+            Line line{m_lines.takeAt(index), m_origins[index]};
+            m_origins.removeAt(index);
+            return line;
+        }
+
+        void removeAt(int index)
+        {
+            m_lines.removeAt(index);
+            m_origins.removeAt(index);
+        }
+
+        void removeLast()
+        {
+            removeAt(size() - 1);
+        }
+
+    private:
+        QStringList m_lines;
+        QVector<int> m_origins;
     };
 
-    struct BlockState
+    struct ExpressionNode;
+    using ExpressionPtr = std::shared_ptr<ExpressionNode>;
+
+    struct ExpressionNode
     {
-        BlockType type = BlockType::Generic;
-        bool autoClose = false;
-        bool hasElse = false;
-        bool hasElseIf = false;
-        int indent = 0;
+        enum class Kind
+        {
+            Number,
+            Identifier,
+            Unary,
+            Binary,
+            Index,
+            Conversion
+        };
+
+        Kind kind = Kind::Number;
+        QString text;
+        bool floating = false;
+        ExpressionPtr left;
+        ExpressionPtr right;
     };
 
-    struct VariableInfo
+    int binaryPrecedence(const QString &op)
     {
-        QString type;
-        bool fromInstruction = false;
-    };
+        const int *precedence = Vocabulary::binaryPrecedences.find(op);
+        return precedence ? *precedence : 0;
+    }
 
-    struct CollectionInfo
+    const int UnaryPrecedence = 7;
+
+    enum class ValueType
     {
-        QString type;
-        QString elementType;
-        QString alias;
-        int size = 0;
-        bool fixedSize = false;
-        bool isCArray = false;
+        Unknown,
+        Bool,
+        Int,
+        Double,
+        String
     };
 
-    struct FunctionInfo
+    ValueType valueTypeOf(const QString &cppType)
     {
-        QString name;
-        QString returnType;
-        QStringList parameterTypes;
-        QStringList parameterNames;
-        QStringList body;
-    };
+        if (cppType == QStringLiteral("int") || cppType == QStringLiteral("long long") || cppType == QStringLiteral("std::size_t"))
+        {
+            return ValueType::Int;
+        }
+        if (cppType == QStringLiteral("double") || cppType == QStringLiteral("float"))
+        {
+            return ValueType::Double;
+        }
+        if (cppType == QStringLiteral("bool"))
+        {
+            return ValueType::Bool;
+        }
+        return cppType == QStringLiteral("std::string") ? ValueType::String : ValueType::Unknown;
+    }
 
-    struct StructInfo
+    QString cppTypeOf(ValueType type)
     {
-        QString name;
-        QStringList fieldNames;
-        QStringList fieldTypes;
+        switch (type)
+        {
+        case ValueType::Bool:
+            return QStringLiteral("bool");
+        case ValueType::Double:
+            return QStringLiteral("double");
+        case ValueType::String:
+            return QStringLiteral("std::string");
+        default:
+            return QStringLiteral("int");
+        }
+    }
+
+    int expressionPrecedence(const ExpressionPtr &node)
+    {
+        switch (node->kind)
+        {
+        case ExpressionNode::Kind::Binary:
+            return binaryPrecedence(node->text);
+        case ExpressionNode::Kind::Unary:
+            return UnaryPrecedence;
+        default:
+            return UnaryPrecedence + 1;
+        }
+    }
+
+    QString printExpression(const ExpressionPtr &node)
+    {
+        switch (node->kind)
+        {
+        case ExpressionNode::Kind::Number:
+        case ExpressionNode::Kind::Identifier:
+            return node->text;
+        case ExpressionNode::Kind::Unary:
+        {
+            QString operand = printExpression(node->left);
+            if (expressionPrecedence(node->left) < UnaryPrecedence || operand.startsWith(node->text))
+            {
+                operand = QStringLiteral("(%1)").arg(operand);
+            }
+            return node->text + operand;
+        }
+        case ExpressionNode::Kind::Binary:
+        {
+            int precedence = expressionPrecedence(node);
+            QString left = printExpression(node->left);
+            QString right = printExpression(node->right);
+            if (expressionPrecedence(node->left) < precedence)
+            {
+                left = QStringLiteral("(%1)").arg(left);
+            }
+            if (expressionPrecedence(node->right) <= precedence)
+            {
+                right = QStringLiteral("(%1)").arg(right);
+            }
+            return QStringLiteral("%1 %2 %3").arg(left, node->text, right);
+        }
+        case ExpressionNode::Kind::Index:
+            return QStringLiteral("%1[%2]").arg(printExpression(node->left), printExpression(node->right));
+        case ExpressionNode::Kind::Conversion:
+            return QStringLiteral("static_cast<%1>(%2)").arg(node->text, printExpression(node->left));
+        }
+        return QString();
+    }
+
+    QString numberLiteral(double value, bool floating)
+    {
+        if (!floating)
+        {
+            return QString::number(static_cast<long long>(value));
+        }
+        QString text = QString::number(value, 'g', 15);
+        if (text.toDouble() != value)
+        {
+            text = QString::number(value, 'g', 17);
+        }
+        if (!text.contains('.') && !text.contains('e'))
+        {
+            text.append(QStringLiteral(".0"));
+        }
+        return text;
+    }
+
+    ExpressionPtr numberNode(double value, bool floating)
+    {
+        auto node = std::make_shared<ExpressionNode>();
+        node->kind = ExpressionNode::Kind::Number;
+        node->floating = floating;
+        node->text = numberLiteral(value, floating);
+        return node;
+    }
+
+    // Una cadena vacía indica que la frase no se pudo resolver.
+    struct OperandResolver
+    {
+        std::function<QString(const QString &)> operand;
+        std::function<QString(const QString &)> collection;
+        std::function<QString(const QString &)> index;
     };
 
-    class InstructionParser
+    class SpanishExpressionParser
     {
     public:
-        explicit InstructionParser(const Parser::Input &input)
-            : m_input(input)
+        static ExpressionPtr parse(const QString &text, const OperandResolver &resolver)
         {
-            ensureInclude("iostream");
-            m_dataFileName = input.dataFileName.trimmed();
-            if (m_dataFileName.isEmpty())
+            return parse(text, resolver, false);
+        }
+
+        static ExpressionPtr parseGenerated(const QString &text)
+        {
+            static const std::function<QString(const QString &)> sameName = [](const QString &name)
             {
-                m_dataFileName = QStringLiteral("datos.txt");
+                return name.contains(' ') ? QString() : name;
+            };
+            static const OperandResolver resolver{sameName, sameName, sameName};
+            return parse(text, resolver, true);
+        }
+
+    private:
+        static ExpressionPtr parse(const QString &text, const OperandResolver &resolver, bool generated)
+        {
+            SpanishExpressionParser parser(resolver, generated);
+            if (!parser.tokenize(text))
+            {
+                return nullptr;
+            }
+            ExpressionPtr root = parser.parseExpression(0);
+            if (!root || parser.m_position != parser.m_tokens.size())
+            {
+                return nullptr;
+            }
+            return root;
+        }
+
+        struct Token
+        {
+            enum class Kind
+            {
+                Number,
+                Text,
+                Word,
+                Operator,
+                Punctuation
+            };
+
+            Kind kind = Kind::Word;
+            QString text;
+        };
+
+        SpanishExpressionParser(const OperandResolver &resolver, bool generated)
+            : m_resolver(resolver),
+              m_generated(generated)
+        {
+        }
+
+        bool tokenize(const QString &text)
+        {
+            int i = 0;
+            while (i < text.size())
+            {
+                const QChar ch = text.at(i);
+                if (ch.isSpace())
+                {
+                    ++i;
+                    continue;
+                }
+                const int start = i;
+                if (ch.isDigit())
+                {
+                    while (i < text.size() && text.at(i).isDigit())
+                    {
+                        ++i;
+                    }
+                    if (i + 1 < text.size() && (text.at(i) == '.' || (text.at(i) == ',' && !m_generated)) && text.at(i + 1).isDigit())
+                    {
+                        i += 2;
+                        while (i < text.size() && text.at(i).isDigit())
+                        {
+                            ++i;
+                        }
+                    }
+                    if (m_generated && i + 1 < text.size() && text.at(i) == 'e')
+                    {
+                        const int digits = text.at(i + 1) == '+' || text.at(i + 1) == '-' ? i + 2 : i + 1;
+                        if (digits < text.size() && text.at(digits).isDigit())
+                        {
+                            i = digits;
+                            while (i < text.size() && text.at(i).isDigit())
+                            {
+                                ++i;
+                            }
+                        }
+                    }
+                    m_tokens.append({Token::Kind::Number, text.mid(start, i - start)});
+                }
+                else if (ch.isLetter() || ch == '_')
+                {
+                    while (i < text.size() && (text.at(i).isLetterOrNumber() || text.at(i) == '_'))
+                    {
+                        ++i;
+                    }
+                    const QString word = text.mid(start, i - start);
+                    if (m_generated || word != QStringLiteral("es"))
+                    {
+                        m_tokens.append({Token::Kind::Word, word});
+                    }
+                }
+                else if (ch == '"' && !m_generated)
+                {
+                    const int end = text.indexOf('"', i + 1);
+                    if (end < 0)
+                    {
+                        return false;
+                    }
+                    m_tokens.append({Token::Kind::Text, text.mid(i + 1, end - i - 1)});
+                    i = end + 1;
+                }
+                else
+                {
+                    const QString pair = text.mid(i, 2);
+                    if (pair == QStringLiteral(">=") || pair == QStringLiteral("<=") || pair == QStringLiteral("==") ||
+                        pair == QStringLiteral("!=") || pair == QStringLiteral("&&") || pair == QStringLiteral("||"))
+                    {
+                        m_tokens.append({Token::Kind::Operator, pair});
+                        i += 2;
+                    }
+                    else if (QStringLiteral("+-*/%<>!").contains(ch))
+                    {
+                        m_tokens.append({Token::Kind::Operator, QString(ch)});
+                        ++i;
+                    }
+                    else if (ch == '=' && !m_generated)
+                    {
+                        m_tokens.append({Token::Kind::Operator, QStringLiteral("==")});
+                        ++i;
+                    }
+                    else if (QStringLiteral("()[],").contains(ch))
+                    {
+                        m_tokens.append({Token::Kind::Punctuation, QString(ch)});
+                        ++i;
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                }
+            }
+            if (!m_generated)
+            {
+                mergePhrases();
+            }
+            return !m_tokens.isEmpty();
+        }
+
+        void mergePhrases()
+        {
+            QVector<Token> merged;
+            merged.reserve(m_tokens.size());
+            for (int i = 0; i < m_tokens.size(); ++i)
+            {
+                const Token &token = m_tokens[i];
+                const int *start = token.kind == Token::Kind::Word ? Vocabulary::operatorPhraseStarts.find(token.text) : nullptr;
+                if (!start)
+                {
+                    merged.append(token);
+                    continue;
+                }
+                const Vocabulary::OperatorPhrase *match = nullptr;
+                int length = 0;
+                for (int p = *start; p < int(std::size(Vocabulary::operatorPhrases)) && !match; ++p)
+                {
+                    const Vocabulary::OperatorPhrase &phrase = Vocabulary::operatorPhrases[p];
+                    if (!Vocabulary::equals(token.text, 0, token.text.size(), Vocabulary::firstWord(phrase.words)))
+                    {
+                        break;
+                    }
+                    length = phraseLength(phrase.words, i);
+                    if (length > 0)
+                    {
+                        match = &phrase;
+                    }
+                }
+                if (!match)
+                {
+                    merged.append(token);
+                    continue;
+                }
+                merged.append({Token::Kind::Operator, QString::fromLatin1(match->op)});
+                i += length - 1;
+            }
+            m_tokens = merged;
+        }
+
+        int phraseLength(std::string_view words, int first) const
+        {
+            int length = 0;
+            std::size_t begin = 0;
+            while (begin <= words.size())
+            {
+                std::size_t end = words.find(' ', begin);
+                if (end == std::string_view::npos)
+                {
+                    end = words.size();
+                }
+                const int index = first + length;
+                if (index >= m_tokens.size() || m_tokens[index].kind != Token::Kind::Word ||
+                    !Vocabulary::equals(m_tokens[index].text, 0, m_tokens[index].text.size(), words.substr(begin, end - begin)))
+                {
+                    return 0;
+                }
+                ++length;
+                begin = end + 1;
+            }
+            return length;
+        }
+
+        bool at(Token::Kind kind, const QString &text = QString()) const
+        {
+            return m_position < m_tokens.size() && m_tokens[m_position].kind == kind &&
+                   (text.isEmpty() || m_tokens[m_position].text == text);
+        }
+
+        static ExpressionPtr node(ExpressionNode::Kind kind, const QString &text, ExpressionPtr left = nullptr, ExpressionPtr right = nullptr)
+        {
+            auto result = std::make_shared<ExpressionNode>();
+            result->kind = kind;
+            result->text = text;
+            result->left = left;
+            result->right = right;
+            return result;
+        }
+
+        ExpressionPtr parseExpression(int minimumPrecedence)
+        {
+            ExpressionPtr left = parsePrefix();
+            while (left && at(Token::Kind::Operator))
+            {
+                const QString op = m_tokens[m_position].text;
+                const int precedence = binaryPrecedence(op);
+                if (precedence <= minimumPrecedence)
+                {
+                    break;
+                }
+                ++m_position;
+                ExpressionPtr right = parseExpression(precedence);
+                if (!right)
+                {
+                    return nullptr;
+                }
+                left = node(ExpressionNode::Kind::Binary, op, left, right);
+            }
+            return left;
+        }
+
+        ExpressionPtr parsePrefix()
+        {
+            if (m_position >= m_tokens.size())
+            {
+                return nullptr;
+            }
+            const Token token = m_tokens[m_position++];
+            switch (token.kind)
+            {
+            case Token::Kind::Operator:
+            {
+                if (token.text != QStringLiteral("-") && token.text != QStringLiteral("!"))
+                {
+                    return nullptr;
+                }
+                ExpressionPtr operand = parseExpression(token.text == QStringLiteral("!") ? binaryPrecedence(QStringLiteral("&&"))
+                                                                                          : binaryPrecedence(QStringLiteral("*")));
+                return operand ? node(ExpressionNode::Kind::Unary, token.text, operand) : nullptr;
+            }
+            case Token::Kind::Number:
+            {
+                ExpressionPtr number = node(ExpressionNode::Kind::Number, ensureNumberString(token.text, token.text.contains(',') || token.text.contains('.')));
+                number->floating = number->text.contains('.') || number->text.contains('e');
+                return number;
+            }
+            case Token::Kind::Text:
+                return node(ExpressionNode::Kind::Identifier, quoted(token.text));
+            case Token::Kind::Punctuation:
+            {
+                if (token.text != QStringLiteral("("))
+                {
+                    return nullptr;
+                }
+                ExpressionPtr inner = parseExpression(0);
+                if (!inner || !at(Token::Kind::Punctuation, QStringLiteral(")")))
+                {
+                    return nullptr;
+                }
+                ++m_position;
+                return inner;
+            }
+            case Token::Kind::Word:
+                break;
+            }
+
+            QStringList words{token.text};
+            while (at(Token::Kind::Word))
+            {
+                words << m_tokens[m_position++].text;
+            }
+            const QString phrase = words.join(' ');
+            if (words.size() == 1 && (phrase == QStringLiteral("verdadero") || phrase == QStringLiteral("true")))
+            {
+                return node(ExpressionNode::Kind::Identifier, QStringLiteral("true"));
+            }
+            if (words.size() == 1 && (phrase == QStringLiteral("falso") || phrase == QStringLiteral("false")))
+            {
+                return node(ExpressionNode::Kind::Identifier, QStringLiteral("false"));
+            }
+            if (at(Token::Kind::Punctuation, QStringLiteral("(")))
+            {
+                return parseCall(phrase);
+            }
+            if (at(Token::Kind::Punctuation, QStringLiteral("[")))
+            {
+                return parseIndex(phrase);
+            }
+            const QString operand = m_resolver.operand(phrase);
+            return operand.isEmpty() ? nullptr : node(ExpressionNode::Kind::Identifier, operand);
+        }
+
+        ExpressionPtr parseCall(const QString &name)
+        {
+            ++m_position;
+            QStringList arguments;
+            while (!at(Token::Kind::Punctuation, QStringLiteral(")")))
+            {
+                if (!arguments.isEmpty())
+                {
+                    if (!at(Token::Kind::Punctuation, QStringLiteral(",")))
+                    {
+                        return nullptr;
+                    }
+                    ++m_position;
+                }
+                ExpressionPtr argument = parseExpression(0);
+                if (!argument)
+                {
+                    return nullptr;
+                }
+                arguments << printExpression(argument);
+            }
+            ++m_position;
+            return node(ExpressionNode::Kind::Identifier,
+                        QStringLiteral("%1(%2)").arg(sanitizedIdentifier(name), arguments.join(QStringLiteral(", "))));
+        }
+
+        ExpressionPtr parseIndex(const QString &name)
+        {
+            ++m_position;
+            ExpressionPtr index;
+            if (at(Token::Kind::Word) && m_position + 1 < m_tokens.size() &&
+                m_tokens[m_position + 1].kind == Token::Kind::Punctuation && m_tokens[m_position + 1].text == QStringLiteral("]"))
+            {
+                const QString resolved = m_resolver.index(m_tokens[m_position++].text);
+                index = resolved.isEmpty() ? nullptr : node(ExpressionNode::Kind::Identifier, resolved);
+            }
+            else
+            {
+                index = parseExpression(0);
+            }
+            if (!index || !at(Token::Kind::Punctuation, QStringLiteral("]")))
+            {
+                return nullptr;
+            }
+            ++m_position;
+            const QString collection = m_resolver.collection(name);
+            return collection.isEmpty() ? nullptr
+                                        : node(ExpressionNode::Kind::Index, QString(), node(ExpressionNode::Kind::Identifier, collection), index);
+        }
+
+        const OperandResolver &m_resolver;
+        bool m_generated = false;
+        QVector<Token> m_tokens;
+        int m_position = 0;
+    };
+
+    bool isBooleanLiteral(const ExpressionPtr &node)
+    {
+        return node->kind == ExpressionNode::Kind::Identifier &&
+               (node->text == QStringLiteral("true") || node->text == QStringLiteral("false"));
+    }
+
+    ExpressionPtr booleanNode(bool value)
+    {
+        auto node = std::make_shared<ExpressionNode>();
+        node->kind = ExpressionNode::Kind::Identifier;
+        node->text = value ? QStringLiteral("true") : QStringLiteral("false");
+        return node;
+    }
+
+    bool isBooleanExpression(const ExpressionPtr &node)
+    {
+        return isBooleanLiteral(node) || (node->kind == ExpressionNode::Kind::Unary && node->text == QStringLiteral("!")) ||
+               (node->kind == ExpressionNode::Kind::Binary && binaryPrecedence(node->text) <= binaryPrecedence(QStringLiteral("<")));
+    }
+
+    // Un operando solo reemplaza a un && o || si ya es bool: "n && true" vale 1, no n.
+    ExpressionPtr foldLogical(const ExpressionPtr &node)
+    {
+        const ExpressionPtr &left = node->left;
+        const ExpressionPtr &right = node->right;
+        const QString &op = node->text;
+        if (node->kind == ExpressionNode::Kind::Unary)
+        {
+            return op == QStringLiteral("!") && isBooleanLiteral(left) ? booleanNode(left->text == QStringLiteral("false")) : nullptr;
+        }
+        if (node->kind != ExpressionNode::Kind::Binary)
+        {
+            return nullptr;
+        }
+        if (op == QStringLiteral("&&") || op == QStringLiteral("||"))
+        {
+            const QString neutral = op == QStringLiteral("&&") ? QStringLiteral("true") : QStringLiteral("false");
+            if (isBooleanLiteral(left))
+            {
+                if (left->text != neutral)
+                {
+                    return left;
+                }
+                return isBooleanExpression(right) ? right : nullptr;
+            }
+            return isBooleanLiteral(right) && right->text == neutral && isBooleanExpression(left) ? left : nullptr;
+        }
+        const bool equality = op == QStringLiteral("==") || op == QStringLiteral("!=");
+        if (equality && isBooleanLiteral(left) && isBooleanLiteral(right))
+        {
+            return booleanNode((left->text == right->text) == (op == QStringLiteral("==")));
+        }
+        if (binaryPrecedence(op) != binaryPrecedence(QStringLiteral("<")) && !equality)
+        {
+            return nullptr;
+        }
+        if (left->kind != ExpressionNode::Kind::Number || right->kind != ExpressionNode::Kind::Number)
+        {
+            return nullptr;
+        }
+        const double a = left->text.toDouble();
+        const double b = right->text.toDouble();
+        if (op == QStringLiteral("=="))
+        {
+            return booleanNode(a == b);
+        }
+        if (op == QStringLiteral("!="))
+        {
+            return booleanNode(a != b);
+        }
+        if (op == QStringLiteral("<"))
+        {
+            return booleanNode(a < b);
+        }
+        if (op == QStringLiteral(">"))
+        {
+            return booleanNode(a > b);
+        }
+        return booleanNode(op == QStringLiteral("<=") ? a <= b : a >= b);
+    }
+
+    ExpressionPtr foldConstants(const ExpressionPtr &node, const QMap<QString, QString> &constants)
+    {
+        switch (node->kind)
+        {
+        case ExpressionNode::Kind::Number:
+            return node;
+        case ExpressionNode::Kind::Identifier:
+        {
+            if (!constants.contains(node->text))
+            {
+                return node;
+            }
+            ExpressionPtr value = SpanishExpressionParser::parseGenerated(constants.value(node->text));
+            if (value)
+            {
+                value = foldConstants(value, QMap<QString, QString>());
+            }
+            if (!value || value->kind != ExpressionNode::Kind::Number)
+            {
+                return node;
+            }
+            return value;
+        }
+        case ExpressionNode::Kind::Unary:
+        {
+            ExpressionPtr operand = foldConstants(node->left, constants);
+            if (operand->kind == ExpressionNode::Kind::Number && node->text == QStringLiteral("-"))
+            {
+                return numberNode(-operand->text.toDouble(), operand->floating);
+            }
+            auto copy = std::make_shared<ExpressionNode>(*node);
+            copy->left = operand;
+            ExpressionPtr logical = foldLogical(copy);
+            return logical ? logical : copy;
+        }
+        case ExpressionNode::Kind::Binary:
+        {
+            ExpressionPtr left = foldConstants(node->left, constants);
+            ExpressionPtr right = foldConstants(node->right, constants);
+            auto copy = std::make_shared<ExpressionNode>(*node);
+            copy->left = left;
+            copy->right = right;
+            if (ExpressionPtr logical = foldLogical(copy))
+            {
+                return logical;
+            }
+            if (left->kind == ExpressionNode::Kind::Number && right->kind == ExpressionNode::Kind::Number)
+            {
+                bool floating = left->floating || right->floating;
+                const QString &op = node->text;
+                if (floating)
+                {
+                    double a = left->text.toDouble();
+                    double b = right->text.toDouble();
+                    double result = 0.0;
+                    bool valid = true;
+                    if (op == QStringLiteral("+"))
+                        result = a + b;
+                    else if (op == QStringLiteral("-"))
+                        result = a - b;
+                    else if (op == QStringLiteral("*"))
+                        result = a * b;
+                    else if (op == QStringLiteral("/") && b != 0.0)
+                        result = a / b;
+                    else
+                        valid = false;
+                    if (valid && std::isfinite(result))
+                    {
+                        return numberNode(result, true);
+                    }
+                }
+                else
+                {
+                    bool leftOk = false;
+                    bool rightOk = false;
+                    long long a = left->text.toLongLong(&leftOk);
+                    long long b = right->text.toLongLong(&rightOk);
+                    long long result = 0;
+                    bool valid = leftOk && rightOk;
+                    if (!valid)
+                        ;
+                    else if (op == QStringLiteral("+"))
+                        result = a + b;
+                    else if (op == QStringLiteral("-"))
+                        result = a - b;
+                    else if (op == QStringLiteral("*"))
+                        result = a * b;
+                    else if (op == QStringLiteral("/") && b != 0)
+                        result = a / b;
+                    else if (op == QStringLiteral("%") && b != 0)
+                        result = a % b;
+                    else
+                        valid = false;
+                    if (valid && result >= std::numeric_limits<int>::min() && result <= std::numeric_limits<int>::max())
+                    {
+                        return numberNode(static_cast<double>(result), false);
+                    }
+                }
+            }
+            return copy;
+        }
+        case ExpressionNode::Kind::Index:
+        {
+            auto copy = std::make_shared<ExpressionNode>(*node);
+            copy->right = foldConstants(node->right, constants);
+            return copy;
+        }
+        case ExpressionNode::Kind::Conversion:
+        {
+            ExpressionPtr operand = foldConstants(node->left, constants);
+            if (operand->kind == ExpressionNode::Kind::Number)
+            {
+                const bool floating = node->text == QStringLiteral("double");
+                const double value = operand->text.toDouble();
+                return numberNode(floating ? value : std::trunc(value), floating);
+            }
+            auto copy = std::make_shared<ExpressionNode>(*node);
+            copy->left = operand;
+            return copy;
+        }
+        }
+        return node;
+    }
+
+    using KeywordMask = quint32;
+
+    enum Keyword : KeywordMask
+    {
+        KeywordLeer = 1u << 0,
+        KeywordCargar = 1u << 1,
+        KeywordImportar = 1u << 2,
+        KeywordDatos = 1u << 3,
+        KeywordArchivo = 1u << 4,
+        KeywordImprimir = 1u << 5,
+        KeywordMostrar = 1u << 6,
+        KeywordPaises = 1u << 7,
+        KeywordCapitales = 1u << 8,
+        KeywordTodosLosElementos = 1u << 9,
+        KeywordVector = 1u << 10,
+        KeywordLista = 1u << 11,
+        KeywordArreglo = 1u << 12,
+        KeywordMostrarResultado = 1u << 13,
+        KeywordDecimal = 1u << 14,
+        KeywordPedirAlUsuario = 1u << 15,
+        KeywordPedir = 1u << 16,
+        KeywordSolicitar = 1u << 17,
+        KeywordUsuario = 1u << 18,
+        KeywordIngrese = 1u << 19,
+        KeywordNumero = 1u << 20,
+        KeywordConsola = 1u << 21
+    };
+
+    class KeywordScanner
+    {
+    public:
+        static const KeywordScanner &instance()
+        {
+            static const KeywordScanner scanner;
+            return scanner;
+        }
+
+        KeywordMask scan(const QString &text) const
+        {
+            KeywordMask found = 0;
+            int state = 0;
+            for (const QChar &ch : text)
+            {
+                state = m_states[state].next[symbol(ch)];
+                found |= m_states[state].output;
+            }
+            return found;
+        }
+
+    private:
+        static const int AlphabetSize = 28;
+
+        struct State
+        {
+            std::array<int, AlphabetSize> next;
+            KeywordMask output = 0;
+        };
+
+        static int symbol(QChar ch)
+        {
+            const ushort code = ch.unicode();
+            if (code >= 'a' && code <= 'z')
+            {
+                return code - 'a';
+            }
+            return code == ' ' ? 26 : 27;
+        }
+
+        KeywordScanner()
+        {
+            const QPair<const char *, KeywordMask> keywords[] = {
+                {"leer", KeywordLeer},
+                {"cargar", KeywordCargar},
+                {"importar", KeywordImportar},
+                {"datos", KeywordDatos},
+                {"archivo", KeywordArchivo},
+                {"imprimir", KeywordImprimir},
+                {"mostrar", KeywordMostrar},
+                {"paises", KeywordPaises},
+                {"capitales", KeywordCapitales},
+                {"todos los elementos", KeywordTodosLosElementos},
+                {"vector", KeywordVector},
+                {"lista", KeywordLista},
+                {"arreglo", KeywordArreglo},
+                {"y mostrar el resultado", KeywordMostrarResultado},
+                {"decimal", KeywordDecimal},
+                {"pedir al usuario", KeywordPedirAlUsuario},
+                {"pedir", KeywordPedir},
+                {"solicitar", KeywordSolicitar},
+                {"usuario", KeywordUsuario},
+                {"ingrese", KeywordIngrese},
+                {"numero", KeywordNumero},
+                {"consola", KeywordConsola}};
+
+            m_states.append(State());
+            m_states[0].next.fill(-1);
+            for (const auto &keyword : keywords)
+            {
+                int state = 0;
+                for (const char *ch = keyword.first; *ch; ++ch)
+                {
+                    const int next = symbol(QLatin1Char(*ch));
+                    if (m_states[state].next[next] < 0)
+                    {
+                        m_states[state].next[next] = m_states.size();
+                        m_states.append(State());
+                        m_states.last().next.fill(-1);
+                    }
+                    state = m_states[state].next[next];
+                }
+                m_states[state].output |= keyword.second;
+            }
+
+            QVector<int> failure(m_states.size(), 0);
+            QVector<int> queue;
+            for (int &next : m_states[0].next)
+            {
+                if (next < 0)
+                {
+                    next = 0;
+                }
+                else
+                {
+                    queue.append(next);
+                }
+            }
+            for (int head = 0; head < queue.size(); ++head)
+            {
+                const int state = queue[head];
+                m_states[state].output |= m_states[failure[state]].output;
+                for (int symbolIndex = 0; symbolIndex < AlphabetSize; ++symbolIndex)
+                {
+                    const int next = m_states[state].next[symbolIndex];
+                    const int fallback = m_states[failure[state]].next[symbolIndex];
+                    if (next < 0)
+                    {
+                        m_states[state].next[symbolIndex] = fallback;
+                    }
+                    else
+                    {
+                        failure[next] = fallback;
+                        queue.append(next);
+                    }
+                }
+            }
+        }
+
+        QVector<State> m_states;
+    };
+
+    bool hasAll(KeywordMask found, KeywordMask required)
+    {
+        return (found & required) == required;
+    }
+
+    QString typeFromWords(const QString &phrase, const QString &fallback)
+    {
+        const Vocabulary::TypeWord *best = nullptr;
+        int i = 0;
+        while (i < phrase.size())
+        {
+            if (!phrase.at(i).isLetter())
+            {
+                ++i;
+                continue;
+            }
+            const int start = i;
+            while (i < phrase.size() && phrase.at(i).isLetter())
+            {
+                ++i;
+            }
+            const Vocabulary::Entry<Vocabulary::TypeWord> *entry = Vocabulary::typeWords.find(phrase, start, i - start);
+            if (entry && (!best || entry->value.rank < best->rank))
+            {
+                best = &entry->value;
+            }
+        }
+        return best ? QString::fromLatin1(best->cppType) : fallback;
+    }
+
+    const int LargeEmbeddedDataValues = 10000;
+
+    enum class BlockType
+    {
+        Generic,
+        If,
+        Loop
+    };
+
+    struct BlockState
+    {
+        BlockType type = BlockType::Generic;
+        bool autoClose = false;
+        bool hasElse = false;
+        bool hasElseIf = false;
+        int indent = 0;
+        int sourceLine = -1;
+        QString collection;
+    };
+
+    struct VariableInfo
+    {
+        QString type;
+        bool fromInstruction = false;
+    };
+
+    struct CollectionInfo
+    {
+        QString type;
+        QString elementType;
+        QString alias;
+        int size = 0;
+        bool fixedSize = false;
+        bool isCArray = false;
+    };
+
+    struct FunctionInfo
+    {
+        QString name;
+        QString returnType;
+        QStringList parameterTypes;
+        QStringList parameterNames;
+        CodeLines body;
+        int sourceLine = -1;
+    };
+
+    struct CallSite
+    {
+        int line = -1;
+        QString functionName;
+        QStringList arguments;
+        bool insideLoop = false;
+    };
+
+    struct SumAccumulator
+    {
+        QString collection;
+        int endLine = -1;
+    };
+
+    struct StructInfo
+    {
+        QString name;
+        QStringList fieldNames;
+        QStringList fieldTypes;
+        bool structOfArrays = false;
+        int sourceLine = -1;
+    };
+
+    struct FieldLayout
+    {
+        int size = 8;
+        int alignment = 8;
+    };
+
+    FieldLayout fieldLayoutForType(const QString &type)
+    {
+        if (type == QStringLiteral("std::string"))
+        {
+            return {32, 8};
+        }
+        if (type == QStringLiteral("double") || type == QStringLiteral("long long") || type == QStringLiteral("std::size_t"))
+        {
+            return {8, 8};
+        }
+        if (type == QStringLiteral("int") || type == QStringLiteral("float"))
+        {
+            return {4, 4};
+        }
+        if (type == QStringLiteral("bool") || type == QStringLiteral("char"))
+        {
+            return {1, 1};
+        }
+        return {8, 8};
+    }
+
+    int structSizeForOrder(const StructInfo &structInfo, const QVector<int> &order, bool packed)
+    {
+        int offset = 0;
+        int maxAlignment = 1;
+        for (int index : order)
+        {
+            FieldLayout layout = fieldLayoutForType(structInfo.fieldTypes[index]);
+            int alignment = packed ? 1 : layout.alignment;
+            offset = (offset + alignment - 1) / alignment * alignment;
+            offset += layout.size;
+            maxAlignment = qMax(maxAlignment, alignment);
+        }
+        return (offset + maxAlignment - 1) / maxAlignment * maxAlignment;
+    }
+
+    QVector<int> paddingMinimizingOrder(const StructInfo &structInfo)
+    {
+        QVector<int> order;
+        for (int i = 0; i < structInfo.fieldNames.size() && i < structInfo.fieldTypes.size(); ++i)
+        {
+            order.append(i);
+        }
+        std::stable_sort(order.begin(), order.end(), [&structInfo](int a, int b)
+                         {
+                             FieldLayout left = fieldLayoutForType(structInfo.fieldTypes[a]);
+                             FieldLayout right = fieldLayoutForType(structInfo.fieldTypes[b]);
+                             if (left.alignment != right.alignment)
+                             {
+                                 return left.alignment > right.alignment;
+                             }
+                             return left.size > right.size; });
+        return order;
+    }
+
+    bool isScalarType(const QString &type)
+    {
+        static const QSet<QString> scalars = {
+            QStringLiteral("int"),
+            QStringLiteral("double"),
+            QStringLiteral("float"),
+            QStringLiteral("bool"),
+            QStringLiteral("char"),
+            QStringLiteral("long long"),
+            QStringLiteral("std::size_t")};
+        return scalars.contains(type);
+    }
+
+    bool linesMutateIdentifier(const QStringList &lines, const QString &name)
+    {
+        QString escaped = QRegularExpression::escape(name);
+        QRegularExpression writeRe(QStringLiteral("(?:^|[^\\w.])%1\\s*(?:\\[[^\\]]*\\]\\s*)?(?:\\.\\w+\\s*)?(?:[-+*/%]?=(?!=)|\\+\\+|--)|(?:\\+\\+|--)%1\\b|>>\\s*%1\\b|\\b%1\\.(?:push_back|pop_back|emplace_back|erase|insert|clear|resize|assign|swap)\\s*\\(|\\b%1\\.begin\\(\\)").arg(escaped));
+        for (const QString &line : lines)
+        {
+            if (writeRe.match(line).hasMatch())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const QRegularExpression &literalPattern()
+    {
+        static const QRegularExpression literalRe(QStringLiteral("\"(?:[^\"\\\\]|\\\\.)*\"|'(?:[^'\\\\]|\\\\.)*'"));
+        return literalRe;
+    }
+
+    QString withoutLiterals(const QString &code)
+    {
+        QString stripped = code;
+        stripped.replace(literalPattern(), QStringLiteral("\"\""));
+        return stripped;
+    }
+
+    QString replaceOutsideLiterals(const QString &code, const QRegularExpression &pattern, const QString &replacement)
+    {
+        QString result;
+        int position = 0;
+        auto it = literalPattern().globalMatch(code);
+        while (it.hasNext())
+        {
+            QRegularExpressionMatch literal = it.next();
+            result += code.mid(position, literal.capturedStart() - position).replace(pattern, replacement);
+            result += literal.captured(0);
+            position = literal.capturedEnd();
+        }
+        result += code.mid(position).replace(pattern, replacement);
+        return result;
+    }
+
+    QSet<QString> identifiersIn(const QString &code)
+    {
+        static const QRegularExpression identifierRe(QStringLiteral("(?:^|[^\\w.])([A-Za-z_]\\w*)"));
+        QSet<QString> identifiers;
+        QString stripped = withoutLiterals(code);
+        auto it = identifierRe.globalMatch(stripped);
+        while (it.hasNext())
+        {
+            identifiers.insert(it.next().captured(1));
+        }
+        return identifiers;
+    }
+
+    bool hasSideEffects(const QString &expression, const QSet<QString> &pureFunctions = QSet<QString>())
+    {
+        static const QSet<QString> pureCalls = {
+            QStringLiteral("size"),
+            QStringLiteral("empty"),
+            QStringLiteral("sqrt"),
+            QStringLiteral("pow"),
+            QStringLiteral("abs"),
+            QStringLiteral("fabs"),
+            QStringLiteral("min"),
+            QStringLiteral("max"),
+            QStringLiteral("lowest"),
+            QStringLiteral("to_string")};
+        static const QRegularExpression callRe(QStringLiteral("(\\w+)\\s*\\("));
+        QString stripped = withoutLiterals(expression);
+        if (stripped.contains(QStringLiteral("std::cin")) || stripped.contains(QStringLiteral("++")) || stripped.contains(QStringLiteral("--")))
+        {
+            return true;
+        }
+        auto it = callRe.globalMatch(stripped);
+        while (it.hasNext())
+        {
+            QString callee = it.next().captured(1);
+            if (!pureCalls.contains(callee) && !pureFunctions.contains(callee))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct StoreStatement
+    {
+        QString target;
+        QString value;
+        bool declaration = false;
+        QString declarationPrefix;
+    };
+
+    bool parseStoreStatement(const QString &line, StoreStatement &store)
+    {
+        static const QRegularExpression declarationRe(QStringLiteral("^(?:const\\s+)?(?:int|double|float|bool|char|long long|std::size_t|std::string)\\s+([A-Za-z_]\\w*)\\s*(?:=\\s*(.+))?;$"));
+        static const QRegularExpression assignmentRe(QStringLiteral("^([A-Za-z_]\\w*)\\s*[-+*/%]?=(?!=)\\s*(.+);$"));
+        static const QRegularExpression incrementRe(QStringLiteral("^(?:\\+\\+|--)?([A-Za-z_]\\w*)(?:\\+\\+|--)?;$"));
+        QString trimmed = line.trimmed();
+        QRegularExpressionMatch match = declarationRe.match(trimmed);
+        if (match.hasMatch())
+        {
+            store = {match.captured(1), match.captured(2), true, trimmed.left(match.capturedEnd(1))};
+            return true;
+        }
+        match = assignmentRe.match(trimmed);
+        if (match.hasMatch())
+        {
+            store = {match.captured(1), match.captured(2), false, QString()};
+            return true;
+        }
+        match = incrementRe.match(trimmed);
+        if (match.hasMatch() && trimmed != match.captured(1) + QStringLiteral(";"))
+        {
+            store = {match.captured(1), QString(), false, QString()};
+            return true;
+        }
+        return false;
+    }
+
+    int eliminateDeadStores(CodeLines &lines, const QSet<QString> &pureFunctions, QStringList &removedVariables)
+    {
+        int removedStores = 0;
+
+        for (int i = 0; i + 1 < lines.size(); ++i)
+        {
+            StoreStatement declaration;
+            StoreStatement next;
+            if (!parseStoreStatement(lines[i], declaration) || !declaration.declaration || hasSideEffects(declaration.value, pureFunctions) ||
+                !parseStoreStatement(lines[i + 1], next) || next.declaration || next.target != declaration.target ||
+                next.value.isEmpty() || !lines[i + 1].trimmed().startsWith(next.target + QStringLiteral(" = ")) ||
+                identifiersIn(next.value).contains(next.target))
+            {
+                continue;
+            }
+            QString indent = lines[i].left(lines[i].indexOf(lines[i].trimmed()));
+            lines.replace(i, QStringLiteral("%1%2 = %3;").arg(indent, declaration.declarationPrefix, next.value));
+            lines.removeAt(i + 1);
+            if (!declaration.value.isEmpty())
+            {
+                ++removedStores;
+            }
+            --i;
+        }
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+
+            QSet<QString> declared;
+            QSet<QString> read;
+            QVector<StoreStatement> stores;
+            for (int i = 0; i < lines.size(); ++i)
+            {
+                stores.append(StoreStatement());
+                if (!parseStoreStatement(lines[i], stores[i]))
+                {
+                    read.unite(identifiersIn(lines[i]));
+                    continue;
+                }
+                if (stores[i].declaration)
+                {
+                    declared.insert(stores[i].target);
+                }
+                QSet<QString> operands = identifiersIn(stores[i].value);
+                if (hasSideEffects(stores[i].value, pureFunctions))
+                {
+                    operands.insert(stores[i].target);
+                }
+                else
+                {
+                    operands.remove(stores[i].target);
+                }
+                read.unite(operands);
+            }
+
+            QSet<QString> dead = declared;
+            dead.subtract(read);
+            if (dead.isEmpty())
+            {
+                break;
+            }
+
+            QStringList removedNow;
+            for (int i = lines.size() - 1; i >= 0; --i)
+            {
+                if (stores[i].target.isEmpty() || !dead.contains(stores[i].target))
+                {
+                    continue;
+                }
+                if (stores[i].declaration)
+                {
+                    removedNow.prepend(stores[i].target);
+                }
+                else
+                {
+                    ++removedStores;
+                }
+                lines.removeAt(i);
+                changed = true;
+            }
+            removedVariables.append(removedNow);
+
+            for (int i = lines.size() - 2; i >= 0; --i)
+            {
+                QString header = lines[i].trimmed();
+                if (header.startsWith(QStringLiteral("for (")) && header.endsWith('{') &&
+                    lines[i + 1].trimmed() == QStringLiteral("}") && !hasSideEffects(header.mid(4).remove(QStringLiteral("++"))))
+                {
+                    lines.removeAt(i + 1);
+                    lines.removeAt(i);
+                    changed = true;
+                }
+            }
+        }
+
+        return removedStores;
+    }
+
+    int blockEndLine(const QStringList &lines, int header)
+    {
+        int depth = 0;
+        for (int i = header; i < lines.size(); ++i)
+        {
+            QString code = withoutLiterals(lines[i]);
+            depth += code.count('{') - code.count('}');
+            if (depth <= 0)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    QString inductionStep(const QString &line, const QString &variable)
+    {
+        static const QRegularExpression stepRe(QStringLiteral("^([A-Za-z_]\\w*)\\s*(?:([-+])=\\s*([0-9.]+)|=\\s*([A-Za-z_]\\w*)\\s*([-+])\\s*([0-9.]+));$"));
+        QRegularExpressionMatch match = stepRe.match(line.trimmed());
+        if (!match.hasMatch() || match.captured(1) != variable)
+        {
+            return QString();
+        }
+        QString op = match.captured(2);
+        QString amount = match.captured(3);
+        if (op.isEmpty())
+        {
+            if (match.captured(4) != variable)
+            {
+                return QString();
+            }
+            op = match.captured(5);
+            amount = match.captured(6);
+        }
+        if (amount == QStringLiteral("1"))
+        {
+            return op + op + variable;
+        }
+        return QStringLiteral("%1 %2= %3").arg(variable, op, amount);
+    }
+
+    int canonicalizeCountingLoops(CodeLines &lines)
+    {
+        static const QRegularExpression whileRe(QStringLiteral("^while \\((.+)\\) \\{$"));
+        int converted = 0;
+        for (int header = 0; header < lines.size(); ++header)
+        {
+            QRegularExpressionMatch match = whileRe.match(lines[header].trimmed());
+            if (!match.hasMatch())
+            {
+                continue;
+            }
+            int end = blockEndLine(lines.texts(), header);
+            if (end < 0 || end - header < 2)
+            {
+                continue;
+            }
+            QStringList body = lines.mid(header + 1, end - header - 1);
+            if (withoutLiterals(body.join('\n')).contains(QStringLiteral("continue")))
+            {
+                continue;
+            }
+
+            QString condition = match.captured(1);
+            int stepLine = -1;
+            QString variable;
+            QString step;
+            StoreStatement store;
+            if (parseStoreStatement(body.last(), store) && !store.declaration)
+            {
+                step = inductionStep(body.last(), store.target);
+                stepLine = body.size() - 1;
+            }
+            if (step.isEmpty() && parseStoreStatement(body.first(), store) && !store.declaration)
+            {
+                step = inductionStep(body.first(), store.target);
+                stepLine = 0;
+                if (!step.isEmpty() && identifiersIn(body.mid(1).join('\n')).contains(store.target))
+                {
+                    step.clear();
+                }
+            }
+            variable = store.target;
+            if (step.isEmpty() || !identifiersIn(condition).contains(variable))
+            {
+                continue;
+            }
+            QStringList rest = body;
+            rest.removeAt(stepLine);
+            if (linesMutateIdentifier(rest, variable))
+            {
+                continue;
+            }
+
+            QString indent = lines[header].left(lines[header].indexOf(lines[header].trimmed()));
+            QString init;
+            StoreStatement declaration;
+            if (header > 0 && parseStoreStatement(lines[header - 1], declaration) && declaration.declaration &&
+                declaration.target == variable && !declaration.value.isEmpty() &&
+                lines[header - 1].startsWith(indent + declaration.declarationPrefix) &&
+                !identifiersIn(lines.mid(end + 1).join('\n')).contains(variable))
+            {
+                init = QStringLiteral("%1 = %2").arg(declaration.declarationPrefix, declaration.value);
+            }
+
+            lines.replace(header, QStringLiteral("%1for (%2; %3; %4) {").arg(indent, init, condition, step));
+            lines.removeAt(header + 1 + stepLine);
+            if (!init.isEmpty())
+            {
+                lines.removeAt(header - 1);
+                --header;
+            }
+            ++converted;
+        }
+        return converted;
+    }
+
+    bool linesResizeCollection(const QStringList &lines, const QString &collection)
+    {
+        QString escaped = QRegularExpression::escape(collection);
+        QRegularExpression resizeRe(QStringLiteral("(?:^|[^\\w.])%1(?:\\.\\w+)?\\.(?:push_back|emplace_back|pop_back|erase|insert|clear|resize|assign|swap)\\s*\\(|(?:^|[^\\w.])%1\\s*=(?!=)|swap\\s*\\(\\s*%1\\b").arg(escaped));
+        for (const QString &line : lines)
+        {
+            if (resizeRe.match(withoutLiterals(line)).hasMatch())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    QString unusedName(const QString &base, const QSet<QString> &taken)
+    {
+        QString name = base;
+        for (int suffix = 1; taken.contains(name); ++suffix)
+        {
+            name = QStringLiteral("%1%2").arg(base).arg(suffix);
+        }
+        return name;
+    }
+
+    int hoistLoopBounds(CodeLines &lines, int &rangeLoops)
+    {
+        static const QRegularExpression indexLoopRe(QStringLiteral("^for \\(std::size_t ([A-Za-z_]\\w*) = 0; \\1 < ([A-Za-z_]\\w*)\\.size\\(\\); \\+\\+\\1\\) \\{$"));
+        int hoisted = 0;
+        for (int header = 0; header < lines.size(); ++header)
+        {
+            QRegularExpressionMatch match = indexLoopRe.match(lines[header].trimmed());
+            if (!match.hasMatch())
+            {
+                continue;
+            }
+            int end = blockEndLine(lines.texts(), header);
+            if (end < 0)
+            {
+                continue;
+            }
+            QString index = match.captured(1);
+            QString collection = match.captured(2);
+            QStringList body = lines.mid(header + 1, end - header - 1);
+            if (linesResizeCollection(body, collection))
+            {
+                continue;
+            }
+
+            QString indent = lines[header].left(lines[header].indexOf(lines[header].trimmed()));
+            QSet<QString> taken = identifiersIn(lines.mid(header, end - header + 1).join('\n'));
+            QRegularExpression elementRe(QStringLiteral("\\b%1\\[%2\\]").arg(QRegularExpression::escape(collection), QRegularExpression::escape(index)));
+            QString bodyText = withoutLiterals(body.join('\n'));
+            if (bodyText.contains(elementRe) && !identifiersIn(bodyText.replace(elementRe, QString())).contains(index))
+            {
+                QString element = unusedName(QStringLiteral("elemento"), taken);
+                for (int i = header + 1; i < end; ++i)
+                {
+                    lines.replace(i, replaceOutsideLiterals(lines[i], elementRe, element));
+                }
+                lines.replace(header, QStringLiteral("%1for (auto &%2 : %3) {").arg(indent, element, collection));
+                ++rangeLoops;
+                continue;
+            }
+
+            QString bound = unusedName(QStringLiteral("fin"), taken);
+            lines.replace(header, QStringLiteral("%1for (std::size_t %2 = 0, %3 = %4.size(); %2 < %3; ++%2) {").arg(indent, index, bound, collection));
+            ++hoisted;
+        }
+        return hoisted;
+    }
+
+    QSet<QString> identifiersWritten(const QStringList &lines)
+    {
+        QSet<QString> written;
+        for (const QString &identifier : identifiersIn(lines.join('\n')))
+        {
+            if (linesMutateIdentifier(lines, identifier))
+            {
+                written.insert(identifier);
+            }
+        }
+        return written;
+    }
+
+    bool linesHaveEffects(const QStringList &lines)
+    {
+        QString text = lines.join('\n');
+        return hasSideEffects(text) || withoutLiterals(text).contains(QStringLiteral("std::cout"));
+    }
+
+    int fuseCollectionLoops(CodeLines &lines)
+    {
+        static const QRegularExpression rangeLoopRe(QStringLiteral("^for \\((?:const )?[\\w:<>]+ &([A-Za-z_]\\w*) : ([A-Za-z_]\\w*)\\) \\{$"));
+        int fused = 0;
+        for (int first = 0; first < lines.size(); ++first)
+        {
+            QRegularExpressionMatch firstLoop = rangeLoopRe.match(lines[first].trimmed());
+            int firstEnd = firstLoop.hasMatch() ? blockEndLine(lines.texts(), first) : -1;
+            if (firstEnd < 0)
+            {
+                continue;
+            }
+            QString indent = lines[first].left(lines[first].indexOf(lines[first].trimmed()));
+            QString collection = firstLoop.captured(2);
+
+            int second = firstEnd + 1;
+            QRegularExpressionMatch secondLoop;
+            StoreStatement store;
+            while (second < lines.size())
+            {
+                secondLoop = rangeLoopRe.match(lines[second].trimmed());
+                if (secondLoop.hasMatch() || !lines[second].startsWith(indent) || lines[second].at(indent.size()).isSpace() ||
+                    !parseStoreStatement(lines[second], store) || hasSideEffects(store.value))
+                {
+                    break;
+                }
+                ++second;
+            }
+            int secondEnd = secondLoop.hasMatch() ? blockEndLine(lines.texts(), second) : -1;
+            if (secondEnd < 0 || secondLoop.captured(2) != collection || !lines[second].startsWith(indent + QStringLiteral("for")))
+            {
+                continue;
+            }
+
+            QString firstVariable = firstLoop.captured(1);
+            QString secondVariable = secondLoop.captured(1);
+            QStringList firstBody = lines.mid(first + 1, firstEnd - first - 1);
+            QStringList secondBody = lines.mid(second + 1, secondEnd - second - 1);
+            if (firstVariable != secondVariable && identifiersIn(secondBody.join('\n')).contains(firstVariable))
+            {
+                continue;
+            }
+            QRegularExpression secondVariableRe(QStringLiteral("\\b%1\\b").arg(QRegularExpression::escape(secondVariable)));
+            for (QString &line : secondBody)
+            {
+                line = replaceOutsideLiterals(line, secondVariableRe, firstVariable);
+            }
+
+            QSet<QString> firstReads = identifiersIn(firstBody.join('\n'));
+            QSet<QString> secondReads = identifiersIn(secondBody.join('\n'));
+            QSet<QString> firstWrites = identifiersWritten(firstBody);
+            QSet<QString> secondWrites = identifiersWritten(secondBody);
+            QSet<QString> secondTouched = secondReads;
+            secondTouched.unite(secondWrites);
+            if ((linesHaveEffects(firstBody) && linesHaveEffects(secondBody)) ||
+                linesResizeCollection(firstBody, collection) || linesResizeCollection(secondBody, collection) ||
+                firstWrites.contains(firstVariable) || firstWrites.contains(collection) || secondWrites.contains(collection) ||
+                firstWrites.intersects(secondTouched) ||
+                secondWrites.intersects(firstReads))
+            {
+                continue;
+            }
+
+            CodeLines before;
+            CodeLines after;
+            QSet<QString> afterTouched;
+            QSet<QString> afterWrites;
+            bool movable = true;
+            for (int i = firstEnd + 1; i < second && movable; ++i)
+            {
+                parseStoreStatement(lines[i], store);
+                QSet<QString> reads = identifiersIn(store.value);
+                bool readsFirst = reads.intersects(firstWrites) || firstReads.contains(store.target) || firstWrites.contains(store.target);
+                bool blocked = reads.intersects(afterWrites) || afterTouched.contains(store.target);
+                if (!readsFirst && !blocked)
+                {
+                    before.append(lines[i], lines.origin(i));
+                }
+                else if (!reads.intersects(secondWrites) && !secondTouched.contains(store.target))
+                {
+                    after.append(lines[i], lines.origin(i));
+                    afterTouched.unite(reads);
+                    afterTouched.insert(store.target);
+                    afterWrites.insert(store.target);
+                }
+                else
+                {
+                    movable = false;
+                }
+            }
+            if (!movable)
+            {
+                continue;
+            }
+
+            CodeLines merged = before;
+            merged.append(lines[first], lines.origin(first));
+            for (int i = 0; i < firstBody.size(); ++i)
+            {
+                merged.append(firstBody[i], lines.origin(first + 1 + i));
+            }
+            for (int i = 0; i < secondBody.size(); ++i)
+            {
+                merged.append(secondBody[i], lines.origin(second + 1 + i));
+            }
+            merged.append(lines[firstEnd], lines.origin(firstEnd));
+            merged.appendLines(after);
+            for (int i = secondEnd; i >= first; --i)
+            {
+                lines.removeAt(i);
+            }
+            for (int i = 0; i < merged.size(); ++i)
+            {
+                lines.insert(first + i, merged[i], merged.origin(i));
+            }
+            first += before.size() - 1;
+            ++fused;
+        }
+        return fused;
+    }
+
+    struct BlockDepths
+    {
+        QVector<int> before;
+        QVector<int> minimum;
+    };
+
+    BlockDepths computeBlockDepths(const QStringList &lines)
+    {
+        BlockDepths depths;
+        int depth = 0;
+        for (const QString &line : lines)
+        {
+            depths.before.append(depth);
+            int lowest = depth;
+            for (const QChar &ch : withoutLiterals(line))
+            {
+                if (ch == '{')
+                {
+                    ++depth;
+                }
+                else if (ch == '}')
+                {
+                    lowest = qMin(lowest, --depth);
+                }
+            }
+            depths.minimum.append(lowest);
+        }
+        return depths;
+    }
+
+    bool staysInScope(const BlockDepths &depths, int from, int to)
+    {
+        for (int i = from + 1; i < to; ++i)
+        {
+            if (depths.minimum[i] < depths.before[from])
+            {
+                return false;
+            }
+        }
+        return depths.before[to] >= depths.before[from];
+    }
+
+    int outermostBlockEnd(const QStringList &lines, int from, int to)
+    {
+        for (int header = from + 1; header < to; ++header)
+        {
+            int end = blockEndLine(lines, header);
+            if (end >= to && end > header)
+            {
+                return end;
+            }
+        }
+        return to;
+    }
+
+    QString indentOf(const QString &line)
+    {
+        return line.left(line.indexOf(line.trimmed()));
+    }
+
+    QString dedented(const QString &line)
+    {
+        return line.startsWith(QStringLiteral("    ")) ? line.mid(4) : line;
+    }
+
+    bool isLiteral(const QString &expression)
+    {
+        static const QRegularExpression literalRe(QStringLiteral("^(?:-?\\d+(?:\\.\\d+)?f?|\"(?:[^\"\\\\]|\\\\.)*\"|'(?:[^'\\\\]|\\\\.)*'|true|false)$"));
+        return literalRe.match(expression.trimmed()).hasMatch();
+    }
+
+    QString zeroLiteralForType(const QString &type)
+    {
+        if (type == QStringLiteral("std::string"))
+        {
+            return QStringLiteral("\"\"");
+        }
+        if (type == QStringLiteral("bool"))
+        {
+            return QStringLiteral("false");
+        }
+        return isScalarType(type) ? QStringLiteral("0") : QString();
+    }
+
+    // Una lista de inicialización no admite conversiones que estrechen, como 87.5 en un int.
+    bool literalFitsType(const QString &literal, const QString &type)
+    {
+        const QString value = literal.trimmed();
+        if (value.startsWith('"'))
+        {
+            return type == QStringLiteral("std::string");
+        }
+        if (value.startsWith('\''))
+        {
+            return type == QStringLiteral("char");
+        }
+        if (value == QStringLiteral("true") || value == QStringLiteral("false"))
+        {
+            return type == QStringLiteral("bool");
+        }
+        if (type == QStringLiteral("double") || type == QStringLiteral("float"))
+        {
+            return true;
+        }
+        if (value.contains('.') || value.endsWith('f') || !isScalarType(type) || type == QStringLiteral("bool") || type == QStringLiteral("char"))
+        {
+            return false;
+        }
+        return !value.startsWith('-') || type != QStringLiteral("std::size_t");
+    }
+
+    QString vectorElementType(const CodeLines &lines, const QString &collection)
+    {
+        const QRegularExpression declarationRe(QStringLiteral("std::vector<([^;=()]+)> &?%1\\b").arg(QRegularExpression::escape(collection)));
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            QRegularExpressionMatch declaration = declarationRe.match(lines[i]);
+            if (declaration.hasMatch())
+            {
+                return declaration.captured(1);
+            }
+        }
+        return QString();
+    }
+
+    int collapseElementInitializers(CodeLines &lines)
+    {
+        static const QRegularExpression sizedVectorRe(QStringLiteral("^std::vector<(.+)> ([A-Za-z_]\\w*)\\((\\d+)\\);$"));
+        static const QRegularExpression cArrayRe(QStringLiteral("^([\\w:]+(?: \\w+)?) ([A-Za-z_]\\w*)\\[(\\d+)\\];$"));
+        static const QRegularExpression emptyVectorRe(QStringLiteral("^std::vector<(.+)> ([A-Za-z_]\\w*);$"));
+        static const QRegularExpression elementStoreRe(QStringLiteral("^([A-Za-z_]\\w*)\\[(\\d+)\\] = (.+);$"));
+        static const QRegularExpression pushBackRe(QStringLiteral("^([A-Za-z_]\\w*)\\.push_back\\((.+)\\);$"));
+        int collapsed = 0;
+
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            QString declaration = lines[i].trimmed();
+            QRegularExpressionMatch sized = sizedVectorRe.match(declaration);
+            bool isArray = false;
+            if (!sized.hasMatch())
+            {
+                sized = cArrayRe.match(declaration);
+                isArray = true;
+            }
+            int size = sized.hasMatch() ? sized.captured(3).toInt() : 0;
+            QString zero = sized.hasMatch() ? zeroLiteralForType(sized.captured(1)) : QString();
+            if (size <= 0 || zero.isEmpty())
+            {
+                continue;
+            }
+
+            QString name = sized.captured(2);
+            QStringList values;
+            for (int k = 0; k < size; ++k)
+            {
+                values.append(zero);
+            }
+            int next = i + 1;
+            for (; next < lines.size(); ++next)
+            {
+                QRegularExpressionMatch store = elementStoreRe.match(lines[next].trimmed());
+                if (!store.hasMatch() || store.captured(1) != name || store.captured(2).toInt() >= size || !isLiteral(store.captured(3)) ||
+                    !literalFitsType(store.captured(3), sized.captured(1)))
+                {
+                    break;
+                }
+                values[store.captured(2).toInt()] = store.captured(3);
+            }
+            if (next == i + 1)
+            {
+                continue;
+            }
+
+            QString indent = indentOf(lines[i]);
+            if (isArray)
+            {
+                lines.replace(i, QStringLiteral("%1%2 %3[%4] = {%5};").arg(indent, sized.captured(1), name).arg(size).arg(values.join(QStringLiteral(", "))));
+            }
+            else
+            {
+                lines.replace(i, QStringLiteral("%1std::vector<%2> %3 = {%4};").arg(indent, sized.captured(1), name, values.join(QStringLiteral(", "))));
+            }
+            for (int k = next - 1; k > i; --k)
+            {
+                lines.removeAt(k);
+            }
+            ++collapsed;
+        }
+
+        for (int start = 0; start < lines.size(); ++start)
+        {
+            QStringList order;
+            QMap<QString, QStringList> appended;
+            QMap<QString, int> origins;
+            QMap<QString, QString> elementTypes;
+            int next = start;
+            for (; next < lines.size(); ++next)
+            {
+                QRegularExpressionMatch push = pushBackRe.match(lines[next].trimmed());
+                if (!push.hasMatch() || !isLiteral(push.captured(2)) || indentOf(lines[next]) != indentOf(lines[start]))
+                {
+                    break;
+                }
+                if (!elementTypes.contains(push.captured(1)))
+                {
+                    elementTypes.insert(push.captured(1), vectorElementType(lines, push.captured(1)));
+                }
+                if (!literalFitsType(push.captured(2), elementTypes.value(push.captured(1))))
+                {
+                    break;
+                }
+                if (!appended.contains(push.captured(1)))
+                {
+                    order.append(push.captured(1));
+                    origins.insert(push.captured(1), lines.origin(next));
+                }
+                appended[push.captured(1)].append(push.captured(2));
+            }
+            if (next - start < 2)
+            {
+                continue;
+            }
+
+            QString indent = indentOf(lines[start]);
+            CodeLines replacement;
+            for (const QString &collection : order)
+            {
+                QString values = appended[collection].join(QStringLiteral(", "));
+                int declarationLine = -1;
+                for (int k = start - 1; k >= 0; --k)
+                {
+                    QRegularExpressionMatch empty = emptyVectorRe.match(lines[k].trimmed());
+                    if (empty.hasMatch() && empty.captured(2) == collection && indentOf(lines[k]) == indent)
+                    {
+                        declarationLine = k;
+                        break;
+                    }
+                    if (identifiersIn(lines[k]).contains(collection) || computeBlockDepths(lines.mid(k, start - k)).minimum.contains(-1))
+                    {
+                        break;
+                    }
+                }
+                if (declarationLine >= 0)
+                {
+                    lines.replace(declarationLine, QStringLiteral("%1std::vector<%2> %3 = {%4};").arg(indent, emptyVectorRe.match(lines[declarationLine].trimmed()).captured(1), collection, values));
+                }
+                else
+                {
+                    replacement.append(QStringLiteral("%1%2.insert(%2.end(), {%3});").arg(indent, collection, values), origins.value(collection));
+                }
+            }
+            for (int k = next - 1; k >= start; --k)
+            {
+                lines.removeAt(k);
+            }
+            for (int k = 0; k < replacement.size(); ++k)
+            {
+                lines.insert(start + k, replacement[k], replacement.origin(k));
+            }
+            start += replacement.size() - 1;
+            ++collapsed;
+        }
+        return collapsed;
+    }
+
+    QStringList splitOutsideLiterals(const QString &chain, const QString &separator)
+    {
+        QStringList parts;
+        QString current;
+        QChar quote;
+        for (int i = 0; i < chain.size(); ++i)
+        {
+            QChar ch = chain.at(i);
+            if (!quote.isNull())
+            {
+                current.append(ch);
+                if (ch == '\\' && i + 1 < chain.size())
+                {
+                    current.append(chain.at(++i));
+                }
+                else if (ch == quote)
+                {
+                    quote = QChar();
+                }
+                continue;
+            }
+            if (ch == '"' || ch == '\'')
+            {
+                quote = ch;
+            }
+            if (chain.mid(i, separator.size()) == separator)
+            {
+                parts.append(current.trimmed());
+                current.clear();
+                i += separator.size() - 1;
+                continue;
+            }
+            current.append(ch);
+        }
+        parts.append(current.trimmed());
+        return parts;
+    }
+
+    bool isStringLiteral(const QString &part)
+    {
+        static const QRegularExpression stringRe(QStringLiteral("^\"(?:[^\"\\\\]|\\\\.)*\"$"));
+        return stringRe.match(part).hasMatch();
+    }
+
+    QString joinedOutput(const QStringList &parts)
+    {
+        QStringList merged;
+        for (QString part : parts)
+        {
+            if (part == QStringLiteral("'\\n'"))
+            {
+                part = QStringLiteral("\"\\n\"");
+            }
+            if (isStringLiteral(part) && !merged.isEmpty() && isStringLiteral(merged.last()))
+            {
+                merged.last().chop(1);
+                merged.last().append(part.mid(1));
+            }
+            else
+            {
+                merged.append(part);
+            }
+        }
+        return QStringLiteral("std::cout << %1;").arg(merged.join(QStringLiteral(" << ")));
+    }
+
+    int coalesceOutputStatements(CodeLines &lines, bool &needsString)
+    {
+        static const QRegularExpression outputRe(QStringLiteral("^std::cout << (.+);$"));
+        static const QRegularExpression repeatRe(QStringLiteral("^for \\(int ([A-Za-z_]\\w*) = 0; \\1 < (\\d+); \\+\\+\\1\\) \\{$"));
+        const int inlineLimit = 4096;
+        int coalesced = 0;
+
+        for (int i = 0; i + 2 < lines.size(); ++i)
+        {
+            QRegularExpressionMatch repeat = repeatRe.match(lines[i].trimmed());
+            QRegularExpressionMatch output = outputRe.match(lines[i + 1].trimmed());
+            if (!repeat.hasMatch() || !output.hasMatch() || lines[i + 2].trimmed() != QStringLiteral("}"))
+            {
+                continue;
+            }
+            QStringList parts = splitOutsideLiterals(output.captured(1), QStringLiteral(" << "));
+            if (parts.size() != 2 || !isStringLiteral(parts[0]) || parts[1] != QStringLiteral("std::endl"))
+            {
+                continue;
+            }
+
+            int times = repeat.captured(2).toInt();
+            QString text = parts[0].mid(1, parts[0].size() - 2) + QStringLiteral("\\n");
+            QString indent = indentOf(lines[i]);
+            QStringList replacement;
+            if (times <= 0)
+            {
+                replacement.clear();
+            }
+            else if (text.size() * times <= inlineLimit)
+            {
+                QString repeated = text.repeated(times);
+                repeated.chop(2);
+                replacement << QStringLiteral("%1std::cout << \"%2\" << std::endl;").arg(indent, repeated);
+            }
+            else
+            {
+                QString buffer = unusedName(QStringLiteral("repeticion"), identifiersIn(lines.join('\n')));
+                QString counter = repeat.captured(1);
+                replacement << QStringLiteral("%1std::string %2;").arg(indent, buffer)
+                            << QStringLiteral("%1%2.reserve(%3);").arg(indent, buffer).arg(static_cast<long long>(text.size() - text.count('\\')) * times)
+                            << QStringLiteral("%1for (int %2 = 0; %2 < %3; ++%2) {").arg(indent, counter).arg(times)
+                            << QStringLiteral("%1    %2 += \"%3\";").arg(indent, buffer, text)
+                            << QStringLiteral("%1}").arg(indent)
+                            << QStringLiteral("%1std::cout << %2 << std::flush;").arg(indent, buffer);
+                needsString = true;
+            }
+            const int origin = lines.origin(i);
+            for (int k = 0; k < 3; ++k)
+            {
+                lines.removeAt(i);
+            }
+            for (int k = 0; k < replacement.size(); ++k)
+            {
+                lines.insert(i + k, replacement[k], origin);
+            }
+            ++coalesced;
+        }
+
+        for (int start = 0; start < lines.size(); ++start)
+        {
+            QString indent = indentOf(lines[start]);
+            QStringList parts;
+            int next = start;
+            for (; next < lines.size() && indentOf(lines[next]) == indent; ++next)
+            {
+                QRegularExpressionMatch output = outputRe.match(lines[next].trimmed());
+                if (!output.hasMatch())
+                {
+                    break;
+                }
+                parts.append(splitOutsideLiterals(output.captured(1), QStringLiteral(" << ")));
+            }
+            if (next - start < 2)
+            {
+                continue;
+            }
+
+            bool endsWithNewline = parts.last() == QStringLiteral("std::endl");
+            bool endsWithFlush = parts.last() == QStringLiteral("std::flush");
+            if (endsWithNewline)
+            {
+                parts.removeLast();
+            }
+            parts.removeAll(QStringLiteral("std::flush"));
+            for (QString &part : parts)
+            {
+                if (part == QStringLiteral("std::endl"))
+                {
+                    part = QStringLiteral("\"\\n\"");
+                }
+            }
+            if (endsWithNewline || endsWithFlush)
+            {
+                parts.append(endsWithNewline ? QStringLiteral("std::endl") : QStringLiteral("std::flush"));
+            }
+
+            for (int k = next - 1; k > start; --k)
+            {
+                lines.removeAt(k);
+            }
+            lines.replace(start, indent + joinedOutput(parts));
+            coalesced += next - start - 1;
+        }
+        return coalesced;
+    }
+
+    QString unescapedLiteral(const QString &literal)
+    {
+        QString text = literal.mid(1, literal.size() - 2);
+        QString result;
+        for (int i = 0; i < text.size(); ++i)
+        {
+            if (text.at(i) == '\\' && i + 1 < text.size())
+            {
+                QChar next = text.at(++i);
+                result.append(next == 'n' ? QChar('\n') : next);
+                continue;
+            }
+            result.append(text.at(i));
+        }
+        return result;
+    }
+
+    bool sortConstantValues(QStringList &values, const QString &type, bool descending)
+    {
+        if (type == QStringLiteral("std::string"))
+        {
+            for (const QString &value : values)
+            {
+                if (!isStringLiteral(value))
+                {
+                    return false;
+                }
+                for (const QChar &ch : value)
+                {
+                    if (ch.unicode() >= 0xD800)
+                    {
+                        return false;
+                    }
+                }
+            }
+            std::stable_sort(values.begin(), values.end(), [descending](const QString &a, const QString &b)
+                             { return descending ? unescapedLiteral(b) < unescapedLiteral(a) : unescapedLiteral(a) < unescapedLiteral(b); });
+            return true;
+        }
+        if (type != QStringLiteral("int") && type != QStringLiteral("double") && type != QStringLiteral("float"))
+        {
+            return false;
+        }
+        for (const QString &value : values)
+        {
+            bool ok = false;
+            QString(value).remove('f').toDouble(&ok);
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        std::stable_sort(values.begin(), values.end(), [descending](const QString &a, const QString &b)
+                         {
+                             double left = QString(a).remove('f').toDouble();
+                             double right = QString(b).remove('f').toDouble();
+                             return descending ? right < left : left < right; });
+        return true;
+    }
+
+    bool accumulateConstants(const QStringList &values, const QString &type, const QString &operation, QString &accumulator)
+    {
+        bool floating = type == QStringLiteral("double");
+        if (!floating && type != QStringLiteral("int"))
+        {
+            return false;
+        }
+        double real = accumulator.toDouble();
+        bool ok = true;
+        long long integer = accumulator.toLongLong(&ok);
+        if (!floating && !ok)
+        {
+            return false;
+        }
+        for (const QString &value : values)
+        {
+            if (floating)
+            {
+                double element = value.toDouble(&ok);
+                if (!ok)
+                {
+                    return false;
+                }
+                real = operation == QStringLiteral("+") ? real + element : operation == QStringLiteral("max") ? std::max(real, element) : std::min(real, element);
+                continue;
+            }
+            long long element = value.toLongLong(&ok);
+            if (!ok)
+            {
+                return false;
+            }
+            integer = operation == QStringLiteral("+") ? integer + element : operation == QStringLiteral("max") ? std::max(integer, element) : std::min(integer, element);
+            if (integer < std::numeric_limits<int>::min() || integer > std::numeric_limits<int>::max())
+            {
+                return false;
+            }
+        }
+        accumulator = floating ? numberLiteral(real, true) : numberLiteral(static_cast<double>(integer), false);
+        return floating ? std::isfinite(real) : true;
+    }
+
+    int evaluateConstantData(CodeLines &lines, QStringList &removedVectors)
+    {
+        static const QRegularExpression vectorRe(QStringLiteral("^std::vector<(.+)> ([A-Za-z_]\\w*) = \\{(.*)\\};$"));
+        static const QRegularExpression sortRe(QStringLiteral("^std::sort\\(([A-Za-z_]\\w*)\\.begin\\(\\), \\1\\.end\\(\\)(, \\[\\]\\([^)]*\\)\\{ return a > b; \\})?\\);$"));
+        static const QRegularExpression rangeLoopRe(QStringLiteral("^for \\(const [\\w:<>]+ &([A-Za-z_]\\w*) : ([A-Za-z_]\\w*)\\) \\{$"));
+        static const QRegularExpression accumulateRe(QStringLiteral("^([A-Za-z_]\\w*) (?:\\+= ([A-Za-z_]\\w*)|= std::(max|min)\\(\\1, ([A-Za-z_]\\w*)\\));$"));
+        static const QRegularExpression compoundRe(QStringLiteral("^([A-Za-z_]\\w*)\\s*([-+*/%])=(?!=)"));
+        static const QRegularExpression averageRe(QStringLiteral("^([A-Za-z_]\\w*)\\.empty\\(\\) \\? 0\\.0 : (.+)$"));
+        static const QRegularExpression sizeRe(QStringLiteral("static_cast<double>\\(([A-Za-z_]\\w*)\\.size\\(\\)\\)"));
+
+        struct ConstantVector
+        {
+            QString type;
+            QStringList values;
+            int declaration = -1;
+            bool read = false;
+        };
+        QMap<QString, ConstantVector> vectors;
+        QMap<QString, QString> scalars;
+        QMap<QString, QString> scalarTypes;
+        int evaluated = 0;
+
+        auto forgetWrites = [&](const QStringList &block)
+        {
+            for (const QString &name : scalars.keys())
+            {
+                if (linesMutateIdentifier(block, name))
+                {
+                    scalars.remove(name);
+                }
+            }
+            QSet<QString> mentioned = identifiersIn(block.join('\n'));
+            for (const QString &name : vectors.keys())
+            {
+                if (linesMutateIdentifier(block, name))
+                {
+                    vectors.remove(name);
+                }
+                else if (mentioned.contains(name))
+                {
+                    vectors[name].read = true;
+                }
+            }
+        };
+
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            QString statement = lines[i].trimmed();
+            QString indent = indentOf(lines[i]);
+
+            QRegularExpressionMatch vector = vectorRe.match(statement);
+            if (vector.hasMatch())
+            {
+                QStringList values = splitOutsideLiterals(vector.captured(3), QStringLiteral(", "));
+                bool constant = true;
+                for (const QString &value : values)
+                {
+                    constant = constant && isLiteral(value);
+                }
+                if (constant)
+                {
+                    vectors.insert(vector.captured(2), {vector.captured(1), values, i, false});
+                    continue;
+                }
+            }
+
+            QRegularExpressionMatch sort = sortRe.match(statement);
+            if (sort.hasMatch() && vectors.contains(sort.captured(1)))
+            {
+                ConstantVector &data = vectors[sort.captured(1)];
+                if (!sortConstantValues(data.values, data.type, !sort.captured(2).isEmpty()))
+                {
+                    vectors.remove(sort.captured(1));
+                    continue;
+                }
+                QString initializer = data.values.join(QStringLiteral(", "));
+                if (!data.read)
+                {
+                    lines.replace(data.declaration, QStringLiteral("%1std::vector<%2> %3 = {%4};").arg(indentOf(lines[data.declaration]), data.type, sort.captured(1), initializer));
+                    lines.removeAt(i--);
+                }
+                else
+                {
+                    lines.replace(i, QStringLiteral("%1%2 = {%3};").arg(indent, sort.captured(1), initializer));
+                }
+                ++evaluated;
+                continue;
+            }
+
+            QString code = withoutLiterals(statement);
+            if (code.count('{') > code.count('}'))
+            {
+                int end = blockEndLine(lines.texts(), i);
+                if (end < 0)
+                {
+                    break;
+                }
+                QRegularExpressionMatch loop = rangeLoopRe.match(statement);
+                if (loop.hasMatch() && vectors.contains(loop.captured(2)) && end > i + 1)
+                {
+                    const ConstantVector &data = vectors[loop.captured(2)];
+                    QStringList accumulators;
+                    QMap<QString, QString> results;
+                    QMap<QString, int> origins;
+                    bool foldable = true;
+                    for (int k = i + 1; k < end && foldable; ++k)
+                    {
+                        QRegularExpressionMatch step = accumulateRe.match(lines[k].trimmed());
+                        QString target = step.captured(1);
+                        QString element = step.captured(2).isEmpty() ? step.captured(4) : step.captured(2);
+                        QString operation = step.captured(3).isEmpty() ? QStringLiteral("+") : step.captured(3);
+                        foldable = step.hasMatch() && element == loop.captured(1) && scalars.contains(target) &&
+                                   !accumulators.contains(target) && scalarTypes.value(target) == data.type;
+                        if (foldable)
+                        {
+                            QString value = scalars.value(target);
+                            foldable = accumulateConstants(data.values, data.type, operation, value);
+                            accumulators.append(target);
+                            results.insert(target, value);
+                            origins.insert(target, lines.origin(k));
+                        }
+                    }
+                    if (foldable)
+                    {
+                        for (int k = end; k >= i; --k)
+                        {
+                            lines.removeAt(k);
+                        }
+                        for (int k = 0; k < accumulators.size(); ++k)
+                        {
+                            lines.insert(i + k, QStringLiteral("%1%2 = %3;").arg(indent, accumulators[k], results[accumulators[k]]), origins[accumulators[k]]);
+                            scalars.insert(accumulators[k], results[accumulators[k]]);
+                        }
+                        vectors[loop.captured(2)].read = true;
+                        i += accumulators.size() - 1;
+                        ++evaluated;
+                        continue;
+                    }
+                }
+                forgetWrites(lines.mid(i, end - i + 1));
+                i = end;
+                continue;
+            }
+
+            StoreStatement store;
+            if (!parseStoreStatement(lines[i], store))
+            {
+                forgetWrites({lines[i]});
+                continue;
+            }
+            QString target = store.target;
+            QString expression = store.value;
+            QRegularExpressionMatch compound = compoundRe.match(statement);
+            if (store.declaration)
+            {
+                scalarTypes.insert(target, store.declarationPrefix.left(store.declarationPrefix.size() - target.size()).trimmed().remove(QStringLiteral("const ")));
+            }
+            else if (compound.hasMatch())
+            {
+                expression = QStringLiteral("%1 %2 (%3)").arg(target, compound.captured(2), expression);
+            }
+            else if (expression.isEmpty())
+            {
+                expression = QStringLiteral("%1 %2 1").arg(target, statement.contains(QStringLiteral("++")) ? QStringLiteral("+") : QStringLiteral("-"));
+            }
+            const QMap<QString, QString> known = scalars;
+            scalars.remove(target);
+            vectors.remove(target);
+
+            QSet<QString> mentioned = identifiersIn(expression);
+            for (const QString &name : vectors.keys())
+            {
+                if (mentioned.contains(name))
+                {
+                    vectors[name].read = true;
+                }
+            }
+            QRegularExpressionMatch average = averageRe.match(expression);
+            if (average.hasMatch() && vectors.contains(average.captured(1)))
+            {
+                expression = vectors[average.captured(1)].values.isEmpty() ? QStringLiteral("0.0") : average.captured(2);
+            }
+            auto sizes = sizeRe.globalMatch(expression);
+            QString resolved = expression;
+            resolved.replace(QStringLiteral("std::numeric_limits<int>::lowest()"), QString::number(std::numeric_limits<int>::lowest()));
+            resolved.replace(QStringLiteral("std::numeric_limits<int>::max()"), QString::number(std::numeric_limits<int>::max()));
+            resolved.replace(QStringLiteral("std::numeric_limits<double>::lowest()"), numberLiteral(std::numeric_limits<double>::lowest(), true));
+            resolved.replace(QStringLiteral("std::numeric_limits<double>::max()"), numberLiteral(std::numeric_limits<double>::max(), true));
+            while (sizes.hasNext())
+            {
+                QRegularExpressionMatch size = sizes.next();
+                if (vectors.contains(size.captured(1)))
+                {
+                    resolved.replace(size.captured(0), QStringLiteral("%1.0").arg(vectors[size.captured(1)].values.size()));
+                }
+            }
+
+            QString type = scalarTypes.value(target);
+            ExpressionPtr tree = expression.isEmpty() ? nullptr : SpanishExpressionParser::parseGenerated(resolved);
+            ExpressionPtr folded = tree ? foldConstants(tree, known) : nullptr;
+            if (!folded || folded->kind != ExpressionNode::Kind::Number ||
+                (type != QStringLiteral("int") && type != QStringLiteral("double")) ||
+                (type == QStringLiteral("int") && folded->floating))
+            {
+                continue;
+            }
+            QString literal = type == QStringLiteral("double") ? numberLiteral(folded->text.toDouble(), true) : folded->text;
+            scalars.insert(target, literal);
+            // Un std::numeric_limits solo sirve para plegar; la línea conserva el nombre del límite.
+            if ((isLiteral(store.value) && store.value == literal) || expression.contains(QStringLiteral("std::numeric_limits")))
+            {
+                continue;
+            }
+            if (store.declaration)
+            {
+                lines.replace(i, QStringLiteral("%1%2 = %3;").arg(indent, store.declarationPrefix, literal));
+            }
+            else
+            {
+                lines.replace(i, QStringLiteral("%1%2 = %3;").arg(indent, target, literal));
+            }
+            ++evaluated;
+        }
+
+        QVector<QPair<int, QString>> unused;
+        for (auto it = vectors.constBegin(); it != vectors.constEnd(); ++it)
+        {
+            QStringList others = lines.texts();
+            others.removeAt(it.value().declaration);
+            if (!identifiersIn(others.join('\n')).contains(it.key()))
+            {
+                unused.append({it.value().declaration, it.key()});
+            }
+        }
+        std::sort(unused.begin(), unused.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b)
+                  { return a.first < b.first; });
+        for (int k = unused.size() - 1; k >= 0; --k)
+        {
+            lines.removeAt(unused[k].first);
+        }
+        for (const auto &entry : unused)
+        {
+            removedVectors.append(entry.second);
+        }
+        return evaluated;
+    }
+
+    struct SearchSite
+    {
+        int header = -1;
+        int end = -1;
+        QString index;
+        QString collection;
+        QString needle;
+        bool membership = false;
+        bool sorted = false;
+        QString hashIndex;
+    };
+
+    bool isIdempotentBody(const QStringList &body)
+    {
+        if (body.isEmpty() || linesHaveEffects(body))
+        {
+            return false;
+        }
+        QSet<QString> written = identifiersWritten(body);
+        for (const QString &line : body)
+        {
+            StoreStatement store;
+            if (!parseStoreStatement(line, store) || store.declaration ||
+                !line.trimmed().startsWith(store.target + QStringLiteral(" = ")) ||
+                identifiersIn(store.value).intersects(written))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int optimizeLinearSearches(CodeLines &lines, const QMap<QString, QString> &elementTypes, QSet<QString> &includes, QSet<int> &indexedOrigins)
+    {
+        static const QRegularExpression indexLoopRe(QStringLiteral("^for \\(std::size_t ([A-Za-z_]\\w*) = 0; \\1 < ([A-Za-z_]\\w*)\\.size\\(\\); \\+\\+\\1\\) \\{$"));
+        static const QRegularExpression ifRe(QStringLiteral("^if \\((.+)\\) \\{$"));
+        static const QRegularExpression needleRe(QStringLiteral("^(?:[A-Za-z_]\\w*|-?\\d+(?:\\.\\d+)?|\"(?:[^\"\\\\]|\\\\.)*\")$"));
+
+        QVector<SearchSite> sites;
+        for (int header = 0; header < lines.size(); ++header)
+        {
+            QRegularExpressionMatch loop = indexLoopRe.match(lines[header].trimmed());
+            int end = loop.hasMatch() ? blockEndLine(lines.texts(), header) : -1;
+            if (end < header + 3 || blockEndLine(lines.texts(), header + 1) != end - 1)
+            {
+                continue;
+            }
+            QRegularExpressionMatch condition = ifRe.match(lines[header + 1].trimmed());
+            if (!condition.hasMatch())
+            {
+                continue;
+            }
+
+            SearchSite site;
+            site.header = header;
+            site.end = end;
+            site.index = loop.captured(1);
+            site.collection = loop.captured(2);
+            QString element = QStringLiteral("%1[%2]").arg(site.collection, site.index);
+            QStringList operands = condition.captured(1).split(QStringLiteral(" == "));
+            if (operands.size() != 2 || (operands[0] != element && operands[1] != element))
+            {
+                continue;
+            }
+            site.needle = operands[0] == element ? operands[1] : operands[0];
+            if (!needleRe.match(site.needle).hasMatch() || site.needle == site.index || site.needle == site.collection)
+            {
+                continue;
+            }
+
+            QStringList body = lines.mid(header + 2, end - header - 3);
+            if (linesMutateIdentifier(body, site.collection) || linesMutateIdentifier(body, site.index) ||
+                identifiersWritten(body).contains(site.needle))
+            {
+                continue;
+            }
+            site.membership = !identifiersIn(body.join('\n')).contains(site.index) && isIdempotentBody(body);
+
+            for (int sortLine = header - 1; sortLine >= 0; --sortLine)
+            {
+                if (lines[sortLine].trimmed() != QStringLiteral("std::sort(%1.begin(), %1.end());").arg(site.collection))
+                {
+                    continue;
+                }
+                BlockDepths depths = computeBlockDepths(lines.texts());
+                int scopeEnd = outermostBlockEnd(lines.texts(), sortLine, header);
+                site.sorted = staysInScope(depths, sortLine, header) &&
+                              !linesMutateIdentifier(lines.mid(sortLine + 1, qMax(scopeEnd, end) - sortLine), site.collection);
+                break;
+            }
+            sites.append(site);
+        }
+
+        QMap<QString, QVector<int>> membershipSites;
+        for (int i = 0; i < sites.size(); ++i)
+        {
+            if (sites[i].membership && elementTypes.contains(sites[i].collection))
+            {
+                membershipSites[sites[i].collection].append(i);
+            }
+        }
+
+        QVector<QPair<int, CodeLines::Line>> indexDeclarations;
+        BlockDepths depths = computeBlockDepths(lines.texts());
+        for (auto it = membershipSites.constBegin(); it != membershipSites.constEnd(); ++it)
+        {
+            const QString &collection = it.key();
+            const QVector<int> &group = it.value();
+            int insertAt = sites[group.first()].header;
+            bool moved = true;
+            while (moved)
+            {
+                moved = false;
+                for (int header = insertAt - 1; header >= 0; --header)
+                {
+                    int end = blockEndLine(lines.texts(), header);
+                    if (end <= header || end < insertAt)
+                    {
+                        continue;
+                    }
+                    QString opener = lines[header].trimmed();
+                    if ((opener.startsWith(QStringLiteral("for (")) || opener.startsWith(QStringLiteral("while ("))) &&
+                        !linesMutateIdentifier(lines.mid(header, end - header + 1), collection))
+                    {
+                        insertAt = header;
+                        moved = true;
+                    }
+                    break;
+                }
+            }
+
+            bool valid = group.size() > 1 || insertAt != sites[group.first()].header;
+            int scopeEnd = insertAt;
+            for (int siteIndex : group)
+            {
+                const SearchSite &site = sites[siteIndex];
+                valid = valid && staysInScope(depths, insertAt, site.header);
+                scopeEnd = qMax(scopeEnd, qMax(site.end, outermostBlockEnd(lines.texts(), insertAt - 1, site.header)));
+            }
+            if (!valid || linesMutateIdentifier(lines.mid(insertAt, scopeEnd - insertAt + 1), collection))
+            {
+                continue;
+            }
+
+            QString name = unusedName(QStringLiteral("%1_indice").arg(collection), identifiersIn(lines.join('\n')));
+            for (int siteIndex : group)
+            {
+                sites[siteIndex].hashIndex = name;
+            }
+            const QString declaration = QStringLiteral("%1std::unordered_set<%2> %3(%4.begin(), %4.end());")
+                                            .arg(indentOf(lines[insertAt]), elementTypes.value(collection), name, collection);
+            indexDeclarations.append({insertAt, {declaration, lines.origin(sites[group.first()].header)}});
+            includes.insert(QStringLiteral("unordered_set"));
+        }
+
+        for (int i = sites.size() - 1; i >= 0; --i)
+        {
+            const SearchSite &site = sites[i];
+            if (!site.hashIndex.isEmpty() || site.sorted)
+            {
+                indexedOrigins.insert(lines.origin(site.header));
+            }
+            QString indent = indentOf(lines[site.header]);
+            QString begin = QStringLiteral("%1.begin()").arg(site.collection);
+            QString end = QStringLiteral("%1.end()").arg(site.collection);
+            QStringList body = lines.mid(site.header + 2, site.end - site.header - 3);
+            const int searchOrigin = lines.origin(site.header + 1);
+            QStringList replacement;
+            if (site.membership)
+            {
+                if (!site.hashIndex.isEmpty())
+                {
+                    replacement << QStringLiteral("%1if (%2.count(%3) > 0) {").arg(indent, site.hashIndex, site.needle);
+                }
+                else if (site.sorted)
+                {
+                    replacement << QStringLiteral("%1if (std::binary_search(%2, %3, %4)) {").arg(indent, begin, end, site.needle);
+                }
+                else
+                {
+                    replacement << QStringLiteral("%1if (std::find(%2, %3, %4) != %3) {").arg(indent, begin, end, site.needle);
+                }
+            }
+            else
+            {
+                QSet<QString> taken = identifiersIn(body.join('\n'));
+                taken.insert(site.collection);
+                taken.insert(site.needle);
+                QString iterator = unusedName(QStringLiteral("it"), taken);
+                if (site.sorted)
+                {
+                    replacement << QStringLiteral("%1for (auto %2 = std::lower_bound(%3, %4, %5); %2 != %4 && *%2 == %5; ++%2) {").arg(indent, iterator, begin, end, site.needle);
+                }
+                else
+                {
+                    replacement << QStringLiteral("%1for (auto %2 = std::find(%3, %4, %5); %2 != %4; %2 = std::find(%2 + 1, %4, %5)) {").arg(indent, iterator, begin, end, site.needle);
+                }
+                if (taken.contains(site.index))
+                {
+                    replacement << QStringLiteral("%1    std::size_t %2 = static_cast<std::size_t>(%3 - %4);").arg(indent, site.index, iterator, begin);
+                }
+            }
+            CodeLines rewritten;
+            rewritten.appendLines(replacement, searchOrigin);
+            for (int line = 0; line < body.size(); ++line)
+            {
+                rewritten.append(dedented(body[line]), lines.origin(site.header + 2 + line));
+            }
+            rewritten.append(QStringLiteral("%1}").arg(indent), lines.origin(site.end));
+
+            for (int line = site.end; line >= site.header; --line)
+            {
+                lines.removeAt(line);
+            }
+            for (int line = 0; line < rewritten.size(); ++line)
+            {
+                lines.insert(site.header + line, rewritten[line], rewritten.origin(line));
+            }
+            for (auto &declaration : indexDeclarations)
+            {
+                if (declaration.first > site.header)
+                {
+                    declaration.first += rewritten.size() - (site.end - site.header + 1);
+                }
+            }
+            if (site.hashIndex.isEmpty())
+            {
+                includes.insert(QStringLiteral("algorithm"));
+            }
+        }
+
+        std::sort(indexDeclarations.begin(), indexDeclarations.end(), [](const QPair<int, CodeLines::Line> &a, const QPair<int, CodeLines::Line> &b)
+                  { return a.first > b.first; });
+        for (const auto &declaration : indexDeclarations)
+        {
+            lines.insert(declaration.first, declaration.second);
+        }
+        return sites.size();
+    }
+
+    class InstructionParser
+    {
+    public:
+        explicit InstructionParser(const Parser::Input &input)
+            : m_input(input)
+        {
+            ensureInclude("iostream");
+            m_dataFileName = input.dataFileName.trimmed();
+            if (m_dataFileName.isEmpty())
+            {
+                m_dataFileName = QStringLiteral("datos.txt");
+            }
+        }
+
+        Parser::Output run()
+        {
+            const QStringList lines = splitLines(m_input.instructions);
+
+            bool needsDataFile = false;
+            for (const QString &rawLine : lines)
+            {
+                const KeywordMask keywords = KeywordScanner::instance().scan(normalizeLine(rawLine));
+                if (((keywords & (KeywordLeer | KeywordCargar | KeywordImportar)) && (keywords & (KeywordDatos | KeywordArchivo))) ||
+                    ((keywords & (KeywordImprimir | KeywordMostrar)) && hasAll(keywords, KeywordPaises | KeywordCapitales)))
+                {
+                    needsDataFile = true;
+                    break;
+                }
+            }
+
+            if (needsDataFile && m_input.dataFileContents.trimmed().isEmpty())
+            {
+                Parser::Output result;
+                result.code = QString();
+                result.issues.append(QStringLiteral("Error: Las instrucciones requieren un archivo de datos, pero no se ha cargado ninguno. Use el botón 'Cargar Datos' para cargar un archivo .txt antes de convertir."));
+                result.success = false;
+                return result;
+            }
+
+            planStructLayouts(lines);
+            collectReassignedVariables(lines);
+
+            const QStringList sourceLines = m_input.instructions.split(QRegularExpression("\\r\\n|\\r|\\n"));
+            for (int index = 0; index < sourceLines.size(); ++index)
+            {
+                const QString &rawLine = sourceLines[index];
+                QString trimmed = rawLine.trimmed();
+                if (trimmed.isEmpty())
+                {
+                    continue;
+                }
+                m_sourceLine = index;
+
+                int leadingSpaces = rawLine.indexOf(trimmed);
+                if (leadingSpaces < 0)
+                    leadingSpaces = 0;
+                QString normalized = normalizeLine(trimmed);
+
+                bool isSino = normalized.startsWith(QStringLiteral("sino"));
+                if (!isSino)
+                {
+                    closeAutoBlocks(leadingSpaces);
+                }
+
+                m_currentIndent = leadingSpaces;
+
+                if (!processLine(trimmed, normalized))
+                {
+                    m_success = false;
+                    m_issues.append(QStringLiteral("Instrucción no reconocida: %1").arg(trimmed));
+                }
+            }
+
+            closeAutoBlocks(0);
+            closeAllBlocks();
+
+            if (m_foldedExpressions > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se precalcularon %1 expresiones constantes durante la conversión.").arg(m_foldedExpressions));
+            }
+
+            moveLastUseArguments();
+            collapseInitializers();
+            evaluateConstants();
+            eliminateDeadCode();
+            canonicalizeLoops();
+            optimizeSearches();
+            hoistCollectionLoopBounds();
+            fuseAggregateLoops();
+            coalesceOutput();
+            dropUnusedLimitsInclude();
+
+            if (m_input.profile)
+            {
+                ensureInclude("chrono");
+                ensureInclude("fstream");
+            }
+
+            QStringList includeList = m_includes.values();
+            std::sort(includeList.begin(), includeList.end());
+            QStringList includeLines;
+            if (m_input.umbrellaHeader)
+            {
+                includeLines << QStringLiteral("#include \"%1\"").arg(Parser::umbrellaHeaderName());
+            }
+            else
+            {
+                for (const QString &inc : includeList)
+                {
+                    includeLines << QStringLiteral("#include <%1>").arg(inc);
+                }
+            }
+
+            CodeLines output;
+            output.appendLines(includeLines, -1);
+            output.append(QString(), -1);
+            QStringList profileLines;
+            if (m_input.profile)
+            {
+                profileLines = profileSupport(sourceLines.size());
+                output.appendLines(profileLines, -1);
+            }
+
+            QStringList structLines;
+            for (auto it = m_structs.constBegin(); it != m_structs.constEnd(); ++it)
+            {
+                const StructInfo &structInfo = it.value();
+                const int first = structLines.size();
+                if (structInfo.structOfArrays)
+                {
+                    emitStructOfArrays(structInfo, structLines);
+                }
+                else
+                {
+                    emitStruct(structInfo, structLines);
+                }
+                output.appendLines(structLines.mid(first), structInfo.sourceLine);
+            }
+
+            QStringList signatures;
+            QList<CodeLines> bodies;
+            for (auto it = m_functions.constBegin(); it != m_functions.constEnd(); ++it)
+            {
+                const FunctionInfo &func = it.value();
+                signatures << functionSignature(func);
+                bodies << (m_input.profile ? instrumentLines(func.body) : func.body);
+                output.append(signatures.last() + QStringLiteral(" {"), func.sourceLine);
+                output.appendLines(bodies.last());
+                output.append(QStringLiteral("}"), func.sourceLine);
+                output.append(QString(), -1);
+            }
+
+            CodeLines mainBody;
+            if (!m_startupLines.isEmpty())
+            {
+                for (int i = 0; i < m_startupLines.size(); ++i)
+                {
+                    const auto &line = m_startupLines[i];
+                    mainBody.append(QStringLiteral("%1%2").arg(QStringLiteral("    ").repeated(line.first), line.second), m_startupOrigins[i]);
+                }
+                if (!m_codeLines.isEmpty())
+                {
+                    mainBody.append(QString(), -1);
+                }
+            }
+            mainBody.appendLines(m_codeLines);
+
+            CodeLines mainLines;
+            mainLines.append(QStringLiteral("int main() {"), -1);
+            mainLines.appendLines(m_input.profile ? instrumentLines(mainBody) : mainBody);
+            mainLines.append(QStringLiteral("    return 0;"), -1);
+            mainLines.append(QStringLiteral("}"), -1);
+            output.append(QString(), -1);
+            output.appendLines(mainLines);
+
+            Parser::Output result;
+            result.code = output.join('\n');
+            result.sourceLines = output.origins();
+            result.generatedLines.fill(-1, sourceLines.size());
+            for (int i = 0; i < output.size(); ++i)
+            {
+                const int origin = output.origin(i);
+                if (origin >= 0 && origin < result.generatedLines.size() && result.generatedLines[origin] < 0)
+                {
+                    result.generatedLines[origin] = i;
+                }
+            }
+            if (m_input.multipleFiles)
+            {
+                result.files = splitIntoFiles(includeLines + profileLines, signatures, bodies, structLines, mainLines.texts());
+            }
+            result.issues = m_issues;
+            result.optimizationNotes = m_optimizationNotes;
+            result.diagnostics = m_diagnostics;
+            result.includes = includeList;
+            result.success = m_success;
+            return result;
+        }
+
+    private:
+        // marcar(línea) suma una ejecución y atribuye a la línea el tiempo hasta la siguiente marca.
+        QStringList profileSupport(int lineCount) const
+        {
+            const QString size = QString::number(lineCount + 1);
+            QStringList lines;
+            lines << QStringLiteral("namespace instacode_perfil {")
+                  << QStringLiteral("struct Perfil {")
+                  << QStringLiteral("    unsigned long long cuentas[%1] = {};").arg(size)
+                  << QStringLiteral("    unsigned long long nanosegundos[%1] = {};").arg(size)
+                  << QStringLiteral("    int actual = 0;")
+                  << QStringLiteral("    std::chrono::steady_clock::time_point anterior = std::chrono::steady_clock::now();")
+                  << QString()
+                  << QStringLiteral("    void marcar(int linea) {")
+                  << QStringLiteral("        const auto ahora = std::chrono::steady_clock::now();")
+                  << QStringLiteral("        nanosegundos[actual] += std::chrono::duration_cast<std::chrono::nanoseconds>(ahora - anterior).count();")
+                  << QStringLiteral("        anterior = ahora;")
+                  << QStringLiteral("        actual = linea;")
+                  << QStringLiteral("        ++cuentas[linea];")
+                  << QStringLiteral("    }")
+                  << QString()
+                  << QStringLiteral("    ~Perfil() {")
+                  << QStringLiteral("        marcar(0);")
+                  << QStringLiteral("        std::ofstream salida(\"%1\");").arg(Parser::profileFileName())
+                  << QStringLiteral("        for (int i = 1; i < %1; ++i) {").arg(size)
+                  << QStringLiteral("            if (cuentas[i] > 0) {")
+                  << QStringLiteral("                salida << i << ' ' << cuentas[i] << ' ' << nanosegundos[i] << '\\n';")
+                  << QStringLiteral("            }")
+                  << QStringLiteral("        }")
+                  << QStringLiteral("    }")
+                  << QStringLiteral("};")
+                  << QStringLiteral("inline Perfil perfil;")
+                  << QStringLiteral("}")
+                  << QString();
+            return lines;
+        }
+
+        static bool opensStatementScope(const QString &trimmed)
+        {
+            static const QRegularExpression headerRe(QStringLiteral("^(?:if|for|while|switch|else|\\} else|do)\\b.*\\{$"));
+            return trimmed == QStringLiteral("{") || headerRe.match(trimmed).hasMatch();
+        }
+
+        // Cada instrucción se marca una vez por ejecución, y solo donde empieza una sentencia.
+        static CodeLines instrumentLines(const CodeLines &lines)
+        {
+            CodeLines result;
+            QVector<int> headerMarks;
+            int marked = -1;
+            bool atStatementStart = true;
+            for (int i = 0; i < lines.size(); ++i)
+            {
+                const QString &line = lines[i];
+                const QString trimmed = line.trimmed();
+                const int origin = lines.origin(i);
+                if (trimmed.isEmpty() || trimmed.startsWith(QStringLiteral("//")) || trimmed.startsWith('#'))
+                {
+                    result.append(line, origin);
+                    continue;
+                }
+                const bool continuesBlock = trimmed.startsWith('}') || trimmed.startsWith(QStringLiteral("else"));
+                if (trimmed.startsWith('}') && !headerMarks.isEmpty())
+                {
+                    marked = headerMarks.takeLast();
+                }
+                if (origin >= 0 && origin != marked && atStatementStart && !continuesBlock)
+                {
+                    const QString lineIndent = line.left(line.indexOf(trimmed));
+                    result.append(lineIndent + QStringLiteral("instacode_perfil::perfil.marcar(%1);").arg(origin + 1), origin);
+                    marked = origin;
+                }
+                result.append(line, origin);
+                if (trimmed.endsWith('{'))
+                {
+                    headerMarks.append(marked);
+                }
+                atStatementStart = trimmed.endsWith(';') || trimmed.endsWith('}') || opensStatementScope(trimmed);
+            }
+            return result;
+        }
+
+        QString functionSignature(const FunctionInfo &func) const
+        {
+            QString signature = QStringLiteral("%1 %2(").arg(func.returnType, func.name);
+            for (int i = 0; i < func.parameterTypes.size(); ++i)
+            {
+                if (i > 0)
+                    signature += QStringLiteral(", ");
+                if (passesByConstReference(func, i))
+                {
+                    signature += QStringLiteral("const %1 &%2").arg(func.parameterTypes[i], func.parameterNames[i]);
+                }
+                else
+                {
+                    signature += QStringLiteral("%1 %2").arg(func.parameterTypes[i], func.parameterNames[i]);
+                }
+            }
+            return signature + QStringLiteral(")");
+        }
+
+        QList<Parser::SourceFile> splitIntoFiles(const QStringList &includeLines,
+                                                 const QStringList &signatures,
+                                                 const QList<CodeLines> &bodies,
+                                                 const QStringList &structLines,
+                                                 QStringList mainLines) const
+        {
+            static const QRegularExpression tableRe(QStringLiteral("^    std::vector<(.+)> ([A-Za-z_]\\w*) = \\{(.*)\\};$"));
+            const QString headerName = QStringLiteral("programa.h");
+            const QString includeHeader = QStringLiteral("#include \"%1\"").arg(headerName);
+
+            QList<Parser::SourceFile> files;
+            QStringList declarations;
+            QStringList objects;
+
+            auto addSource = [&](const QString &name, const QStringList &body) {
+                files.append({name, (QStringList() << includeHeader << QString() << body).join('\n') + QLatin1Char('\n')});
+                objects << QString(name).replace(QStringLiteral(".cpp"), QStringLiteral(".o"));
+            };
+
+            int index = 0;
+            for (auto it = m_functions.constBegin(); it != m_functions.constEnd(); ++it, ++index)
+            {
+                declarations << signatures[index] + QLatin1Char(';');
+                QStringList body;
+                body << signatures[index] + QStringLiteral(" {") << bodies[index].texts() << QStringLiteral("}");
+                addSource(QStringLiteral("funcion_%1.cpp").arg(it.key()), body);
+            }
+
+            for (QString &line : mainLines)
+            {
+                const QRegularExpressionMatch table = tableRe.match(line);
+                if (!table.hasMatch())
+                {
+                    continue;
+                }
+                const QString type = QStringLiteral("std::vector<%1>").arg(table.captured(1));
+                const QString loader = QStringLiteral("datos_%1").arg(table.captured(2));
+                declarations << QStringLiteral("%1 %2();").arg(type, loader);
+                QStringList body;
+                body << QStringLiteral("%1 %2() {").arg(type, loader)
+                     << QStringLiteral("    return {%1};").arg(table.captured(3))
+                     << QStringLiteral("}");
+                addSource(loader + QStringLiteral(".cpp"), body);
+                line = QStringLiteral("    %1 %2 = %3();").arg(type, table.captured(2), loader);
+            }
+            addSource(QStringLiteral("main.cpp"), mainLines);
+
+            QStringList header;
+            header << QStringLiteral("#ifndef PROGRAMA_H") << QStringLiteral("#define PROGRAMA_H") << QString()
+                   << includeLines << QString() << structLines;
+            if (!declarations.isEmpty())
+            {
+                header << declarations << QString();
+            }
+            header << QStringLiteral("#endif");
+            files.prepend({headerName, header.join('\n') + QLatin1Char('\n')});
+
+            QStringList makefile;
+            makefile << QStringLiteral("CXX ?= g++")
+                     << QStringLiteral("CXXFLAGS ?= -std=c++17 -O2")
+                     << QStringLiteral("OBJS = %1").arg(objects.join(QLatin1Char(' ')))
+                     << QString()
+                     << QStringLiteral("programa: $(OBJS)")
+                     << QStringLiteral("\t$(CXX) $(CXXFLAGS) -o $@ $(OBJS)")
+                     << QString()
+                     << QStringLiteral("%.o: %.cpp %1").arg(headerName)
+                     << QStringLiteral("\t$(CXX) $(CXXFLAGS) -c $< -o $@")
+                     << QString()
+                     << QStringLiteral("clean:")
+                     << QStringLiteral("\trm -f programa $(OBJS)");
+            files.append({QStringLiteral("Makefile"), makefile.join('\n') + QLatin1Char('\n')});
+            return files;
+        }
+
+        static bool passesByConstReference(const FunctionInfo &func, int index)
+        {
+            if (isScalarType(func.parameterTypes[index]))
+            {
+                return false;
+            }
+            return !linesMutateIdentifier(func.body.texts(), func.parameterNames[index]);
+        }
+
+        void moveLastUseArguments()
+        {
+            for (const CallSite &call : m_callSites)
+            {
+                if (call.insideLoop || !m_functions.contains(call.functionName))
+                {
+                    continue;
+                }
+
+                const FunctionInfo &func = m_functions[call.functionName];
+                QStringList arguments = call.arguments;
+                bool changed = false;
+                for (int i = 0; i < arguments.size() && i < func.parameterTypes.size(); ++i)
+                {
+                    const QString &argument = arguments[i];
+                    if (isScalarType(func.parameterTypes[i]) || passesByConstReference(func, i))
+                    {
+                        continue;
+                    }
+                    if (!hasVariable(argument) && !hasCollection(argument))
+                    {
+                        continue;
+                    }
+                    if (arguments.count(argument) > 1 ||
+                        linesUseIdentifier(m_codeLines.mid(call.line + 1), argument))
+                    {
+                        continue;
+                    }
+                    arguments[i] = QStringLiteral("std::move(%1)").arg(argument);
+                    changed = true;
+                }
+
+                if (changed)
+                {
+                    ensureInclude("utility");
+                    QString callText = QStringLiteral("%1(%2)").arg(call.functionName, call.arguments.join(QStringLiteral(", ")));
+                    m_codeLines.replace(call.line, QString(m_codeLines[call.line]).replace(callText, QStringLiteral("%1(%2)").arg(call.functionName, arguments.join(QStringLiteral(", ")))));
+                }
+            }
+        }
+
+        void eliminateDeadCode()
+        {
+            QSet<QString> pureFunctions;
+            for (auto it = m_functions.constBegin(); it != m_functions.constEnd(); ++it)
+            {
+                if (!hasSideEffects(it.value().body.join('\n')) && !it.value().body.join('\n').contains(QStringLiteral("std::cout")))
+                {
+                    pureFunctions.insert(it.key());
+                }
+            }
+
+            QStringList removedVariables;
+            int removedStores = eliminateDeadStores(m_codeLines, pureFunctions, removedVariables);
+            for (auto it = m_functions.begin(); it != m_functions.end(); ++it)
+            {
+                removedStores += eliminateDeadStores(it.value().body, pureFunctions, removedVariables);
+            }
+
+            if (!removedVariables.isEmpty())
+            {
+                m_optimizationNotes.append(QStringLiteral("Se eliminaron variables sin uso: %1.").arg(removedVariables.join(QStringLiteral(", "))));
+            }
+            if (removedStores > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se eliminaron %1 asignaciones cuyo valor nunca se leía.").arg(removedStores));
+            }
+        }
+
+        void canonicalizeLoops()
+        {
+            int converted = canonicalizeCountingLoops(m_codeLines);
+            for (auto it = m_functions.begin(); it != m_functions.end(); ++it)
+            {
+                converted += canonicalizeCountingLoops(it.value().body);
+            }
+            if (converted > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se convirtieron %1 ciclos while con contador en ciclos for.").arg(converted));
+            }
+        }
+
+        void optimizeSearches()
+        {
+            QMap<QString, QString> elementTypes;
+            for (auto it = m_collections.constBegin(); it != m_collections.constEnd(); ++it)
+            {
+                if (!it.value().isCArray && !it.value().elementType.isEmpty())
+                {
+                    elementTypes.insert(it.key(), it.value().elementType);
+                }
+            }
+            QSet<int> indexedOrigins;
+            int searches = optimizeLinearSearches(m_codeLines, elementTypes, m_includes, indexedOrigins);
+            for (auto it = m_functions.begin(); it != m_functions.end(); ++it)
+            {
+                searches += optimizeLinearSearches(it.value().body, QMap<QString, QString>(), m_includes, indexedOrigins);
+            }
+            for (int i = m_diagnostics.size() - 1; i >= 0; --i)
+            {
+                if (m_diagnostics[i].kind == Parser::DiagnosticKind::SearchInLoop && indexedOrigins.contains(m_diagnostics[i].line))
+                {
+                    m_diagnostics.removeAt(i);
+                }
+            }
+            if (searches > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se reemplazaron %1 búsquedas lineales por std::find, búsqueda binaria o un índice hash.").arg(searches));
+            }
+        }
+
+        void hoistCollectionLoopBounds()
+        {
+            int rangeLoops = 0;
+            int hoisted = hoistLoopBounds(m_codeLines, rangeLoops);
+            for (auto it = m_functions.begin(); it != m_functions.end(); ++it)
+            {
+                hoisted += hoistLoopBounds(it.value().body, rangeLoops);
+            }
+            if (hoisted + rangeLoops > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se fijó el límite de %1 ciclos sobre colecciones que no cambian de tamaño (%2 convertidos a for por rango).").arg(hoisted + rangeLoops).arg(rangeLoops));
+            }
+        }
+
+        void fuseAggregateLoops()
+        {
+            int fused = fuseCollectionLoops(m_codeLines);
+            for (auto it = m_functions.begin(); it != m_functions.end(); ++it)
+            {
+                fused += fuseCollectionLoops(it.value().body);
+            }
+            if (fused > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se fusionaron %1 recorridos sobre la misma colección en una sola pasada.").arg(fused));
+            }
+        }
+
+        void collapseInitializers()
+        {
+            int collapsed = collapseElementInitializers(m_codeLines);
+            for (auto it = m_functions.begin(); it != m_functions.end(); ++it)
+            {
+                collapsed += collapseElementInitializers(it.value().body);
+            }
+            if (collapsed > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se agruparon %1 secuencias de asignaciones de elementos en listas de inicialización.").arg(collapsed));
+            }
+        }
+
+        void coalesceOutput()
+        {
+            bool needsString = false;
+            int coalesced = coalesceOutputStatements(m_codeLines, needsString);
+            for (auto it = m_functions.begin(); it != m_functions.end(); ++it)
+            {
+                coalesced += coalesceOutputStatements(it.value().body, needsString);
+            }
+            if (needsString)
+            {
+                ensureInclude("string");
+            }
+            if (coalesced > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se combinaron %1 instrucciones de salida en escrituras agrupadas.").arg(coalesced));
+            }
+        }
+
+        void dropUnusedLimitsInclude()
+        {
+            bool used = m_codeLines.join('\n').contains(QStringLiteral("std::numeric_limits"));
+            for (auto it = m_functions.constBegin(); it != m_functions.constEnd() && !used; ++it)
+            {
+                used = it.value().body.join('\n').contains(QStringLiteral("std::numeric_limits"));
+            }
+            if (!used)
+            {
+                m_includes.remove(QStringLiteral("limits"));
+            }
+        }
+
+        void evaluateConstants()
+        {
+            QStringList removedVectors;
+            int evaluated = evaluateConstantData(m_codeLines, removedVectors);
+            for (auto it = m_functions.begin(); it != m_functions.end(); ++it)
+            {
+                evaluated += evaluateConstantData(it.value().body, removedVectors);
+            }
+            if (evaluated > 0)
+            {
+                m_optimizationNotes.append(QStringLiteral("Se evaluaron %1 operaciones sobre datos constantes durante la conversión.").arg(evaluated));
+            }
+            if (!removedVectors.isEmpty())
+            {
+                m_optimizationNotes.append(QStringLiteral("Se eliminaron listas constantes sin uso: %1.").arg(removedVectors.join(QStringLiteral(", "))));
+            }
+        }
+
+        static bool linesUseIdentifier(const QStringList &lines, const QString &name)
+        {
+            QRegularExpression useRe(QStringLiteral("(?:^|[^\\w.])%1\\b").arg(QRegularExpression::escape(name)));
+            for (const QString &line : lines)
+            {
+                if (useRe.match(line).hasMatch())
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void emitFunctionCall(const QString &varName, const QString &funcName, const QStringList &arguments)
+        {
+            QString callText = QStringLiteral("%1(%2)").arg(funcName, arguments.join(QStringLiteral(", ")));
+            if (!hasVariable(varName))
+            {
+                QString returnType = hasFunction(funcName) ? m_functions[funcName].returnType : QStringLiteral("int");
+                addCodeLine(QStringLiteral("%1 %2 = %3;").arg(returnType, varName, callText));
+                registerVariable(varName, returnType, false);
+            }
+            else
+            {
+                addCodeLine(QStringLiteral("%1 = %2;").arg(varName, callText));
+            }
+
+            bool insideLoop = false;
+            for (const BlockState &block : m_blocks)
+            {
+                insideLoop = insideLoop || block.type == BlockType::Loop;
+            }
+            m_callSites.append({m_codeLines.size() - 1, funcName, arguments, insideLoop});
+        }
+
+        void collectReassignedVariables(const QStringList &lines)
+        {
+            const QRegularExpression patterns[] = {
+                QRegularExpression(QStringLiteral("^asignar valor a ([a-zA-Z_][a-zA-Z0-9_]*) con llamar funcion")),
+                QRegularExpression(QStringLiteral("^calcular .+ y asignar (?:a|al) (.+)$")),
+                QRegularExpression(QStringLiteral("^ingresar(?: valor| los valores)? (.+)$")),
+                QRegularExpression(QStringLiteral("^([a-zA-Z_][a-zA-Z0-9_]*) (?:multiplicar por|restar) ")),
+                QRegularExpression(QStringLiteral("sumar cada elemento (?:al|en) (.+)$")),
+                QRegularExpression(QStringLiteral("^mientras el ([a-zA-Z_]+) sea "))};
+
+            for (const QString &rawLine : lines)
+            {
+                QString normalized = normalizeLine(rawLine);
+                if (normalized.endsWith('.'))
+                {
+                    normalized.chop(1);
+                }
+
+                for (const QRegularExpression &pattern : patterns)
+                {
+                    QRegularExpressionMatch match = pattern.match(normalized);
+                    if (match.hasMatch())
+                    {
+                        m_reassignedVariables.insert(sanitizedIdentifier(match.captured(1)));
+                    }
+                }
+
+                if (normalized.startsWith(QStringLiteral("asignar")))
+                {
+                    int toIdx = normalized.lastIndexOf(QStringLiteral(" a "));
+                    int width = 3;
+                    if (toIdx < 0)
+                    {
+                        toIdx = normalized.lastIndexOf(QStringLiteral(" al "));
+                        width = 4;
+                    }
+                    if (toIdx >= 0)
+                    {
+                        QString target = normalized.mid(toIdx + width).trimmed();
+                        if (target.startsWith(QStringLiteral("valor de ")))
+                        {
+                            target = target.mid(QStringLiteral("valor de ").size());
+                        }
+                        m_reassignedVariables.insert(sanitizedIdentifier(target));
+                    }
+                }
             }
         }
 
-        Parser::Output run()
+        QString foldTree(const ExpressionPtr &root)
         {
-            const QStringList lines = splitLines(m_input.instructions);
+            return printExpression(foldOperands(root));
+        }
 
-            bool needsDataFile = false;
-            for (const QString &rawLine : lines)
+        ExpressionPtr foldOperands(const ExpressionPtr &node)
+        {
+            const bool logical = (node->kind == ExpressionNode::Kind::Binary &&
+                                  binaryPrecedence(node->text) <= binaryPrecedence(QStringLiteral("<"))) ||
+                                 (node->kind == ExpressionNode::Kind::Unary && node->text == QStringLiteral("!"));
+            if (logical)
             {
-                QString normalized = normalizeLine(rawLine);
-                if ((normalized.contains(QStringLiteral("leer")) && (normalized.contains(QStringLiteral("datos")) || normalized.contains(QStringLiteral("archivo")))) ||
-                    (normalized.contains(QStringLiteral("cargar")) && (normalized.contains(QStringLiteral("datos")) || normalized.contains(QStringLiteral("archivo")))) ||
-                    (normalized.contains(QStringLiteral("importar")) && (normalized.contains(QStringLiteral("datos")) || normalized.contains(QStringLiteral("archivo")))) ||
-                    ((normalized.contains(QStringLiteral("imprimir")) || normalized.contains(QStringLiteral("mostrar"))) &&
-                     normalized.contains(QStringLiteral("paises")) && normalized.contains(QStringLiteral("capitales"))))
+                const int foldedBefore = m_foldedExpressions;
+                auto copy = std::make_shared<ExpressionNode>(*node);
+                copy->left = foldOperands(node->left);
+                if (node->right)
                 {
-                    needsDataFile = true;
-                    break;
+                    copy->right = foldOperands(node->right);
+                }
+                if (ExpressionPtr simplified = foldLogical(copy))
+                {
+                    if (isBooleanLiteral(simplified))
+                    {
+                        m_foldedExpressions = foldedBefore + 1;
+                    }
+                    return simplified;
                 }
+                return copy;
+            }
+            ExpressionPtr folded = foldConstants(node, m_constantValues.value(m_currentFunctionName));
+            if (folded->kind == ExpressionNode::Kind::Number && node->kind != ExpressionNode::Kind::Number)
+            {
+                ++m_foldedExpressions;
             }
+            return folded;
+        }
 
-            if (needsDataFile && m_input.dataFileContents.trimmed().isEmpty())
+        void planStructLayouts(const QStringList &lines)
+        {
+            if (m_input.structLayout == Parser::StructLayout::ArrayOfStructs)
             {
-                Parser::Output result;
-                result.code = QString();
-                result.issues.append(QStringLiteral("Error: Las instrucciones requieren un archivo de datos, pero no se ha cargado ninguno. Use el botón 'Cargar Datos' para cargar un archivo .txt antes de convertir."));
-                result.success = false;
-                return result;
+                return;
             }
 
+            QRegularExpression structRe(QStringLiteral("^crear estructura ([a-zA-Z_][a-zA-Z0-9_]*) con (.+)$"));
+            QRegularExpression fieldRe(QStringLiteral("([a-zA-Z_][a-zA-Z0-9_]*) \\(([^)]+)\\)"));
+            QRegularExpression iterRe(QStringLiteral("^recorrer la lista y mostrar (.+)$"));
+
+            QMap<QString, int> fieldCounts;
+            QSet<QString> signatureWords;
+            int widestIteration = 0;
+            bool hasFieldIteration = false;
             for (const QString &rawLine : lines)
             {
-                QString trimmed = rawLine.trimmed();
-                if (trimmed.isEmpty())
+                QString normalized = normalizeLine(rawLine);
+                if (normalized.endsWith('.'))
                 {
-                    continue;
+                    normalized.chop(1);
                 }
 
-                int leadingSpaces = rawLine.indexOf(trimmed);
-                if (leadingSpaces < 0)
-                    leadingSpaces = 0;
-                QString normalized = normalizeLine(trimmed);
+                QRegularExpressionMatch structMatch = structRe.match(normalized);
+                if (structMatch.hasMatch())
+                {
+                    int count = 0;
+                    QRegularExpressionMatchIterator fieldIt = fieldRe.globalMatch(structMatch.captured(2));
+                    while (fieldIt.hasNext())
+                    {
+                        fieldIt.next();
+                        ++count;
+                    }
+                    fieldCounts.insert(structMatch.captured(1).trimmed(), count);
+                    continue;
+                }
 
-                bool isSino = normalized.startsWith(QStringLiteral("sino"));
-                if (!isSino)
+                if (normalized.startsWith(QStringLiteral("definir funcion ")))
                 {
-                    closeAutoBlocks(leadingSpaces);
+                    const QStringList words = normalized.split(' ');
+                    signatureWords.unite(QSet<QString>(words.begin(), words.end()));
+                    continue;
                 }
 
-                m_currentIndent = leadingSpaces;
+                QRegularExpressionMatch iterMatch = iterRe.match(normalized);
+                if (iterMatch.hasMatch())
+                {
+                    hasFieldIteration = true;
+                    widestIteration = qMax(widestIteration, static_cast<int>(iterMatch.captured(1).split(QStringLiteral(" y ")).size()));
+                }
+            }
 
-                if (!processLine(trimmed, normalized))
+            for (auto it = fieldCounts.constBegin(); it != fieldCounts.constEnd(); ++it)
+            {
+                bool useColumns = m_input.structLayout == Parser::StructLayout::StructOfArrays ||
+                                  (hasFieldIteration && widestIteration < it.value() && !signatureWords.contains(it.key()));
+                if (useColumns)
                 {
-                    m_success = false;
-                    m_issues.append(QStringLiteral("Instrucción no reconocida: %1").arg(trimmed));
+                    m_structOfArrays.insert(it.key());
                 }
             }
+        }
 
-            closeAutoBlocks(0);
-            closeAllBlocks();
+        static QString structOfArraysTypeName(const QString &structName)
+        {
+            return QStringLiteral("%1_columnas").arg(structName);
+        }
 
-            QStringList output;
-            QStringList includeList = m_includes.values();
-            std::sort(includeList.begin(), includeList.end());
-            for (const QString &inc : includeList)
+        static QString structFieldAccess(const StructInfo &structInfo,
+                                         const QString &collection,
+                                         const QString &index,
+                                         const QString &field)
+        {
+            if (structInfo.structOfArrays)
             {
-                output << QStringLiteral("#include <%1>").arg(inc);
+                return QStringLiteral("%1.%2[%3]").arg(collection, field, index);
             }
-            output << QString();
+            return QStringLiteral("%1[%2].%3").arg(collection, index, field);
+        }
 
-            for (auto it = m_functions.constBegin(); it != m_functions.constEnd(); ++it)
+        void emitStruct(const StructInfo &structInfo, QStringList &output)
+        {
+            QVector<int> declaredOrder;
+            for (int i = 0; i < structInfo.fieldNames.size() && i < structInfo.fieldTypes.size(); ++i)
             {
-                const FunctionInfo &func = it.value();
-                QString signature = QStringLiteral("%1 %2(").arg(func.returnType, func.name);
-                for (int i = 0; i < func.parameterTypes.size(); ++i)
-                {
-                    if (i > 0)
-                        signature += QStringLiteral(", ");
-                    signature += QStringLiteral("%1 %2").arg(func.parameterTypes[i], func.parameterNames[i]);
-                }
-                signature += QStringLiteral(") {");
-                output << signature;
-                for (const QString &line : func.body)
-                {
-                    output << line;
-                }
-                output << QStringLiteral("}");
-                output << QString();
+                declaredOrder.append(i);
             }
+            QVector<int> order = paddingMinimizingOrder(structInfo);
 
-            for (auto it = m_structs.constBegin(); it != m_structs.constEnd(); ++it)
+            bool packed = false;
+            if (m_input.packStructs)
             {
-                const StructInfo &structInfo = it.value();
-                output << QStringLiteral("struct %1 {").arg(structInfo.name);
-                for (int i = 0; i < structInfo.fieldNames.size() && i < structInfo.fieldTypes.size(); ++i)
+                packed = !structInfo.fieldTypes.contains(QStringLiteral("std::string"));
+                if (!packed)
                 {
-                    output << QStringLiteral("    %1 %2;").arg(structInfo.fieldTypes[i], structInfo.fieldNames[i]);
+                    m_optimizationNotes.append(QStringLiteral("Estructura %1: no se empaquetó porque contiene campos de texto.").arg(structInfo.name));
                 }
-                output << "};";
-                output << QString();
             }
 
-            output << QString();
-            output << QStringLiteral("int main() {");
-
-            if (!m_startupLines.isEmpty())
+            int declaredSize = structSizeForOrder(structInfo, declaredOrder, false);
+            int emittedSize = structSizeForOrder(structInfo, order, packed);
+            if (emittedSize < declaredSize)
             {
-                for (const auto &line : m_startupLines)
-                {
-                    output << QStringLiteral("%1%2").arg(QStringLiteral("    ").repeated(line.first), line.second);
-                }
-                if (!m_codeLines.isEmpty())
-                {
-                    output << QString();
-                }
+                m_optimizationNotes.append(QStringLiteral("Estructura %1: %2 → %3 bytes por elemento (ahorro de %4 bytes).")
+                                               .arg(structInfo.name)
+                                               .arg(declaredSize)
+                                               .arg(emittedSize)
+                                               .arg(declaredSize - emittedSize));
             }
 
-            for (const QString &line : m_codeLines)
+            if (packed)
+            {
+                output << QStringLiteral("#pragma pack(push, 1)");
+            }
+            output << QStringLiteral("struct %1 {").arg(structInfo.name);
+            for (int index : order)
             {
-                output << line;
+                output << QStringLiteral("    %1 %2;").arg(structInfo.fieldTypes[index], structInfo.fieldNames[index]);
             }
+            output << "};";
+            if (packed)
+            {
+                output << QStringLiteral("#pragma pack(pop)");
+            }
+            output << QString();
+        }
 
-            output << QStringLiteral("    return 0;");
-            output << QStringLiteral("}");
+        void emitStructOfArrays(const StructInfo &structInfo, QStringList &output) const
+        {
+            QString typeName = structOfArraysTypeName(structInfo.name);
+            int fieldCount = qMin(structInfo.fieldNames.size(), structInfo.fieldTypes.size());
 
-            Parser::Output result;
-            result.code = output.join('\n');
-            result.issues = m_issues;
-            result.success = m_success;
-            return result;
+            output << QStringLiteral("struct %1 {").arg(typeName);
+            QStringList initializers;
+            for (int i = 0; i < fieldCount; ++i)
+            {
+                output << QStringLiteral("    std::vector<%1> %2;").arg(structInfo.fieldTypes[i], structInfo.fieldNames[i]);
+                initializers << QStringLiteral("%1(n)").arg(structInfo.fieldNames[i]);
+            }
+            output << QString();
+            output << QStringLiteral("    explicit %1(std::size_t n = 0) : %2 {}").arg(typeName, initializers.join(QStringLiteral(", ")));
+            output << QStringLiteral("    std::size_t size() const { return %1.size(); }").arg(structInfo.fieldNames.first());
+            output << "};";
+            output << QString();
         }
 
-    private:
         bool processLine(const QString &original, const QString &normalized)
         {
             if (normalized.isEmpty())
@@ -347,6 +3771,7 @@ namespace
             {
                 core.chop(1);
             }
+            m_keywords = KeywordScanner::instance().scan(core);
 
             if (core == QStringLiteral("comenzar programa") ||
                 core == QStringLiteral("terminar programa"))
@@ -383,9 +3808,9 @@ namespace
                 return true;
             if (handleVariableOperation(original, core))
                 return true;
-            if (handleCalculateExpression(original, core))
+            if (handleCollectionAggregate(original, core))
                 return true;
-            if (handleCalculateAverage(original, core))
+            if (handleCalculateExpression(original, core))
                 return true;
             if (handleUserInput(original, core))
                 return true;
@@ -443,7 +3868,7 @@ namespace
 
         void addCodeLine(const QString &line)
         {
-            m_codeLines.append(indent() + line);
+            m_codeLines.append(indent() + line, m_sourceLine);
         }
 
         void notifyIssue(const QString &message)
@@ -451,15 +3876,94 @@ namespace
             m_issues.append(message);
         }
 
+        bool hasKeywords(KeywordMask required) const
+        {
+            return hasAll(m_keywords, required);
+        }
+
+        void addDiagnostic(Parser::DiagnosticKind kind, const QString &message)
+        {
+            m_diagnostics.append({m_sourceLine, kind, message});
+        }
+
+        const BlockState *innermostLoop() const
+        {
+            for (int i = m_blocks.size() - 1; i >= 0; --i)
+            {
+                if (m_blocks[i].type == BlockType::Loop)
+                {
+                    return &m_blocks[i];
+                }
+            }
+            return nullptr;
+        }
+
+        QString sizeDescription(const QString &collectionName) const
+        {
+            const int size = m_collections.value(collectionName).size;
+            return size > 0 ? QStringLiteral("%1 elementos").arg(size) : QStringLiteral("tamaño dado por los datos");
+        }
+
+        void checkTraversalInLoop(const QString &collectionName)
+        {
+            const BlockState *outer = innermostLoop();
+            if (!outer)
+            {
+                return;
+            }
+            QString message = QStringLiteral("Recorrido de %1 (%2) dentro de otro ciclo: se repite completo en cada vuelta.")
+                                  .arg(collectionName, sizeDescription(collectionName));
+            if (!outer->collection.isEmpty())
+            {
+                message = QStringLiteral("Recorrido de %1 (%2) dentro del recorrido de %3 (%4): el costo crece como O(n²).")
+                              .arg(collectionName, sizeDescription(collectionName), outer->collection, sizeDescription(outer->collection));
+            }
+            addDiagnostic(Parser::DiagnosticKind::NestedLoop, message);
+        }
+
+        void checkSearchInLoop(const QString &conditionExpr)
+        {
+            const BlockState *inner = innermostLoop();
+            if (!inner || inner->collection.isEmpty() || !conditionExpr.contains(QStringLiteral(" == ")) ||
+                !conditionExpr.contains(inner->collection + QLatin1Char('[')))
+            {
+                return;
+            }
+            for (Parser::Diagnostic &diagnostic : m_diagnostics)
+            {
+                if (diagnostic.line == inner->sourceLine && diagnostic.kind == Parser::DiagnosticKind::NestedLoop)
+                {
+                    diagnostic.kind = Parser::DiagnosticKind::SearchInLoop;
+                    diagnostic.message = QStringLiteral("Búsqueda lineal en %1 (%2) repetida en cada vuelta de un ciclo; con un std::unordered_set "
+                                                        "o la lista ordenada y búsqueda binaria cada consulta dejaría de ser O(n).")
+                                             .arg(inner->collection, sizeDescription(inner->collection));
+                }
+            }
+        }
+
+        void checkEmbeddedData(int values)
+        {
+            if (values > LargeEmbeddedDataValues)
+            {
+                addDiagnostic(Parser::DiagnosticKind::LargeEmbeddedData,
+                              QStringLiteral("Se incrustan %1 valores del archivo de datos en el código; el tiempo de compilación "
+                                             "crece con el archivo. Con más de %2 valores conviene leerlo al ejecutar.")
+                                  .arg(values)
+                                  .arg(LargeEmbeddedDataValues));
+            }
+        }
+
         void addStartupLine(const QString &line, int indentLevel = 1)
         {
             m_startupLines.append({indentLevel, line});
+            m_startupOrigins.append(m_sourceLine);
         }
 
-        void startBlock(const QString &header, BlockType type, bool autoClose = false, int indentLevel = 0)
+        void startBlock(const QString &header, BlockType type, bool autoClose = false, int indentLevel = 0,
+                        const QString &collection = QString())
         {
-            m_codeLines.append(indent() + header);
-            m_blocks.push_back({type, autoClose, false, false, indentLevel});
+            m_codeLines.append(indent() + header, m_sourceLine);
+            m_blocks.push_back({type, autoClose, false, false, indentLevel, m_sourceLine, collection});
 
             ++m_indentLevel;
         }
@@ -470,7 +3974,7 @@ namespace
             {
                 --m_indentLevel;
             }
-            m_codeLines.append(indent() + QStringLiteral("}"));
+            m_codeLines.append(indent() + QStringLiteral("}"), m_blocks.isEmpty() ? m_sourceLine : m_blocks.last().sourceLine);
             if (!m_blocks.isEmpty())
             {
                 m_blocks.removeLast();
@@ -503,7 +4007,7 @@ namespace
                 if (!m_functions[m_currentFunctionName].body.isEmpty() &&
                     m_functions[m_currentFunctionName].body.last().contains("while"))
                 {
-                    m_functions[m_currentFunctionName].body.append(QStringLiteral("    }"));
+                    m_functions[m_currentFunctionName].body.append(QStringLiteral("    }"), m_sourceLine);
                 }
             }
         }
@@ -541,7 +4045,7 @@ namespace
             if (m_insideFunction && !m_currentFunctionName.isEmpty())
             {
                 QString line = QStringLiteral("    %1 %2 = %3;").arg(type, name, initializer);
-                m_functions[m_currentFunctionName].body.append(line);
+                m_functions[m_currentFunctionName].body.append(line, m_sourceLine);
             }
             else
             {
@@ -667,35 +4171,14 @@ namespace
             QString nameToken;
             QString valueToken;
 
-            const struct
-            {
-                QString key;
-                QString type;
-                bool floating;
-            } typeMap[] = {
-                {QStringLiteral("numero decimal"), QStringLiteral("double"), true},
-                {QStringLiteral("numero entero"), QStringLiteral("int"), false},
-                {QStringLiteral("texto"), QStringLiteral("std::string"), false},
-                {QStringLiteral("cadena"), QStringLiteral("std::string"), false},
-                {QStringLiteral("booleano"), QStringLiteral("bool"), false}};
-
-            QString chosenType;
-            bool isFloating = false;
-            for (const auto &entry : typeMap)
-            {
-                if (rest.startsWith(entry.key))
-                {
-                    chosenType = entry.type;
-                    isFloating = entry.floating;
-                    typeToken = entry.key;
-                    break;
-                }
-            }
-
-            if (chosenType.isEmpty())
+            const Vocabulary::Entry<Vocabulary::DeclaredType> *declared = Vocabulary::variableTypes.findLeadingWords(rest, 2);
+            if (!declared)
             {
                 return false;
             }
+            const QString chosenType = QString::fromLatin1(declared->value.cppType);
+            const bool isFloating = declared->value.floating;
+            typeToken = rest.left(int(declared->key.size()));
 
             QString afterType = rest.mid(typeToken.size()).trimmed();
             if (afterType.isEmpty())
@@ -778,7 +4261,7 @@ namespace
             {
 
                 QString line = QStringLiteral("    %1 %2 = %3;").arg(chosenType, identifier, initializer);
-                m_functions[m_currentFunctionName].body.append(line);
+                m_functions[m_currentFunctionName].body.append(line, m_sourceLine);
             }
             else
             {
@@ -787,6 +4270,17 @@ namespace
             }
             registerVariable(identifier, chosenType);
 
+            if (!valueToken.isEmpty() &&
+                (chosenType == QStringLiteral("int") || chosenType == QStringLiteral("double")) &&
+                !m_reassignedVariables.contains(identifier))
+            {
+                m_constantValues[m_currentFunctionName].insert(identifier, initializer);
+            }
+            else
+            {
+                m_constantValues[m_currentFunctionName].remove(identifier);
+            }
+
             return true;
         }
 
@@ -836,45 +4330,30 @@ namespace
             }
 
             QString identifier = sanitizedIdentifier(namePart);
-            if (!hasVariable(identifier))
-            {
-
-                QString varType = QStringLiteral("int");
-                QString initialValue = QStringLiteral("0");
-
-                QString quotedText = readQuotedText(original);
-                if (!quotedText.isEmpty())
-                {
-                    varType = QStringLiteral("std::string");
-                    initialValue = QStringLiteral("\"\"");
-                    ensureInclude("string");
-                }
-                else if (valuePart == QStringLiteral("verdadero") ||
-                         valuePart == QStringLiteral("falso") ||
-                         valuePart == QStringLiteral("true") ||
-                         valuePart == QStringLiteral("false"))
-                {
-                    varType = QStringLiteral("bool");
-                    initialValue = QStringLiteral("false");
-                }
-                else if (isDecimalNumber(valuePart))
-                {
-                    varType = QStringLiteral("double");
-                    initialValue = QStringLiteral("0.0");
-                }
-
-                ensureVariable(identifier, varType, initialValue);
-            }
-
             QString valueExpr;
+            QString valueType;
             QString quotedText = readQuotedText(original);
             if (!quotedText.isEmpty())
             {
                 valueExpr = quoted(quotedText);
+                valueType = QStringLiteral("std::string");
+                ensureInclude("string");
             }
             else
             {
-                valueExpr = translateExpression(valuePart, original);
+                ExpressionPtr tree = translateExpression(valuePart, hasVariable(identifier) ? variableType(identifier) : QString());
+                if (!tree)
+                {
+                    notifyIssue(QStringLiteral("No se pudo interpretar la expresión: %1").arg(valuePart));
+                    return true;
+                }
+                valueExpr = printExpression(tree);
+                valueType = cppTypeOf(inferType(tree));
+            }
+
+            if (!hasVariable(identifier))
+            {
+                ensureVariable(identifier, valueType, getDefaultValueForType(valueType));
             }
 
             addCodeLine(QStringLiteral("%1 = %2;").arg(identifier, valueExpr));
@@ -905,6 +4384,7 @@ namespace
                 FunctionInfo funcInfo;
                 funcInfo.name = functionName;
                 funcInfo.returnType = returnType;
+                funcInfo.sourceLine = m_sourceLine;
 
                 QStringList paramParts = paramsText.split(QStringLiteral(" y "));
 
@@ -929,6 +4409,10 @@ namespace
                     }
                 }
 
+                if (!acceptsSignatureTypes(funcInfo))
+                {
+                    return false;
+                }
                 m_functions.insert(functionName, funcInfo);
                 m_insideFunction = true;
                 m_currentFunctionName = functionName;
@@ -954,8 +4438,13 @@ namespace
             FunctionInfo funcInfo;
             funcInfo.name = functionName;
             funcInfo.returnType = returnType;
+            funcInfo.sourceLine = m_sourceLine;
             funcInfo.parameterTypes << paramType;
             funcInfo.parameterNames << paramIdentifier;
+            if (!acceptsSignatureTypes(funcInfo))
+            {
+                return false;
+            }
 
             registerVariable(paramIdentifier, paramType, false);
 
@@ -966,25 +4455,38 @@ namespace
             return true;
         }
 
-        QString typeFromPhrase(const QString &phrase)
+        bool acceptsSignatureTypes(const FunctionInfo &funcInfo)
         {
-            if (phrase.contains(QStringLiteral("numero entero")))
+            QStringList types = funcInfo.parameterTypes;
+            types << funcInfo.returnType;
+            for (const QString &type : types)
             {
-                return QStringLiteral("int");
+                if (m_structs.value(type).structOfArrays)
+                {
+                    notifyIssue(QStringLiteral("La estructura %1 se guarda por columnas y no puede usarse como tipo de una función.").arg(type));
+                    return false;
+                }
             }
-            if (phrase.contains(QStringLiteral("numero decimal")))
+            return true;
+        }
+
+        QString typeFromPhrase(const QString &phrase)
+        {
+            if (m_structs.contains(phrase))
             {
-                return QStringLiteral("double");
+                return phrase;
             }
-            if (phrase.contains(QStringLiteral("texto")))
+            if (phrase.startsWith(QStringLiteral("lista de ")) || phrase.startsWith(QStringLiteral("vector de ")))
             {
-                return QStringLiteral("std::string");
+                ensureInclude("vector");
+                return QStringLiteral("std::vector<%1>").arg(elementTypeFromPhrase(phrase.mid(phrase.indexOf(QStringLiteral(" de ")) + 4)));
             }
-            if (phrase.contains(QStringLiteral("booleano")))
+            const QString type = typeFromWords(phrase, QStringLiteral("int"));
+            if (type == QStringLiteral("std::string"))
             {
-                return QStringLiteral("bool");
+                ensureInclude("string");
             }
-            return QStringLiteral("int");
+            return type;
         }
 
         bool handleReturnStatement(const QString &original, const QString &normalized)
@@ -1005,7 +4507,7 @@ namespace
                 int whileCount = 0;
                 int braceCount = 0;
 
-                for (const QString &bodyLine : m_functions[m_currentFunctionName].body)
+                for (const QString &bodyLine : m_functions[m_currentFunctionName].body.texts())
                 {
                     if (bodyLine.contains("while") && bodyLine.endsWith(" {"))
                     {
@@ -1021,11 +4523,11 @@ namespace
                 {
                     for (int i = braceCount; i < whileCount; i++)
                     {
-                        m_functions[m_currentFunctionName].body.append(QStringLiteral("    }"));
+                        m_functions[m_currentFunctionName].body.append(QStringLiteral("    }"), m_sourceLine);
                     }
                 }
 
-                m_functions[m_currentFunctionName].body.append(line);
+                m_functions[m_currentFunctionName].body.append(line, m_sourceLine);
 
                 const FunctionInfo &funcInfo = m_functions[m_currentFunctionName];
                 for (const QString &paramName : funcInfo.parameterNames)
@@ -1056,12 +4558,6 @@ namespace
                 QString funcName = multiMatch.captured(2);
                 QString argsText = multiMatch.captured(3).trimmed();
 
-                if (!hasVariable(varName))
-                {
-                    addCodeLine(QStringLiteral("int %1;").arg(varName));
-                    registerVariable(varName, QStringLiteral("int"), false);
-                }
-
                 QStringList argParts = argsText.contains(QStringLiteral(", ")) ? argsText.split(QStringLiteral(", ")) : argsText.split(QStringLiteral(" y "));
 
                 QStringList cleanArgs;
@@ -1074,7 +4570,7 @@ namespace
                     }
                 }
 
-                addCodeLine(QStringLiteral("%1 = %2(%3);").arg(varName, funcName, cleanArgs.join(QStringLiteral(", "))));
+                emitFunctionCall(varName, funcName, cleanArgs);
                 return true;
             }
 
@@ -1086,13 +4582,7 @@ namespace
                 QString funcName = callMatch.captured(2);
                 QString argName = sanitizedIdentifier(callMatch.captured(3));
 
-                if (!hasVariable(varName))
-                {
-                    addCodeLine(QStringLiteral("int %1;").arg(varName));
-                    registerVariable(varName, QStringLiteral("int"), false);
-                }
-
-                addCodeLine(QStringLiteral("%1 = %2(%3);").arg(varName, funcName, argName));
+                emitFunctionCall(varName, funcName, {argName});
                 return true;
             }
             return false;
@@ -1113,7 +4603,7 @@ namespace
 
                 if (m_insideFunction && !m_currentFunctionName.isEmpty())
                 {
-                    m_functions[m_currentFunctionName].body.append(line);
+                    m_functions[m_currentFunctionName].body.append(line, m_sourceLine);
                 }
                 else
                 {
@@ -1133,7 +4623,7 @@ namespace
 
                 if (m_insideFunction && !m_currentFunctionName.isEmpty())
                 {
-                    m_functions[m_currentFunctionName].body.append(line);
+                    m_functions[m_currentFunctionName].body.append(line, m_sourceLine);
                 }
                 else
                 {
@@ -1147,6 +4637,7 @@ namespace
 
         bool handleCalculateExpression(const QString &original, const QString &normalized)
         {
+            Q_UNUSED(original);
             if (!normalized.startsWith(QStringLiteral("calcular ")))
             {
                 return false;
@@ -1169,83 +4660,215 @@ namespace
             }
             else
             {
-                return false;
+                return false;
+            }
+
+            QString exprPart = rest.left(idxAsignar).trimmed();
+            QString destPart = rest.mid(idxAsignar + assignToken.size()).trimmed();
+
+            if (exprPart.isEmpty() || destPart.isEmpty())
+            {
+                return false;
+            }
+
+            int idxComo = exprPart.indexOf(QStringLiteral(" como "));
+            if (idxComo >= 0)
+            {
+                exprPart = exprPart.mid(idxComo + QStringLiteral(" como ").size()).trimmed();
+            }
+
+            QString dest = sanitizedIdentifier(destPart);
+            if (dest.isEmpty())
+            {
+                notifyIssue(QStringLiteral("No se pudo interpretar la variable destino en la instrucción de cálculo."));
+                return true;
+            }
+
+            ExpressionPtr tree = translateExpression(exprPart, hasVariable(dest) ? variableType(dest) : QString());
+            if (!tree)
+            {
+                notifyIssue(QStringLiteral("No se pudo interpretar la expresión a calcular: %1").arg(exprPart));
+                return true;
+            }
+            QString expr = printExpression(tree);
+            ValueType type = inferType(tree);
+            if (!m_insideFunction)
+            {
+                static const QRegularExpression averageWord(QStringLiteral("\\b(?:promedio|media)\\b"));
+                const bool average = averageWord.match(normalized).hasMatch();
+                QString averaged = divideByElementCount(expr, average);
+                if (averaged != expr)
+                {
+                    expr = averaged;
+                    type = ValueType::Double;
+                }
+            }
+            m_sumAccumulators.remove(dest);
+
+            if (!hasVariable(dest))
+            {
+                QString varType = cppTypeOf(type);
+                if (type == ValueType::String)
+                {
+                    ensureInclude("string");
+                }
+                ensureVariable(dest, varType, getDefaultValueForType(varType));
+            }
+
+            QString assignmentLine = QStringLiteral("%1 = %2;").arg(dest, expr);
+
+            if (m_insideFunction && !m_currentFunctionName.isEmpty())
+            {
+                m_functions[m_currentFunctionName].body.append(QStringLiteral("    %1").arg(assignmentLine), m_sourceLine);
+            }
+            else
+            {
+                addCodeLine(assignmentLine);
             }
 
-            QString exprPart = rest.left(idxAsignar).trimmed();
-            QString destPart = rest.mid(idxAsignar + assignToken.size()).trimmed();
+            return true;
+        }
 
-            if (exprPart.isEmpty() || destPart.isEmpty())
+        bool handleCollectionAggregate(const QString &original, const QString &normalized)
+        {
+            Q_UNUSED(original);
+            QRegularExpression re(QStringLiteral("^calcular (?:el |la )?(?:valor )?(promedio|suma|maximo|mayor|minimo|menor) de (?:los elementos de )?(?:la |el )?(lista|vector|arreglo)(?: y asignar (?:a|al) ([a-zA-Z_][a-zA-Z0-9_]*))?$"));
+            QRegularExpressionMatch match = re.match(normalized);
+            if (!match.hasMatch())
             {
                 return false;
             }
 
-            int idxComo = exprPart.indexOf(QStringLiteral(" como "));
-            if (idxComo >= 0)
+            QString kind = match.captured(1);
+            if (kind == QStringLiteral("mayor"))
             {
-                exprPart = exprPart.mid(idxComo + QStringLiteral(" como ").size()).trimmed();
+                kind = QStringLiteral("maximo");
+            }
+            else if (kind == QStringLiteral("menor"))
+            {
+                kind = QStringLiteral("minimo");
             }
+            QString destination = match.captured(3).isEmpty() ? kind : sanitizedIdentifier(match.captured(3));
 
-            QString dest = sanitizedIdentifier(destPart);
-            if (dest.isEmpty())
+            QString collectionName = collectionNameForAlias(match.captured(2));
+            if (collectionName.isEmpty())
             {
-                notifyIssue(QStringLiteral("No se pudo interpretar la variable destino en la instrucción de cálculo."));
+                collectionName = lastCollection();
+            }
+            if (collectionName.isEmpty())
+            {
+                notifyIssue(QStringLiteral("No se encontró ninguna colección disponible para esta instrucción."));
                 return true;
             }
 
-            QString expr = translateExpression(exprPart, original);
-            if (expr.isEmpty())
+            QString elementType = elementTypeForCollection(collectionName);
+            if (elementType.isEmpty() || elementType == QStringLiteral("std::string"))
             {
-                notifyIssue(QStringLiteral("No se pudo interpretar la expresión a calcular: %1").arg(exprPart));
+                notifyIssue(QStringLiteral("Solo se pueden calcular sumas, promedios, máximos y mínimos sobre colecciones numéricas."));
                 return true;
             }
 
-            if (!hasVariable(dest))
+            QString type = kind == QStringLiteral("promedio") ? QStringLiteral("double") : elementType;
+            QString initial = getDefaultValueForType(type);
+            if (kind == QStringLiteral("maximo"))
             {
-                QString varType = QStringLiteral("int");
-                QString defaultValue = QStringLiteral("0");
-
-                if (expr.contains('.') ||
-                    exprPart.contains(QStringLiteral("decimal")) ||
-                    expr.contains('/') ||
-                    exprPart.contains(QStringLiteral("dividir")) ||
-                    exprPart.contains(QStringLiteral("dividido")))
-                {
-                    varType = QStringLiteral("double");
-                    defaultValue = QStringLiteral("0.0");
-                }
+                ensureInclude("algorithm");
+                ensureInclude("limits");
+                initial = QStringLiteral("std::numeric_limits<%1>::lowest()").arg(type);
+            }
+            else if (kind == QStringLiteral("minimo"))
+            {
+                ensureInclude("algorithm");
+                ensureInclude("limits");
+                initial = QStringLiteral("std::numeric_limits<%1>::max()").arg(type);
+            }
 
-                ensureVariable(dest, varType, defaultValue);
+            if (hasVariable(destination))
+            {
+                addCodeLine(QStringLiteral("%1 = %2;").arg(destination, initial));
+            }
+            else
+            {
+                ensureVariable(destination, type, initial);
             }
 
-            QString assignmentLine = QStringLiteral("%1 = %2;").arg(dest, expr);
+            QString itemName = QStringLiteral("item");
+            if (hasVariable(itemName))
+            {
+                itemName = QStringLiteral("item%1").arg(m_tempCounter++);
+            }
 
-            if (m_insideFunction && !m_currentFunctionName.isEmpty())
+            int loopStart = m_codeLines.size();
+            addCodeLine(QStringLiteral("for (const %1 &%2 : %3) {").arg(elementType, itemName, collectionName));
+            ++m_indentLevel;
+            if (kind == QStringLiteral("maximo"))
+            {
+                addCodeLine(QStringLiteral("%1 = std::max(%1, %2);").arg(destination, itemName));
+            }
+            else if (kind == QStringLiteral("minimo"))
             {
-                m_functions[m_currentFunctionName].body.append(QStringLiteral("    %1").arg(assignmentLine));
+                addCodeLine(QStringLiteral("%1 = std::min(%1, %2);").arg(destination, itemName));
             }
             else
             {
-                addCodeLine(assignmentLine);
+                addCodeLine(QStringLiteral("%1 += %2;").arg(destination, itemName));
             }
+            --m_indentLevel;
+            addCodeLine(QStringLiteral("}"));
 
+            if (kind == QStringLiteral("promedio"))
+            {
+                addCodeLine(QStringLiteral("%1 = %2.empty() ? 0.0 : %1 / static_cast<double>(%2.size());").arg(destination, collectionName));
+            }
+            else if (kind == QStringLiteral("suma"))
+            {
+                recordSumAccumulator(destination, collectionName, loopStart);
+            }
             return true;
         }
 
-        bool handleCalculateAverage(const QString &original, const QString &normalized)
+        void recordSumAccumulator(const QString &name, const QString &collection, int loopStart)
         {
-            Q_UNUSED(original);
-
-            if ((normalized.contains(QStringLiteral("calcular promedio")) ||
-                 normalized.contains(QStringLiteral("calcular el promedio"))) &&
-                normalized.contains(QStringLiteral("como")) &&
-                normalized.contains(QStringLiteral("dividir")))
+            m_sumAccumulators.remove(name);
+            QRegularExpression zeroRe(QStringLiteral("^(?:(?:int|double|float) )?%1 = 0(?:\\.0)?f?;$").arg(QRegularExpression::escape(name)));
+            for (int i = loopStart - 1; i >= 0; --i)
             {
-
-                return false;
+                if (!linesMutateIdentifier({m_codeLines[i]}, name))
+                {
+                    continue;
+                }
+                QString lineIndent = m_codeLines[i].left(m_codeLines[i].indexOf(m_codeLines[i].trimmed()));
+                if (zeroRe.match(m_codeLines[i].trimmed()).hasMatch() && lineIndent == indent())
+                {
+                    m_sumAccumulators.insert(name, {collection, m_codeLines.size()});
+                }
+                return;
             }
+        }
 
-            return false;
+        QString divideByElementCount(const QString &expression, bool average)
+        {
+            static const QRegularExpression averageRe(QStringLiteral("^(?:static_cast<double>\\(([A-Za-z_]\\w*)\\)|([A-Za-z_]\\w*)) / (\\d+(?:\\.\\d+)?)$"));
+            QRegularExpressionMatch match = averageRe.match(expression);
+            QString accumulator = match.captured(1).isEmpty() ? match.captured(2) : match.captured(1);
+            if (!match.hasMatch() || !m_sumAccumulators.contains(accumulator))
+            {
+                return expression;
+            }
+            const SumAccumulator &sum = m_sumAccumulators[accumulator];
+            const int knownSize = m_collections.value(sum.collection).size;
+            const bool divisorIsCount = knownSize > 0 && match.captured(3).toDouble() == knownSize;
+            if (!average && !divisorIsCount)
+            {
+                return expression;
+            }
+            QStringList since = m_codeLines.mid(sum.endLine);
+            if (linesMutateIdentifier(since, accumulator) || linesResizeCollection(since, sum.collection))
+            {
+                return expression;
+            }
+            m_optimizationNotes.append(QStringLiteral("El promedio de %1 se divide entre la cantidad real de elementos de %2.").arg(accumulator, sum.collection));
+            return QStringLiteral("%1 / static_cast<double>(%2.size())").arg(accumulator, sum.collection);
         }
 
         bool handleInputValue(const QString &original, const QString &normalized)
@@ -1329,122 +4952,138 @@ namespace
             return true;
         }
 
-        QString translateExpression(const QString &valuePart, const QString &original)
+        ExpressionPtr translateExpression(const QString &expression, const QString &targetType)
         {
-            Q_UNUSED(original);
-            QString expr = valuePart;
-            QString normalizedExpr = normalizeLine(expr);
-
-            if (normalizedExpr == QStringLiteral("verdadero") || normalizedExpr == QStringLiteral("true"))
+            ExpressionPtr root = parseSpanishExpression(expression);
+            if (!root)
             {
-                return QStringLiteral("true");
+                return nullptr;
             }
-            if (normalizedExpr == QStringLiteral("falso") || normalizedExpr == QStringLiteral("false"))
+            if (valueTypeOf(targetType) != ValueType::Int)
             {
-                return QStringLiteral("false");
+                root = withRealDivision(root);
             }
-
-            normalizedExpr.replace(QStringLiteral(" mas "), QStringLiteral(" + "));
-            normalizedExpr.replace(QStringLiteral(" mas"), QStringLiteral(" +"));
-            normalizedExpr.replace(QStringLiteral("mas "), QStringLiteral("+ "));
-            normalizedExpr.replace(QStringLiteral("menos"), QStringLiteral("-"));
-            normalizedExpr.replace(QStringLiteral(" multiplicado por "), QStringLiteral(" * "));
-            normalizedExpr.replace(QStringLiteral(" dividido entre "), QStringLiteral(" / "));
-
-            if (normalizedExpr.contains(QStringLiteral("total dividido entre")))
+            else if (inferType(root) == ValueType::Double)
             {
-                QRegularExpression re(QString::fromLatin1(R"(([a-zA-Z_][a-zA-Z0-9_]*)\s+dividido entre\s+(-?\d+(?:[.,]\d+)?))"));
-                QRegularExpressionMatch match = re.match(normalizedExpr);
-                if (match.hasMatch())
-                {
-                    QString varName = sanitizedIdentifier(match.captured(1));
-                    QString number = ensureNumberString(match.captured(2), true);
-                    return QStringLiteral("%1 / %2").arg(varName, number);
-                }
+                root = convertedTo(root, ValueType::Int);
             }
+            return foldOperands(root);
+        }
 
-            if (normalizedExpr.contains(QStringLiteral("total")) && normalizedExpr.contains(QStringLiteral(" entre ")))
+        ValueType inferType(const ExpressionPtr &node) const
+        {
+            switch (node->kind)
+            {
+            case ExpressionNode::Kind::Number:
+                return node->floating ? ValueType::Double : ValueType::Int;
+            case ExpressionNode::Kind::Conversion:
+                return valueTypeOf(node->text);
+            case ExpressionNode::Kind::Index:
+                return valueTypeOf(elementTypeForCollection(node->left->text));
+            case ExpressionNode::Kind::Unary:
+                return node->text == QStringLiteral("!") ? ValueType::Bool : inferType(node->left);
+            case ExpressionNode::Kind::Binary:
             {
-                QStringList parts = normalizedExpr.split(QStringLiteral(" entre "));
-                if (parts.size() == 2)
+                if (binaryPrecedence(node->text) <= binaryPrecedence(QStringLiteral("<")))
                 {
-                    QString left = sanitizedIdentifier(parts[0].trimmed());
-                    QString right = ensureNumberString(parts[1], true);
-                    return QStringLiteral("%1 / %2").arg(left, right);
+                    return ValueType::Bool;
                 }
-            }
-
-            QRegularExpression simpleDivide(QStringLiteral("^([a-zA-Z_][a-zA-Z0-9_]*)\\s+dividir\\s+(.+)$"));
-            QRegularExpressionMatch simpleMatch = simpleDivide.match(normalizedExpr);
-            if (simpleMatch.hasMatch())
-            {
-                QString left = sanitizedIdentifier(simpleMatch.captured(1));
-                QString rightToken = simpleMatch.captured(2).trimmed();
-                QString right;
-                if (QRegularExpression(QStringLiteral("^-?\\d+(?:[\\.,]\\d+)?$"))
-                        .match(rightToken)
-                        .hasMatch())
+                const ValueType left = inferType(node->left);
+                const ValueType right = inferType(node->right);
+                if (node->text == QStringLiteral("+") && (left == ValueType::String || right == ValueType::String))
                 {
-                    right = ensureNumberString(rightToken, rightToken.contains('.') || rightToken.contains(','));
+                    return ValueType::String;
                 }
-                else
+                if (left == ValueType::Unknown || right == ValueType::Unknown || left == ValueType::String || right == ValueType::String)
                 {
-                    right = sanitizedIdentifier(rightToken);
+                    return ValueType::Unknown;
                 }
-                if (left.isEmpty() || right.isEmpty())
+                if (node->text == QStringLiteral("%"))
                 {
-                    return QString();
+                    return ValueType::Int;
                 }
-                return QStringLiteral("%1 / %2").arg(left, right);
+                return (left == ValueType::Double || right == ValueType::Double) ? ValueType::Double : ValueType::Int;
+            }
+            case ExpressionNode::Kind::Identifier:
+                break;
             }
 
-            if (normalizedExpr.contains(QStringLiteral(" dividido entre ")))
+            const QString &text = node->text;
+            if (text == QStringLiteral("true") || text == QStringLiteral("false"))
             {
-                QStringList parts = normalizedExpr.split(QStringLiteral(" dividido entre "));
-                if (parts.size() == 2)
-                {
-                    QString left = sanitizedIdentifier(parts[0].trimmed());
-                    QString rightPart = parts[1].trimmed();
-                    bool isDecimal = isDecimalNumber(rightPart);
-                    QString right = ensureNumberString(rightPart, isDecimal);
-                    return QStringLiteral("%1 / %2").arg(left, right);
-                }
+                return ValueType::Bool;
             }
-
-            QRegularExpression numbers("-?\\d+(?:[\\.,]\\d+)?");
-            QString processed = normalizedExpr;
-            int idx = 0;
-            while (true)
+            if (text.startsWith('"'))
             {
-                QRegularExpressionMatch match = numbers.match(processed, idx);
-                if (!match.hasMatch())
-                {
-                    break;
-                }
-                QString number = match.captured();
-                QString replacement = ensureNumberString(number, number.contains('.') || number.contains(','));
-                processed.replace(match.capturedStart(), match.capturedLength(), replacement);
-                idx = match.capturedStart() + replacement.size();
+                return ValueType::String;
+            }
+            const int call = text.indexOf('(');
+            if (call > 0)
+            {
+                const QString name = text.left(call);
+                return hasFunction(name) ? valueTypeOf(m_functions.value(name).returnType) : ValueType::Unknown;
             }
+            return hasVariable(text) ? valueTypeOf(variableType(text)) : ValueType::Unknown;
+        }
 
-            QRegularExpression variablePattern(QStringLiteral("\\b([a-zA-Z_][a-zA-Z0-9_]*)\\b"));
-            QRegularExpressionMatchIterator varIterator = variablePattern.globalMatch(processed);
-            QString finalProcessed = processed;
+        static ExpressionPtr convertedTo(const ExpressionPtr &node, ValueType type)
+        {
+            if (node->kind == ExpressionNode::Kind::Number)
+            {
+                const double value = node->text.toDouble();
+                return type == ValueType::Double ? numberNode(value, true) : numberNode(std::trunc(value), false);
+            }
+            auto conversion = std::make_shared<ExpressionNode>();
+            conversion->kind = ExpressionNode::Kind::Conversion;
+            conversion->text = cppTypeOf(type);
+            conversion->left = node;
+            return conversion;
+        }
 
-            while (varIterator.hasNext())
+        // "dividido entre" divide en decimales aunque ambos operandos sean enteros.
+        ExpressionPtr withRealDivision(const ExpressionPtr &node) const
+        {
+            if (node->kind != ExpressionNode::Kind::Binary && node->kind != ExpressionNode::Kind::Unary)
+            {
+                return node;
+            }
+            auto copy = std::make_shared<ExpressionNode>(*node);
+            copy->left = withRealDivision(node->left);
+            if (node->right)
             {
-                QRegularExpressionMatch varMatch = varIterator.next();
-                QString varCandidate = varMatch.captured(1);
-                QString sanitizedVar = sanitizedIdentifier(varCandidate);
+                copy->right = withRealDivision(node->right);
+            }
+            if (copy->text == QStringLiteral("/") && inferType(copy->left) == ValueType::Int && inferType(copy->right) == ValueType::Int)
+            {
+                copy->left = convertedTo(copy->left, ValueType::Double);
+            }
+            return copy;
+        }
 
-                if (hasVariable(sanitizedVar) && varCandidate != sanitizedVar)
+        ExpressionPtr parseSpanishExpression(const QString &expression)
+        {
+            OperandResolver resolver;
+            resolver.operand = [this](const QString &phrase)
+            { return translateOperand(phrase); };
+            resolver.collection = [this](const QString &name)
+            {
+                const QString identifier = sanitizedIdentifier(name);
+                return hasCollection(identifier) ? identifier : collectionNameForAlias(name);
+            };
+            resolver.index = [this](const QString &name)
+            {
+                const QString identifier = sanitizedIdentifier(name);
+                if (hasVariable(identifier))
                 {
-                    finalProcessed.replace(varCandidate, sanitizedVar);
+                    return identifier;
                 }
-            }
-
-            finalProcessed.replace(QStringLiteral(" "), QString());
-            return finalProcessed;
+                if (hasVariable(QStringLiteral("idx")))
+                {
+                    return QStringLiteral("idx");
+                }
+                return hasVariable(QStringLiteral("i")) ? QStringLiteral("i") : identifier;
+            };
+            return SpanishExpressionParser::parse(normalizeLine(expression), resolver);
         }
 
         QString literalForType(const QString &valueText,
@@ -1512,16 +5151,11 @@ namespace
         bool handleArithmeticBinary(const QString &original, const QString &normalized)
         {
             Q_UNUSED(original);
-            static const struct
+            const Vocabulary::Entry<Vocabulary::ArithmeticVerb> *entry = Vocabulary::arithmeticVerbs.findLeadingWords(normalized, 1);
+            if (!entry)
             {
-                QString verb;
-                QString op;
-                bool useEntre;
-            } entries[] = {
-                {QStringLiteral("sumar"), QStringLiteral("+"), false},
-                {QStringLiteral("restar"), QStringLiteral("-"), false},
-                {QStringLiteral("multiplicar"), QStringLiteral("*"), false},
-                {QStringLiteral("dividir"), QStringLiteral("/"), true}};
+                return false;
+            }
 
             auto operandInfo = [](const QString &token)
             {
@@ -1536,57 +5170,33 @@ namespace
                 return QPair<QString, bool>(identifier, false);
             };
 
-            for (const auto &entry : entries)
+            const QString separator = entry->value.useEntre ? QStringLiteral(" entre ") : QStringLiteral(" y ");
+            QString tail = normalized.mid(int(entry->key.size())).trimmed();
+            int idx = tail.indexOf(separator);
+            if (idx < 0)
             {
-                if (!normalized.startsWith(entry.verb + QLatin1Char(' ')))
-                {
-                    continue;
-                }
-
-                QString tail = normalized.mid(entry.verb.size()).trimmed();
-                QString leftToken;
-                QString rightToken;
-
-                if (entry.useEntre)
-                {
-                    int idx = tail.indexOf(QStringLiteral(" entre "));
-                    if (idx < 0)
-                    {
-                        continue;
-                    }
-                    leftToken = tail.left(idx).trimmed();
-                    rightToken = tail.mid(idx + QStringLiteral(" entre ").size()).trimmed();
-                }
-                else
-                {
-                    int idx = tail.indexOf(QStringLiteral(" y "));
-                    if (idx < 0)
-                    {
-                        continue;
-                    }
-                    leftToken = tail.left(idx).trimmed();
-                    rightToken = tail.mid(idx + QStringLiteral(" y ").size()).trimmed();
-                }
+                return false;
+            }
+            QString leftToken = tail.left(idx).trimmed();
+            QString rightToken = tail.mid(idx + separator.size()).trimmed();
 
-                auto leftInfo = operandInfo(leftToken);
-                auto rightInfo = operandInfo(rightToken);
+            auto leftInfo = operandInfo(leftToken);
+            auto rightInfo = operandInfo(rightToken);
 
-                if (leftInfo.first.isEmpty() || rightInfo.first.isEmpty())
-                {
-                    notifyIssue(QStringLiteral("No se pudieron interpretar los operandos de la operación."));
-                    return false;
-                }
+            if (leftInfo.first.isEmpty() || rightInfo.first.isEmpty())
+            {
+                notifyIssue(QStringLiteral("No se pudieron interpretar los operandos de la operación."));
+                return false;
+            }
 
-                bool useDouble = leftInfo.second || rightInfo.second;
-                QString type = useDouble ? QStringLiteral("double") : QStringLiteral("int");
+            bool useDouble = leftInfo.second || rightInfo.second;
+            QString type = useDouble ? QStringLiteral("double") : QStringLiteral("int");
 
-                QString tempName = QStringLiteral("resultado%1").arg(m_tempCounter++);
-                addCodeLine(QStringLiteral("%1 %2 = %3 %4 %5;").arg(type, tempName, leftInfo.first, entry.op, rightInfo.first));
-                addCodeLine(QStringLiteral("std::cout << %1 << std::endl;").arg(tempName));
-                ensureInclude("iostream");
-                return true;
-            }
-            return false;
+            QString tempName = QStringLiteral("resultado%1").arg(m_tempCounter++);
+            addCodeLine(QStringLiteral("%1 %2 = %3 %4 %5;").arg(type, tempName, leftInfo.first, QString::fromLatin1(entry->value.op), rightInfo.first));
+            addCodeLine(QStringLiteral("std::cout << %1 << std::endl;").arg(tempName));
+            ensureInclude("iostream");
+            return true;
         }
 
         bool handleArithmeticAggregate(const QString &original, const QString &normalized)
@@ -1631,8 +5241,7 @@ namespace
         bool handleCompoundArithmeticInstruction(const QString &original, const QString &normalized)
         {
             Q_UNUSED(original);
-            if (normalized.startsWith(QStringLiteral("sumar los numeros")) &&
-                normalized.contains(QStringLiteral("y mostrar el resultado")))
+            if (normalized.startsWith(QStringLiteral("sumar los numeros")) && hasKeywords(KeywordMostrarResultado))
             {
 
                 QString numbersOnly = normalized;
@@ -1759,7 +5368,7 @@ namespace
 
                 if (m_insideFunction && !m_currentFunctionName.isEmpty())
                 {
-                    m_functions[m_currentFunctionName].body.append(line);
+                    m_functions[m_currentFunctionName].body.append(line, m_sourceLine);
                 }
                 else
                 {
@@ -1966,7 +5575,7 @@ namespace
 
                 QString elementType;
                 QString type;
-                if (normalized.contains(QStringLiteral("decimal")))
+                if (hasKeywords(KeywordDecimal))
                 {
                     elementType = QStringLiteral("double");
                     type = QStringLiteral("std::vector<double>");
@@ -2023,6 +5632,14 @@ namespace
 
         QString getDefaultValueForType(const QString &type)
         {
+            if (type == QStringLiteral("bool"))
+            {
+                return QStringLiteral("false");
+            }
+            if (type == QStringLiteral("std::string"))
+            {
+                return QStringLiteral("\"\"");
+            }
             return (type == QStringLiteral("double")) ? QStringLiteral("0.0") : QStringLiteral("0");
         }
 
@@ -2039,25 +5656,17 @@ namespace
 
         QString elementTypeFromPhrase(const QString &phrase)
         {
-            if (phrase.contains(QStringLiteral("texto")) || phrase.contains(QStringLiteral("cadena")))
-            {
-                ensureInclude("string");
-                return QStringLiteral("std::string");
-            }
-            if (phrase.contains(QStringLiteral("decimal")) || phrase.contains(QStringLiteral("decimales")))
-            {
-                return QStringLiteral("double");
-            }
-            if (phrase.contains(QStringLiteral("entero")) || phrase.contains(QStringLiteral("enteros")) ||
-                phrase.contains(QStringLiteral("numeros enteros")) || phrase.contains(QStringLiteral("numero entero")))
+            // std::vector<bool> no da referencias a sus elementos; los booleanos se guardan como texto.
+            QString type = typeFromWords(phrase, QStringLiteral("std::string"));
+            if (type == QStringLiteral("bool"))
             {
-                return QStringLiteral("int");
+                type = QStringLiteral("std::string");
             }
-            if (phrase.contains(QStringLiteral("numero")) || phrase.contains(QStringLiteral("numeros")))
+            if (type == QStringLiteral("std::string"))
             {
-                return QStringLiteral("int");
+                ensureInclude("string");
             }
-            return QStringLiteral("std::string");
+            return type;
         }
 
         bool handleAssignCollectionElement(const QString &original, const QString &normalized)
@@ -2111,22 +5720,8 @@ namespace
 
         int ordinalToIndex(const QString &ordinal) const
         {
-            static const QMap<QString, int> ordinals = {
-                {QStringLiteral("primer"), 0},
-                {QStringLiteral("segundo"), 1},
-                {QStringLiteral("tercer"), 2},
-                {QStringLiteral("cuarto"), 3},
-                {QStringLiteral("quinto"), 4},
-                {QStringLiteral("sexto"), 5},
-                {QStringLiteral("septimo"), 6},
-                {QStringLiteral("octavo"), 7},
-                {QStringLiteral("noveno"), 8},
-                {QStringLiteral("decimo"), 9}};
-            if (ordinal == QStringLiteral("ultimo"))
-            {
-                return -1;
-            }
-            return ordinals.value(ordinal, 0);
+            const int *index = Vocabulary::ordinals.find(ordinal);
+            return index ? *index : 0;
         }
 
         bool handleAddToCollection(const QString &original, const QString &normalized)
@@ -2271,6 +5866,13 @@ namespace
                 notifyIssue(QStringLiteral("No se pudo determinar el tipo de datos de la colección."));
                 return false;
             }
+            if (innermostLoop())
+            {
+                addDiagnostic(Parser::DiagnosticKind::SortInLoop,
+                              QStringLiteral("Se ordena %1 (%2) en cada vuelta de un ciclo: cada orden cuesta O(n log n). "
+                                             "Ordene una sola vez antes del ciclo.")
+                                  .arg(collectionName, sizeDescription(collectionName)));
+            }
             ensureInclude("algorithm");
             if (info.isCArray)
             {
@@ -2340,15 +5942,16 @@ namespace
                     indexName = QStringLiteral("i%1").arg(m_tempCounter++);
                 }
 
+                checkTraversalInLoop(collectionName);
                 if (info.isCArray)
                 {
                     startBlock(QStringLiteral("for (std::size_t %1 = 0; %1 < %2; ++%1) {").arg(indexName).arg(info.size),
-                               BlockType::Loop, true, m_currentIndent);
+                               BlockType::Loop, true, m_currentIndent, collectionName);
                 }
                 else
                 {
                     startBlock(QStringLiteral("for (std::size_t %1 = 0; %1 < %2.size(); ++%1) {").arg(indexName, collectionName),
-                               BlockType::Loop, true, m_currentIndent);
+                               BlockType::Loop, true, m_currentIndent, collectionName);
                 }
 
                 return true;
@@ -2393,6 +5996,7 @@ namespace
                 return false;
             }
 
+            checkTraversalInLoop(collectionName);
             QString itemName = QStringLiteral("item");
             if (hasVariable(itemName))
             {
@@ -2414,11 +6018,19 @@ namespace
 
             ensureVariable(destination, sumType, sumDefault);
 
+            QString accumulate = QStringLiteral("%1 += %2;").arg(destination, itemName);
+            if (valueTypeOf(variableType(destination)) == ValueType::Int && valueTypeOf(elementType) == ValueType::Double)
+            {
+                accumulate = QStringLiteral("%1 = static_cast<int>(%1 + %2);").arg(destination, itemName);
+            }
+
+            int loopStart = m_codeLines.size();
             addCodeLine(QStringLiteral("for (const %1 &%2 : %3) {").arg(elementType, itemName, collectionName));
             ++m_indentLevel;
-            addCodeLine(QStringLiteral("%1 += %2;").arg(destination, itemName));
+            addCodeLine(accumulate);
             --m_indentLevel;
             addCodeLine(QStringLiteral("}"));
+            recordSumAccumulator(destination, collectionName, loopStart);
             return true;
         }
 
@@ -2455,6 +6067,7 @@ namespace
                 return false;
             }
 
+            checkSearchInLoop(conditionExpr);
             startBlock(QStringLiteral("if (%1) {").arg(conditionExpr), BlockType::If, true, m_currentIndent);
 
             if (!action.isEmpty())
@@ -2473,98 +6086,29 @@ namespace
 
         QString translateCondition(const QString &condition)
         {
-            QString norm = condition.trimmed();
-            QString normalized = normalizeLine(norm);
-            normalized.replace(QStringLiteral(" es "), QStringLiteral(" "));
-
-            struct
+            ExpressionPtr root = parseSpanishExpression(condition);
+            const bool isCondition = root && ((root->kind == ExpressionNode::Kind::Binary &&
+                                               binaryPrecedence(root->text) <= binaryPrecedence(QStringLiteral("<"))) ||
+                                              (root->kind == ExpressionNode::Kind::Unary && root->text == QStringLiteral("!")));
+            if (!isCondition)
             {
-                QString keyword;
-                QString op;
-            } ops[] = {
-                {QStringLiteral("mayor que"), QStringLiteral(">")},
-                {QStringLiteral("menor que"), QStringLiteral("<")},
-                {QStringLiteral("mayor o igual que"), QStringLiteral(">=")},
-                {QStringLiteral("menor o igual que"), QStringLiteral("<=")},
-                {QStringLiteral("igual a"), QStringLiteral("==")},
-                {QStringLiteral("diferente de"), QStringLiteral("!=")}};
-
-            for (const auto &entry : ops)
+                return QString();
+            }
+            if (root->kind == ExpressionNode::Kind::Binary && root->text == QStringLiteral("==") &&
+                root->right->kind == ExpressionNode::Kind::Identifier && root->right->text == QStringLiteral("false"))
             {
-                int idx = normalized.indexOf(entry.keyword);
-                if (idx >= 0)
-                {
-                    QString left = normalized.left(idx).trimmed();
-                    QString right = normalized.mid(idx + entry.keyword.size()).trimmed();
-
-                    QString leftExpr = translateExpressionPart(left);
-                    QString rightExpr = translateExpressionPart(right);
-
-                    if (!leftExpr.isEmpty() && !rightExpr.isEmpty())
-                    {
-                        if (entry.op == QStringLiteral("==") && rightExpr == QStringLiteral("false"))
-                        {
-                            return QStringLiteral("!%1").arg(leftExpr);
-                        }
-                        return QStringLiteral("%1 %2 %3").arg(leftExpr, entry.op, rightExpr);
-                    }
-                }
+                auto negation = std::make_shared<ExpressionNode>();
+                negation->kind = ExpressionNode::Kind::Unary;
+                negation->text = QStringLiteral("!");
+                negation->left = root->left;
+                root = negation;
             }
-
-            return QString();
+            return foldTree(root);
         }
 
-        QString translateExpressionPart(const QString &part)
+        QString translateOperand(const QString &phrase)
         {
-            QString trimmed = part.trimmed();
-
-            QRegularExpression arrayAccess(QStringLiteral("^([a-zA-Z_][a-zA-Z0-9_]*)\\[([a-zA-Z_][a-zA-Z0-9_]*)\\]$"));
-            QRegularExpressionMatch arrayMatch = arrayAccess.match(trimmed);
-            if (arrayMatch.hasMatch())
-            {
-                QString arrayName = sanitizedIdentifier(arrayMatch.captured(1));
-                QString indexName = sanitizedIdentifier(arrayMatch.captured(2));
-
-                if (!hasCollection(arrayName))
-                {
-                    arrayName = collectionNameForAlias(arrayMatch.captured(1));
-                }
-
-                if (hasCollection(arrayName))
-                {
-                    if (hasVariable(indexName))
-                    {
-                        return QStringLiteral("%1[%2]").arg(arrayName, indexName);
-                    }
-                    else if (hasVariable(QStringLiteral("idx")))
-                    {
-                        return QStringLiteral("%1[idx]").arg(arrayName);
-                    }
-                    else if (hasVariable(QStringLiteral("i")))
-                    {
-                        return QStringLiteral("%1[i]").arg(arrayName);
-                    }
-                    else
-                    {
-                        return QStringLiteral("%1[%2]").arg(arrayName, indexName);
-                    }
-                }
-            }
-
-            QRegularExpression numberRegex(QStringLiteral("^-?\\d+(?:[\\.,]\\d+)?$"));
-            if (numberRegex.match(trimmed).hasMatch())
-            {
-                return ensureNumberString(trimmed, trimmed.contains('.') || trimmed.contains(','));
-            }
-
-            if (trimmed == QStringLiteral("verdadero") || trimmed == QStringLiteral("true"))
-            {
-                return QStringLiteral("true");
-            }
-            if (trimmed == QStringLiteral("falso") || trimmed == QStringLiteral("false"))
-            {
-                return QStringLiteral("false");
-            }
+            QString trimmed = phrase.trimmed();
 
             QString identifier = sanitizedIdentifier(trimmed);
             if (hasVariable(identifier))
@@ -2622,7 +6166,7 @@ namespace
                     return true;
                 }
 
-                m_codeLines.append(indent() + QStringLiteral("} else if (%1) {").arg(conditionExpr));
+                m_codeLines.append(indent() + QStringLiteral("} else if (%1) {").arg(conditionExpr), m_sourceLine);
 
                 ++m_indentLevel;
                 m_blocks.last().hasElseIf = true;
@@ -2641,7 +6185,7 @@ namespace
             {
                 --m_indentLevel;
             }
-            m_codeLines.append(indent() + QStringLiteral("} else {"));
+            m_codeLines.append(indent() + QStringLiteral("} else {"), m_sourceLine);
             ++m_indentLevel;
             m_blocks.last().hasElse = true;
             m_blocks.last().autoClose = true;
@@ -2801,7 +6345,7 @@ namespace
                     matched = true;
                 }
             }
-            else if (normalized.startsWith(QStringLiteral("ingresar valor de cada")) && normalized.contains(QStringLiteral("lista")))
+            else if (normalized.startsWith(QStringLiteral("ingresar valor de cada")) && hasKeywords(KeywordLista))
             {
                 matched = true;
                 collectionAlias = QStringLiteral("lista");
@@ -2818,10 +6362,11 @@ namespace
         bool handleRequestNumberInput(const QString &original, const QString &normalized)
         {
             Q_UNUSED(original);
+            Q_UNUSED(normalized);
 
-            if ((normalized.contains(QStringLiteral("pedir al usuario")) && normalized.contains(QStringLiteral("ingrese")) && normalized.contains(QStringLiteral("numero"))) ||
-                (normalized.contains(QStringLiteral("solicitar")) && normalized.contains(QStringLiteral("usuario")) && normalized.contains(QStringLiteral("numero"))) ||
-                (normalized.contains(QStringLiteral("pedir")) && normalized.contains(QStringLiteral("ingrese")) && normalized.contains(QStringLiteral("consola"))))
+            if (hasKeywords(KeywordPedirAlUsuario | KeywordIngrese | KeywordNumero) ||
+                hasKeywords(KeywordSolicitar | KeywordUsuario | KeywordNumero) ||
+                hasKeywords(KeywordPedir | KeywordIngrese | KeywordConsola))
             {
 
                 return requestInputForCollection(QStringLiteral(""));
@@ -2841,8 +6386,8 @@ namespace
                 normalized.startsWith(QStringLiteral("mostrar todos los elementos de")) ||
                 normalized.startsWith(QStringLiteral("imprimir todos los elementos de la")) ||
                 normalized.startsWith(QStringLiteral("mostrar todos los elementos de la")) ||
-                (normalized.contains(QStringLiteral("imprimir")) && normalized.contains(QStringLiteral("todos los elementos")) && (normalized.contains(QStringLiteral("vector")) || normalized.contains(QStringLiteral("lista")) || normalized.contains(QStringLiteral("arreglo")))) ||
-                (normalized.contains(QStringLiteral("mostrar")) && normalized.contains(QStringLiteral("todos los elementos")) && (normalized.contains(QStringLiteral("vector")) || normalized.contains(QStringLiteral("lista")) || normalized.contains(QStringLiteral("arreglo")))))
+                ((m_keywords & (KeywordImprimir | KeywordMostrar)) && hasKeywords(KeywordTodosLosElementos) &&
+                 (m_keywords & (KeywordVector | KeywordLista | KeywordArreglo))))
             {
                 isPrintCollectionInstruction = true;
             }
@@ -2905,9 +6450,7 @@ namespace
                 normalized.startsWith(QStringLiteral("leer los datos desde")) ||
                 normalized.startsWith(QStringLiteral("cargar los datos desde")) ||
                 normalized.startsWith(QStringLiteral("importar los datos desde")) ||
-                (normalized.contains(QStringLiteral("leer")) && normalized.contains(QStringLiteral("archivo"))) ||
-                (normalized.contains(QStringLiteral("cargar")) && normalized.contains(QStringLiteral("archivo"))) ||
-                (normalized.contains(QStringLiteral("importar")) && normalized.contains(QStringLiteral("archivo"))))
+                ((m_keywords & (KeywordLeer | KeywordCargar | KeywordImportar)) && hasKeywords(KeywordArchivo)))
             {
                 isDataReadInstruction = true;
             }
@@ -3005,6 +6548,7 @@ namespace
             {
                 collIt.value().size = lines.size();
             }
+            checkEmbeddedData(lines.size());
 
             return true;
         }
@@ -3074,6 +6618,7 @@ namespace
                     collIt.value().size = processedLines;
                 }
             }
+            checkEmbeddedData(processedLines * columnCount);
 
             return true;
         }
@@ -3105,8 +6650,7 @@ namespace
             bool isPrintPairsInstruction = false;
             if (normalized.startsWith(QStringLiteral("imprimir los paises")) ||
                 normalized.startsWith(QStringLiteral("mostrar los paises")) ||
-                (normalized.contains(QStringLiteral("imprimir")) && normalized.contains(QStringLiteral("paises")) && normalized.contains(QStringLiteral("capitales"))) ||
-                (normalized.contains(QStringLiteral("mostrar")) && normalized.contains(QStringLiteral("paises")) && normalized.contains(QStringLiteral("capitales"))))
+                ((m_keywords & (KeywordImprimir | KeywordMostrar)) && hasKeywords(KeywordPaises | KeywordCapitales)))
             {
                 isPrintPairsInstruction = true;
             }
@@ -3174,6 +6718,7 @@ namespace
             QRegularExpressionMatchIterator fieldIt = fieldRe.globalMatch(fieldsText);
 
             StructInfo structInfo;
+            structInfo.sourceLine = m_sourceLine;
             structInfo.name = structName;
 
             while (fieldIt.hasNext())
@@ -3182,24 +6727,11 @@ namespace
                 QString fieldName = fieldMatch.captured(1).trimmed();
                 QString fieldTypeText = fieldMatch.captured(2).trimmed();
 
-                QString fieldType;
-                if (fieldTypeText.contains(QStringLiteral("cadena de texto")) || fieldTypeText.contains(QStringLiteral("texto")))
+                const QString fieldType = typeFromWords(fieldTypeText, QStringLiteral("int"));
+                if (fieldType == QStringLiteral("std::string"))
                 {
-                    fieldType = QStringLiteral("std::string");
                     ensureInclude("string");
                 }
-                else if (fieldTypeText.contains(QStringLiteral("entero")))
-                {
-                    fieldType = QStringLiteral("int");
-                }
-                else if (fieldTypeText.contains(QStringLiteral("decimal")))
-                {
-                    fieldType = QStringLiteral("double");
-                }
-                else
-                {
-                    fieldType = QStringLiteral("int");
-                }
 
                 structInfo.fieldNames << fieldName;
                 structInfo.fieldTypes << fieldType;
@@ -3211,6 +6743,12 @@ namespace
                 return false;
             }
 
+            structInfo.structOfArrays = m_structOfArrays.contains(structName);
+            if (structInfo.structOfArrays)
+            {
+                ensureInclude("vector");
+            }
+
             m_structs.insert(structName, structInfo);
             return true;
         }
@@ -3252,7 +6790,12 @@ namespace
             collInfo.fixedSize = true;
             collInfo.isCArray = false;
 
-            addCodeLine(QStringLiteral("std::vector<%1> %2(%3);").arg(structType, uniqueCollectionName, sizeStr));
+            if (m_structs.value(structType).structOfArrays)
+            {
+                collInfo.type = structOfArraysTypeName(structType);
+            }
+
+            addCodeLine(QStringLiteral("%1 %2(%3);").arg(collInfo.type, uniqueCollectionName, sizeStr));
             registerCollection(uniqueCollectionName, collInfo);
 
             return true;
@@ -3331,11 +6874,11 @@ namespace
                 }
                 else if (fieldType == QStringLiteral("int"))
                 {
-                    promptMessage = QStringLiteral("\"Ingrese la %1 de \" << %2[%3].nombre << \": \"").arg(fieldName, collectionName, indexName);
+                    promptMessage = QStringLiteral("\"Ingrese la %1 de \" << %2 << \": \"").arg(fieldName, structFieldAccess(structInfo, collectionName, indexName, QStringLiteral("nombre")));
                 }
-                else if (fieldType == QStringLiteral("double"))
+                else
                 {
-                    promptMessage = QStringLiteral("\"Ingrese la %1 de \" << %2[%3].nombre << \": \"").arg(fieldName, collectionName, indexName);
+                    promptMessage = QStringLiteral("\"Ingrese la %1 de \" << %2 << \": \"").arg(fieldName, structFieldAccess(structInfo, collectionName, indexName, QStringLiteral("nombre")));
                 }
 
                 if (i == 0)
@@ -3344,7 +6887,7 @@ namespace
                 }
 
                 addCodeLine(QStringLiteral("std::cout << %1;").arg(promptMessage));
-                addCodeLine(QStringLiteral("std::cin >> %1[%2].%3;").arg(collectionName, indexName, fieldName));
+                addCodeLine(QStringLiteral("std::cin >> %1;").arg(structFieldAccess(structInfo, collectionName, indexName, fieldName)));
 
                 if (i < structInfo.fieldNames.size() - 1)
                 {
@@ -3408,7 +6951,19 @@ namespace
             addCodeLine(QStringLiteral("std::cout << \"\\n--- Registro de estudiantes ---\\n\";"));
 
             QString iteratorName = QStringLiteral("est");
-            addCodeLine(QStringLiteral("for (const auto& %1 : %2) {").arg(iteratorName, collectionName));
+            if (structInfo.structOfArrays)
+            {
+                iteratorName = QStringLiteral("i");
+                if (hasVariable(iteratorName))
+                {
+                    iteratorName = QStringLiteral("i%1").arg(m_tempCounter++);
+                }
+                addCodeLine(QStringLiteral("for (std::size_t %1 = 0; %1 < %2.size(); ++%1) {").arg(iteratorName, collectionName));
+            }
+            else
+            {
+                addCodeLine(QStringLiteral("for (const auto& %1 : %2) {").arg(iteratorName, collectionName));
+            }
             ++m_indentLevel;
 
             QStringList outputParts;
@@ -3423,7 +6978,10 @@ namespace
                         QString displayName = requestedField;
                         displayName[0] = displayName[0].toUpper();
 
-                        outputParts << QStringLiteral("\"%1: \" << %2.%3").arg(displayName, iteratorName, structField);
+                        QString access = structInfo.structOfArrays
+                                             ? structFieldAccess(structInfo, collectionName, iteratorName, structField)
+                                             : QStringLiteral("%1.%2").arg(iteratorName, structField);
+                        outputParts << QStringLiteral("\"%1: \" << %2").arg(displayName, access);
                         fieldExists = true;
                         break;
                     }
@@ -3449,17 +7007,28 @@ namespace
 
     private:
         const Parser::Input m_input;
-        QStringList m_codeLines;
+        CodeLines m_codeLines;
         QVector<QPair<int, QString>> m_startupLines;
+        QVector<int> m_startupOrigins;
+        int m_sourceLine = -1;
         QSet<QString> m_includes;
         QVector<BlockState> m_blocks;
         QMap<QString, VariableInfo> m_variables;
         QMap<QString, CollectionInfo> m_collections;
         QStringList m_collectionOrder;
         QMap<QString, FunctionInfo> m_functions;
+        QVector<CallSite> m_callSites;
+        QSet<QString> m_reassignedVariables;
+        QMap<QString, QMap<QString, QString>> m_constantValues;
+        QMap<QString, SumAccumulator> m_sumAccumulators;
+        int m_foldedExpressions = 0;
         QMap<QString, StructInfo> m_structs;
+        QSet<QString> m_structOfArrays;
         QString m_lastCollection;
         QStringList m_issues;
+        QStringList m_optimizationNotes;
+        QList<Parser::Diagnostic> m_diagnostics;
+        KeywordMask m_keywords = 0;
         bool m_success = true;
         int m_indentLevel = 1;
         int m_currentIndent = 0;
@@ -3476,3 +7045,29 @@ Parser::Output Parser::convert(const Parser::Input &input)
     InstructionParser parser(input);
     return parser.run();
 }
+
+QString Parser::describeDiagnostic(const Parser::Diagnostic &diagnostic)
+{
+    return QStringLiteral("Línea %1: %2").arg(diagnostic.line + 1).arg(diagnostic.message);
+}
+
+QString Parser::profileFileName()
+{
+    return QStringLiteral("instacode_perfil.txt");
+}
+
+QString Parser::umbrellaHeaderName()
+{
+    return QStringLiteral("instacode_pch.h");
+}
+
+QString Parser::umbrellaHeaderContents(const QStringList &includes)
+{
+    QStringList lines;
+    lines << QStringLiteral("#pragma once");
+    for (const QString &include : includes)
+    {
+        lines << QStringLiteral("#include <%1>").arg(include);
+    }
+    return lines.join('\n') + QLatin1Char('\n');
+}
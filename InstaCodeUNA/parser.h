@@ -1,24 +1,69 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <QList>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 class Parser {
 public:
+    enum class StructLayout {
+        Automatic,
+        ArrayOfStructs,
+        StructOfArrays
+    };
+
     struct Input {
         QString instructions;
         QString dataFileContents;
         QString dataFileName;
+        StructLayout structLayout = StructLayout::Automatic;
+        bool packStructs = false;
+        bool umbrellaHeader = false;
+        bool multipleFiles = false;
+        bool profile = false;
+    };
+
+    enum class DiagnosticKind {
+        NestedLoop,
+        SortInLoop,
+        SearchInLoop,
+        LargeEmbeddedData
+    };
+
+    // Advertencia de rendimiento detectada sin ejecutar el programa; line es la línea de
+    // instrucciones (base 0) que la origina.
+    struct Diagnostic {
+        int line = -1;
+        DiagnosticKind kind = DiagnosticKind::NestedLoop;
+        QString message;
+    };
+
+    struct SourceFile {
+        QString name;
+        QString contents;
     };
 
     struct Output {
         QString code;
         QStringList issues;
+        QStringList optimizationNotes;
+        QStringList includes;
+        QList<SourceFile> files;
+        QList<Diagnostic> diagnostics;
+        // Línea de instrucciones (base 0) de cada línea de code, o -1, y la primera línea de
+        // code generada por cada línea de instrucciones, o -1.
+        QVector<int> sourceLines;
+        QVector<int> generatedLines;
         bool success = true;
     };
 
     static Output convert(const Input &input);
+    static QString describeDiagnostic(const Diagnostic &diagnostic);
+    static QString profileFileName();
+    static QString umbrellaHeaderName();
+    static QString umbrellaHeaderContents(const QStringList &includes);
 };
 
 #endif 
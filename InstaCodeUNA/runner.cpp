@@ -0,0 +1,787 @@
+#include "runner.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "parser.h"
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+    bool writeFile(const QString &path, const QByteArray &contents)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            return false;
+        }
+        return file.write(contents) == contents.size();
+    }
+
+    QString readLimited(const QString &path, qint64 limit)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return QString();
+        }
+        return QString::fromUtf8(file.read(limit));
+    }
+
+    QString signalName(int signal)
+    {
+#ifdef Q_OS_UNIX
+        switch (signal)
+        {
+        case SIGSEGV:
+            return QStringLiteral("violación de segmento (SIGSEGV)");
+        case SIGABRT:
+            return QStringLiteral("terminación anormal (SIGABRT)");
+        case SIGFPE:
+            return QStringLiteral("error aritmético (SIGFPE)");
+        case SIGKILL:
+            return QStringLiteral("proceso detenido (SIGKILL)");
+        case SIGXCPU:
+            return QStringLiteral("límite de tiempo de CPU excedido (SIGXCPU)");
+        case SIGXFSZ:
+            return QStringLiteral("límite de salida excedido (SIGXFSZ)");
+        case SIGBUS:
+            return QStringLiteral("error de bus (SIGBUS)");
+        default:
+            break;
+        }
+#endif
+        return QStringLiteral("señal %1").arg(signal);
+    }
+
+    struct CacheCounters
+    {
+        int hits = 0;
+        int misses = 0;
+    };
+
+    CacheCounters &cacheCounters()
+    {
+        static CacheCounters counters;
+        return counters;
+    }
+
+    QStringList compilerFlags(const Runner::Input &input)
+    {
+        return QStringList() << QStringLiteral("-std=c++17") << Runner::optimizationFlags(input.optimization);
+    }
+
+    QStringList compilerIdentity(const QString &compilerPath)
+    {
+        const QFileInfo compiler(compilerPath);
+        return QStringList() << compiler.canonicalFilePath() << QString::number(compiler.lastModified().toMSecsSinceEpoch());
+    }
+
+    QString hashOf(const QStringList &parts)
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        for (const QString &part : parts)
+        {
+            hash.addData(part.toUtf8());
+            hash.addData(QByteArray(1, '\0'));
+        }
+        return QString::fromLatin1(hash.result().toHex());
+    }
+
+    // La clave cubre el código, las banderas y el compilador exacto (ruta y fecha), de modo
+    // que actualizar g++ o cambiar el nivel de optimización nunca reutiliza un binario viejo.
+    QString cacheKey(const Runner::Input &input, const QString &compilerPath)
+    {
+        return hashOf(QStringList() << input.code << compilerFlags(input) << compilerIdentity(compilerPath)
+                                    << input.includes.join(QLatin1Char(',')));
+    }
+
+    QString cacheRoot(const Runner::Input &input)
+    {
+        if (!input.cacheDirectory.isEmpty())
+        {
+            return input.cacheDirectory;
+        }
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    }
+
+    void pruneCache(const QDir &directory, int maximumEntries)
+    {
+        const QFileInfoList entries = directory.entryInfoList(QDir::Files, QDir::Time);
+        for (int i = maximumEntries; i < entries.size(); ++i)
+        {
+            QFile::remove(entries[i].absoluteFilePath());
+        }
+    }
+
+    void storeInCache(const QString &binary, const QString &cached, int maximumEntries)
+    {
+        const QFileInfo target(cached);
+        if (!QDir().mkpath(target.absolutePath()))
+        {
+            return;
+        }
+        // Se copia a un nombre temporal y se renombra para que otra instancia nunca vea un binario a medias.
+        const QString partial = cached + QStringLiteral(".parcial-") + QString::number(QCoreApplication::applicationPid());
+        QFile::remove(partial);
+        if (!QFile::copy(binary, partial))
+        {
+            return;
+        }
+        QFile::remove(cached);
+        if (!QFile::rename(partial, cached))
+        {
+            QFile::remove(partial);
+            return;
+        }
+        pruneCache(target.absoluteDir(), maximumEntries);
+    }
+
+    bool runCompiler(const Runner::Input &input, const QString &compilerPath, const QStringList &arguments,
+                     const QString &directory, Runner::Output &output, double &elapsedMs)
+    {
+        QProcess process;
+        process.setWorkingDirectory(directory);
+        process.setProcessChannelMode(QProcess::MergedChannels);
+        QElapsedTimer timer;
+        timer.start();
+        process.start(compilerPath, arguments);
+        if (!process.waitForStarted())
+        {
+            output.errors << QStringLiteral("No se pudo iniciar %1.").arg(compilerPath);
+            return false;
+        }
+        if (!process.waitForFinished(input.compileTimeLimitMs))
+        {
+            process.kill();
+            process.waitForFinished();
+            output.errors << QStringLiteral("La compilación superó el límite de %1 ms.").arg(input.compileTimeLimitMs);
+            return false;
+        }
+        elapsedMs = timer.nsecsElapsed() / 1.0e6;
+        output.compilerMessages += QString::fromLocal8Bit(process.readAll());
+        if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+        {
+            output.errors << QStringLiteral("La compilación falló.");
+            return false;
+        }
+        return true;
+    }
+
+    bool isClang(const QString &compilerPath)
+    {
+        static QHash<QString, bool> known;
+        const auto it = known.constFind(compilerPath);
+        if (it != known.constEnd())
+        {
+            return it.value();
+        }
+        QProcess process;
+        process.start(compilerPath, QStringList() << QStringLiteral("--version"));
+        const bool clang = process.waitForFinished(10000) &&
+                           QString::fromLocal8Bit(process.readAllStandardOutput()).contains(QStringLiteral("clang"));
+        known.insert(compilerPath, clang);
+        return clang;
+    }
+
+    bool writeAtomically(const QString &path, const QByteArray &contents)
+    {
+        const QString partial = path + QStringLiteral(".parcial-") + QString::number(QCoreApplication::applicationPid());
+        if (!writeFile(partial, contents))
+        {
+            return false;
+        }
+        if (!QFile::rename(partial, path))
+        {
+            QFile::remove(partial);
+            return QFileInfo::exists(path);
+        }
+        return true;
+    }
+
+    // El encabezado paraguas y su versión precompilada viven en la caché bajo una clave que cubre
+    // el conjunto de includes, las banderas y el compilador; g++ y clang++ solo aceptan el .gch/.pch
+    // si se compila con las mismas banderas, así que cada combinación tiene el suyo.
+    bool prepareUmbrellaHeader(const Runner::Input &input, const QString &temporaryDirectory,
+                               Runner::Output &output, QStringList &flags)
+    {
+        const QByteArray header = Parser::umbrellaHeaderContents(input.includes).toUtf8();
+        if (!input.precompiledHeader)
+        {
+            flags << QStringLiteral("-I") << temporaryDirectory;
+            return writeFile(QDir(temporaryDirectory).filePath(Parser::umbrellaHeaderName()), header);
+        }
+
+        const bool clang = isClang(output.compilerPath);
+        const QString key = hashOf(QStringList() << QString::fromUtf8(header) << compilerFlags(input)
+                                                 << compilerIdentity(output.compilerPath));
+        const QDir directory(QDir(cacheRoot(input)).filePath(QStringLiteral("encabezados/") + key));
+        const QString headerPath = directory.filePath(Parser::umbrellaHeaderName());
+        const QString precompiled = headerPath + (clang ? QStringLiteral(".pch") : QStringLiteral(".gch"));
+        output.precompiledHeader = true;
+        flags << QStringLiteral("-I") << directory.path();
+        if (clang)
+        {
+            flags << QStringLiteral("-include-pch") << precompiled;
+        }
+        else
+        {
+            flags << QStringLiteral("-Winvalid-pch");
+        }
+
+        if (QFileInfo::exists(precompiled))
+        {
+            output.precompiledHeaderReused = true;
+            return true;
+        }
+        if (!directory.mkpath(QStringLiteral(".")) ||
+            (!QFileInfo::exists(headerPath) && !writeAtomically(headerPath, header)))
+        {
+            output.errors << QStringLiteral("No se pudo preparar el encabezado precompilado en %1.").arg(directory.path());
+            return false;
+        }
+
+        const QString partial = precompiled + QStringLiteral(".parcial-") + QString::number(QCoreApplication::applicationPid());
+        QStringList arguments = compilerFlags(input);
+        arguments << QStringLiteral("-x") << QStringLiteral("c++-header") << headerPath << QStringLiteral("-o") << partial;
+        if (!runCompiler(input, output.compilerPath, arguments, directory.path(), output, output.precompiledHeaderMs))
+        {
+            QFile::remove(partial);
+            return false;
+        }
+        if (!QFile::rename(partial, precompiled))
+        {
+            QFile::remove(partial);
+        }
+        return true;
+    }
+
+    bool compile(const Runner::Input &input, const QString &directory, const QString &binary, Runner::Output &output)
+    {
+        const QString source = QDir(directory).filePath(QStringLiteral("programa.cpp"));
+        if (!writeFile(source, input.code.toUtf8()))
+        {
+            output.errors << QStringLiteral("No se pudo escribir el código en %1.").arg(source);
+            return false;
+        }
+
+        output.compilerArguments = compilerFlags(input);
+        const QString umbrella = QStringLiteral("#include \"%1\"").arg(Parser::umbrellaHeaderName());
+        if (input.code.contains(umbrella) && !prepareUmbrellaHeader(input, directory, output, output.compilerArguments))
+        {
+            return false;
+        }
+        output.compilerArguments << source << QStringLiteral("-o") << binary;
+        return runCompiler(input, output.compilerPath, output.compilerArguments, directory, output, output.compileTimeMs);
+    }
+
+#ifdef Q_OS_UNIX
+    const int ResultDescriptor = 3;
+
+    void limitResource(int resource, rlim_t soft, rlim_t hard)
+    {
+        struct rlimit limit;
+        limit.rlim_cur = soft;
+        limit.rlim_max = hard;
+        setrlimit(resource, &limit);
+    }
+
+    void applyLimits(rlim_t cpuSeconds, rlim_t outputBytes, rlim_t memoryBytes)
+    {
+        limitResource(RLIMIT_CPU, cpuSeconds, cpuSeconds + 1);
+        limitResource(RLIMIT_FSIZE, outputBytes, outputBytes);
+        limitResource(RLIMIT_CORE, 0, 0);
+#ifndef Q_OS_MACOS
+        limitResource(RLIMIT_AS, memoryBytes, memoryBytes);
+#else
+        Q_UNUSED(memoryBytes);
+#endif
+    }
+
+    qint64 peakKilobytes(const struct rusage &usage)
+    {
+#ifdef Q_OS_MACOS
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+
+    double cpuMilliseconds(const struct rusage &usage)
+    {
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+    }
+
+    // Un hijo creado con fork hereda como pico de memoria la memoria anónima del padre, así que
+    // medir desde la interfaz (decenas de MB) inflaría el resultado de un programa pequeño. Por eso
+    // el programa se lanza a través de "InstaCodeUNA --medir", un proceso recién iniciado que hace
+    // el fork/exec/wait4 y devuelve las cifras por el descriptor 3.
+    bool execute(const Runner::Input &input, const QString &binary, const QString &inputPath,
+                 const QString &outputPath, const QString &errorPath, Runner::Output &output)
+    {
+        const QByteArray launcher = QFile::encodeName(QCoreApplication::applicationFilePath());
+        const QByteArray program = QFile::encodeName(binary);
+        const QByteArray inputFile = QFile::encodeName(inputPath);
+        const QByteArray outputFile = QFile::encodeName(outputPath);
+        const QByteArray errorFile = QFile::encodeName(errorPath);
+        const QByteArray resultFile = outputFile + ".medicion";
+        const QByteArray workingDirectory = QFile::encodeName(QFileInfo(inputPath).absolutePath());
+        const rlim_t cpuLimit = static_cast<rlim_t>(std::max(1, input.cpuLimitSeconds));
+        const rlim_t outputLimit = static_cast<rlim_t>(input.outputLimitBytes);
+        const rlim_t memoryLimit = static_cast<rlim_t>(input.memoryLimitBytes);
+        const QByteArray cpuArgument = QByteArray::number(static_cast<qulonglong>(cpuLimit));
+        const QByteArray outputArgument = QByteArray::number(static_cast<qulonglong>(outputLimit));
+        const QByteArray memoryArgument = QByteArray::number(static_cast<qulonglong>(memoryLimit));
+        const bool measured = !launcher.isEmpty();
+
+        QElapsedTimer timer;
+        timer.start();
+        const pid_t pid = fork();
+        if (pid < 0)
+        {
+            output.errors << QStringLiteral("No se pudo crear el proceso del programa.");
+            return false;
+        }
+        if (pid == 0)
+        {
+            setpgid(0, 0);
+            if (chdir(workingDirectory.constData()) != 0)
+            {
+                _exit(126);
+            }
+            const int in = open(inputFile.constData(), O_RDONLY);
+            const int out = open(outputFile.constData(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            const int err = open(errorFile.constData(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            const int result = measured ? open(resultFile.constData(), O_WRONLY | O_CREAT | O_TRUNC, 0600) : 0;
+            if (in < 0 || out < 0 || err < 0 || result < 0)
+            {
+                _exit(126);
+            }
+            dup2(in, STDIN_FILENO);
+            dup2(out, STDOUT_FILENO);
+            dup2(err, STDERR_FILENO);
+            if (measured)
+            {
+                dup2(result, ResultDescriptor);
+                execl(launcher.constData(), launcher.constData(), "--medir", cpuArgument.constData(),
+                      outputArgument.constData(), memoryArgument.constData(), program.constData(), static_cast<char *>(nullptr));
+            }
+            else
+            {
+                applyLimits(cpuLimit, outputLimit, memoryLimit);
+                execl(program.constData(), program.constData(), static_cast<char *>(nullptr));
+            }
+            _exit(127);
+        }
+        setpgid(pid, pid);
+
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool exited = false;
+        bool timedOut = false;
+        std::thread watchdog([&]() {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!finished.wait_for(lock, std::chrono::milliseconds(input.timeLimitMs), [&]() { return exited; }))
+            {
+                timedOut = true;
+                kill(-pid, SIGKILL);
+            }
+        });
+
+        siginfo_t info;
+        while (waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOWAIT) < 0 && errno == EINTR)
+        {
+        }
+        output.wallTimeMs = timer.nsecsElapsed() / 1.0e6;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            exited = true;
+        }
+        finished.notify_one();
+        watchdog.join();
+
+        int status = 0;
+        struct rusage usage;
+        while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR)
+        {
+        }
+        output.timedOut = timedOut;
+        if (measured)
+        {
+            QFile result(QFile::decodeName(resultFile));
+            const QList<QByteArray> fields = result.open(QIODevice::ReadOnly) ? result.readAll().trimmed().split(' ') : QList<QByteArray>();
+            if (fields.size() == 4)
+            {
+                status = fields[0].toInt();
+                output.wallTimeMs = fields[1].toLongLong() / 1.0e6;
+                output.cpuTimeMs = fields[2].toLongLong() / 1000.0;
+                output.peakMemoryKb = fields[3].toLongLong();
+            }
+            else if (!timedOut)
+            {
+                output.errors << QStringLiteral("No se pudo medir la ejecución del programa.");
+                return false;
+            }
+        }
+        else
+        {
+            output.cpuTimeMs = cpuMilliseconds(usage);
+            output.peakMemoryKb = peakKilobytes(usage);
+        }
+
+        if (!timedOut && WIFEXITED(status))
+        {
+            output.exitCode = WEXITSTATUS(status);
+            return true;
+        }
+        output.signal = timedOut ? SIGKILL : (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+        output.exitCode = 128 + output.signal;
+        if (timedOut)
+        {
+            output.errors << QStringLiteral("El programa superó el límite de %1 ms y fue detenido.").arg(input.timeLimitMs);
+        }
+        else
+        {
+            output.errors << QStringLiteral("El programa terminó por %1.").arg(signalName(output.signal));
+        }
+        return false;
+    }
+#else
+    bool execute(const Runner::Input &input, const QString &binary, const QString &inputPath,
+                 const QString &outputPath, const QString &errorPath, Runner::Output &output)
+    {
+        QProcess process;
+        process.setWorkingDirectory(QFileInfo(inputPath).absolutePath());
+        process.setStandardInputFile(inputPath);
+        process.setStandardOutputFile(outputPath);
+        process.setStandardErrorFile(errorPath);
+        QElapsedTimer timer;
+        timer.start();
+        process.start(binary, QStringList());
+        if (!process.waitForStarted())
+        {
+            output.errors << QStringLiteral("No se pudo iniciar el programa compilado.");
+            return false;
+        }
+        if (!process.waitForFinished(input.timeLimitMs))
+        {
+            process.kill();
+            process.waitForFinished();
+            output.timedOut = true;
+        }
+        output.wallTimeMs = timer.nsecsElapsed() / 1.0e6;
+        output.exitCode = process.exitCode();
+        if (output.timedOut)
+        {
+            output.errors << QStringLiteral("El programa superó el límite de %1 ms y fue detenido.").arg(input.timeLimitMs);
+            return false;
+        }
+        if (process.exitStatus() != QProcess::NormalExit)
+        {
+            output.errors << QStringLiteral("El programa terminó de forma anormal.");
+            return false;
+        }
+        return true;
+    }
+#endif
+}
+
+QString Runner::findCompiler(Runner::Compiler compiler)
+{
+    QStringList candidates;
+    switch (compiler)
+    {
+    case Compiler::Gcc:
+        candidates << QStringLiteral("g++");
+        break;
+    case Compiler::Clang:
+        candidates << QStringLiteral("clang++");
+        break;
+    case Compiler::Automatic:
+        candidates << QStringLiteral("g++") << QStringLiteral("clang++") << QStringLiteral("c++");
+        break;
+    }
+    for (const QString &candidate : candidates)
+    {
+        const QString path = QStandardPaths::findExecutable(candidate);
+        if (!path.isEmpty())
+        {
+            return path;
+        }
+    }
+    return QString();
+}
+
+QStringList Runner::optimizationFlags(Runner::OptimizationLevel level)
+{
+    switch (level)
+    {
+    case OptimizationLevel::O0:
+        return {QStringLiteral("-O0")};
+    case OptimizationLevel::O2:
+        return {QStringLiteral("-O2")};
+    case OptimizationLevel::O3Native:
+        return {QStringLiteral("-O3"), QStringLiteral("-march=native")};
+    }
+    return QStringList();
+}
+
+Runner::Output Runner::run(const Runner::Input &input)
+{
+    Output output;
+    QTemporaryDir directory;
+    if (!directory.isValid())
+    {
+        output.errors << QStringLiteral("No se pudo crear un directorio temporal.");
+        return output;
+    }
+
+    output.compilerPath = findCompiler(input.compiler);
+    if (output.compilerPath.isEmpty())
+    {
+        output.errors << QStringLiteral("No se encontró un compilador de C++ (g++ o clang++) en el PATH.");
+        return output;
+    }
+
+    QString binary = directory.filePath(QStringLiteral("programa"));
+    QString cached;
+    if (input.useCache)
+    {
+        output.cacheKey = cacheKey(input, output.compilerPath);
+        cached = QDir(cacheRoot(input)).filePath(QStringLiteral("programas/") + output.cacheKey);
+        output.cacheHit = QFileInfo(cached).isExecutable();
+    }
+    if (output.cacheHit)
+    {
+        ++cacheCounters().hits;
+        QFile touched(cached);
+        if (touched.open(QIODevice::ReadWrite))
+        {
+            touched.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        }
+        binary = cached;
+        output.compilerArguments = compilerFlags(input);
+        output.compiled = true;
+    }
+    else
+    {
+        if (input.useCache)
+        {
+            ++cacheCounters().misses;
+        }
+        output.compiled = compile(input, directory.path(), binary, output);
+        if (!output.compiled)
+        {
+            return output;
+        }
+        if (input.useCache)
+        {
+            storeInCache(binary, cached, input.cacheEntries);
+        }
+    }
+
+    const QString inputPath = directory.filePath(QStringLiteral("entrada.txt"));
+    const QString outputPath = directory.filePath(QStringLiteral("salida.txt"));
+    const QString errorPath = directory.filePath(QStringLiteral("errores.txt"));
+    if (!writeFile(inputPath, input.standardInput.toUtf8()))
+    {
+        output.errors << QStringLiteral("No se pudo preparar la entrada del programa.");
+        return output;
+    }
+
+    output.success = execute(input, binary, inputPath, outputPath, errorPath, output);
+    output.standardOutput = readLimited(outputPath, input.outputLimitBytes);
+    output.standardError = readLimited(errorPath, input.outputLimitBytes);
+    const QString profilePath = directory.filePath(Parser::profileFileName());
+    if (QFileInfo::exists(profilePath))
+    {
+        output.profile = parseProfile(readLimited(profilePath, input.outputLimitBytes));
+    }
+    return output;
+}
+
+QString Runner::describeProfile(const QList<Runner::ProfileLine> &profile, int maximumLines)
+{
+    qint64 total = 0;
+    for (const ProfileLine &line : profile)
+    {
+        total += line.nanoseconds;
+    }
+    QStringList lines;
+    for (int i = 0; i < profile.size() && i < maximumLines; ++i)
+    {
+        lines << QStringLiteral("Línea %1: %2 % del tiempo, %3 ejecuciones")
+                     .arg(profile[i].line)
+                     .arg(total > 0 ? 100.0 * profile[i].nanoseconds / total : 0.0, 0, 'f', 1)
+                     .arg(profile[i].executions);
+    }
+    return lines.join('\n');
+}
+
+QList<Runner::ProfileLine> Runner::parseProfile(const QString &text)
+{
+    QList<ProfileLine> lines;
+    for (const QString &entry : text.split('\n', Qt::SkipEmptyParts))
+    {
+        const QStringList fields = entry.split(' ', Qt::SkipEmptyParts);
+        if (fields.size() != 3)
+        {
+            continue;
+        }
+        ProfileLine line;
+        line.line = fields[0].toInt();
+        line.executions = fields[1].toLongLong();
+        line.nanoseconds = fields[2].toLongLong();
+        if (line.line > 0)
+        {
+            lines.append(line);
+        }
+    }
+    std::sort(lines.begin(), lines.end(), [](const ProfileLine &a, const ProfileLine &b) {
+        return a.nanoseconds > b.nanoseconds;
+    });
+    return lines;
+}
+
+bool Runner::isMeasurementRequest(int argc, char *argv[])
+{
+#ifdef Q_OS_UNIX
+    return argc == 6 && std::strcmp(argv[1], "--medir") == 0;
+#else
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+    return false;
+#endif
+}
+
+int Runner::measure(int argc, char *argv[])
+{
+#ifdef Q_OS_UNIX
+    Q_UNUSED(argc);
+    const rlim_t cpuLimit = std::strtoull(argv[2], nullptr, 10);
+    const rlim_t outputLimit = std::strtoull(argv[3], nullptr, 10);
+    const rlim_t memoryLimit = std::strtoull(argv[4], nullptr, 10);
+    const char *program = argv[5];
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        return 1;
+    }
+    if (pid == 0)
+    {
+        close(ResultDescriptor);
+        applyLimits(cpuLimit, outputLimit, memoryLimit);
+        execl(program, program, static_cast<char *>(nullptr));
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR)
+    {
+    }
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const long long wall = (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+    const long long cpu = static_cast<long long>(cpuMilliseconds(usage) * 1000.0);
+
+    char line[128];
+    const int length = std::snprintf(line, sizeof(line), "%d %lld %lld %lld\n", status, wall, cpu,
+                                     static_cast<long long>(peakKilobytes(usage)));
+    return write(ResultDescriptor, line, static_cast<std::size_t>(length)) == length ? 0 : 1;
+#else
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+    return 1;
+#endif
+}
+
+Runner::CacheStatistics Runner::cacheStatistics()
+{
+    CacheStatistics statistics;
+    statistics.hits = cacheCounters().hits;
+    statistics.misses = cacheCounters().misses;
+    return statistics;
+}
+
+QString Runner::describe(const Runner::Output &output)
+{
+    QStringList lines;
+    const QString compiler = QFileInfo(output.compilerPath).fileName();
+    QStringList flags;
+    for (const QString &argument : output.compilerArguments)
+    {
+        if (argument.startsWith(QStringLiteral("-O")) || argument.startsWith(QStringLiteral("-march")))
+        {
+            flags << argument;
+        }
+    }
+    if (output.cacheHit)
+    {
+        lines << QStringLiteral("Compilación (%1 %2): reutilizada de la caché").arg(compiler, flags.join(' '));
+    }
+    else
+    {
+        lines << QStringLiteral("Compilación (%1 %2): %3 ms")
+                     .arg(compiler, flags.join(' '))
+                     .arg(output.compileTimeMs, 0, 'f', 0);
+    }
+    if (output.precompiledHeader)
+    {
+        lines << (output.precompiledHeaderReused
+                      ? QStringLiteral("Encabezado precompilado: reutilizado")
+                      : QStringLiteral("Encabezado precompilado: generado en %1 ms").arg(output.precompiledHeaderMs, 0, 'f', 0));
+    }
+    if (!output.compiled)
+    {
+        return lines.join('\n');
+    }
+    if (output.cpuTimeMs >= 0.0)
+    {
+        lines << QStringLiteral("Ejecución: %1 ms reales, %2 ms de CPU")
+                     .arg(output.wallTimeMs, 0, 'f', 2)
+                     .arg(output.cpuTimeMs, 0, 'f', 2);
+    }
+    else
+    {
+        lines << QStringLiteral("Ejecución: %1 ms reales").arg(output.wallTimeMs, 0, 'f', 2);
+    }
+    if (output.peakMemoryKb >= 0)
+    {
+        lines << QStringLiteral("Memoria pico: %1 KB").arg(output.peakMemoryKb);
+    }
+    lines << QStringLiteral("Código de salida: %1").arg(output.exitCode);
+    return lines.join('\n');
+}
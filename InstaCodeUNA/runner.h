@@ -0,0 +1,87 @@
+#ifndef RUNNER_H
+#define RUNNER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+class Runner {
+public:
+    enum class Compiler {
+        Automatic,
+        Gcc,
+        Clang
+    };
+
+    enum class OptimizationLevel {
+        O0,
+        O2,
+        O3Native
+    };
+
+    struct Input {
+        QString code;
+        QString standardInput;
+        QStringList includes;
+        Compiler compiler = Compiler::Automatic;
+        OptimizationLevel optimization = OptimizationLevel::O2;
+        int compileTimeLimitMs = 60000;
+        int timeLimitMs = 10000;
+        int cpuLimitSeconds = 10;
+        qint64 memoryLimitBytes = qint64(1024) * 1024 * 1024;
+        qint64 outputLimitBytes = 4 * 1024 * 1024;
+        bool useCache = true;
+        bool precompiledHeader = true;
+        QString cacheDirectory;
+        int cacheEntries = 200;
+    };
+
+    struct ProfileLine {
+        int line = 0;
+        qint64 executions = 0;
+        qint64 nanoseconds = 0;
+    };
+
+    struct Output {
+        QString compilerPath;
+        QStringList compilerArguments;
+        QString cacheKey;
+        QString compilerMessages;
+        QString standardOutput;
+        QString standardError;
+        QStringList errors;
+        QList<ProfileLine> profile;
+        double compileTimeMs = 0.0;
+        double precompiledHeaderMs = 0.0;
+        double wallTimeMs = 0.0;
+        double cpuTimeMs = -1.0;
+        qint64 peakMemoryKb = -1;
+        int exitCode = -1;
+        int signal = 0;
+        bool compiled = false;
+        bool cacheHit = false;
+        bool precompiledHeader = false;
+        bool precompiledHeaderReused = false;
+        bool timedOut = false;
+        bool success = false;
+    };
+
+    struct CacheStatistics {
+        int hits = 0;
+        int misses = 0;
+    };
+
+    static Output run(const Input &input);
+    static CacheStatistics cacheStatistics();
+    static QString findCompiler(Compiler compiler);
+    static QStringList optimizationFlags(OptimizationLevel level);
+    static QString describe(const Output &output);
+    static QList<ProfileLine> parseProfile(const QString &text);
+    static QString describeProfile(const QList<ProfileLine> &profile, int maximumLines);
+
+    static bool isMeasurementRequest(int argc, char *argv[]);
+    static int measure(int argc, char *argv[]);
+};
+
+#endif
@@ -0,0 +1,345 @@
+#ifndef VOCABULARY_H
+#define VOCABULARY_H
+
+#include <QString>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+// Vocabulario fijo de la gramática. Cada tabla es constexpr y busca con un hash perfecto cuya
+// semilla se elige al compilar: una consulta calcula un hash, mira una sola casilla y compara
+// una clave, sin construir nada en tiempo de ejecución.
+namespace Vocabulary {
+
+template <typename Value>
+struct Entry {
+    std::string_view key;
+    Value value{};
+};
+
+constexpr std::uint32_t mix(std::uint32_t hash, std::uint32_t character)
+{
+    return (hash ^ character) * 16777619u;
+}
+
+constexpr std::uint32_t finish(std::uint32_t hash)
+{
+    return hash ^ (hash >> 15);
+}
+
+constexpr std::uint32_t hash(std::string_view text, std::uint32_t seed)
+{
+    std::uint32_t result = 2166136261u ^ seed;
+    for (char ch : text) {
+        result = mix(result, static_cast<unsigned char>(ch));
+    }
+    return finish(result);
+}
+
+inline std::uint32_t hash(const QString &text, int from, int length, std::uint32_t seed)
+{
+    std::uint32_t result = 2166136261u ^ seed;
+    for (int i = from; i < from + length; ++i) {
+        result = mix(result, text.at(i).unicode());
+    }
+    return finish(result);
+}
+
+inline bool equals(const QString &text, int from, int length, std::string_view key)
+{
+    if (length != static_cast<int>(key.size())) {
+        return false;
+    }
+    for (int i = 0; i < length; ++i) {
+        if (text.at(from + i).unicode() != static_cast<unsigned char>(key[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Con al menos el doble de casillas que claves basta probar unas pocas semillas.
+constexpr std::size_t capacityFor(std::size_t entries)
+{
+    std::size_t capacity = 4;
+    while (capacity < 2 * entries) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+template <typename Value, std::size_t N>
+class Table {
+public:
+    static constexpr std::size_t Capacity = capacityFor(N);
+    static constexpr std::uint32_t MaximumSeed = 100000;
+
+    constexpr explicit Table(const Entry<Value> (&entries)[N])
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            m_entries[i] = entries[i];
+        }
+        if (hasRepeatedKeys()) {
+            m_seed = MaximumSeed;
+        }
+        while (m_seed < MaximumSeed && !place()) {
+            ++m_seed;
+        }
+    }
+
+    // Falso si hay claves repetidas o ninguna semilla las separa; cada tabla lo comprueba con
+    // static_assert.
+    constexpr bool isPerfect() const
+    {
+        return m_seed < MaximumSeed;
+    }
+
+    constexpr const Value *findKey(std::string_view key) const
+    {
+        const int slot = m_slots[hash(key, m_seed) & (Capacity - 1)];
+        return slot > 0 && m_entries[slot - 1].key == key ? &m_entries[slot - 1].value : nullptr;
+    }
+
+    const Entry<Value> *find(const QString &text, int from, int length) const
+    {
+        const int slot = m_slots[hash(text, from, length, m_seed) & (Capacity - 1)];
+        return slot > 0 && equals(text, from, length, m_entries[slot - 1].key) ? &m_entries[slot - 1] : nullptr;
+    }
+
+    const Value *find(const QString &text) const
+    {
+        const Entry<Value> *entry = find(text, 0, text.size());
+        return entry ? &entry->value : nullptr;
+    }
+
+    // Busca la clave más larga formada por las primeras palabras de text, hasta maximumWords.
+    const Entry<Value> *findLeadingWords(const QString &text, int maximumWords) const
+    {
+        int ends[8] = {};
+        int words = 0;
+        for (int i = 0; i <= text.size() && words < maximumWords && words < 8; ++i) {
+            if (i == text.size() || text.at(i) == ' ') {
+                ends[words++] = i;
+            }
+        }
+        for (int word = words - 1; word >= 0; --word) {
+            if (const Entry<Value> *entry = find(text, 0, ends[word])) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    constexpr bool hasRepeatedKeys() const
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            for (std::size_t j = i + 1; j < N; ++j) {
+                if (m_entries[i].key == m_entries[j].key) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    constexpr bool place()
+    {
+        for (int &slot : m_slots) {
+            slot = 0;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            int &slot = m_slots[hash(m_entries[i].key, m_seed) & (Capacity - 1)];
+            if (slot != 0) {
+                return false;
+            }
+            slot = static_cast<int>(i) + 1;
+        }
+        return true;
+    }
+
+    std::array<Entry<Value>, N> m_entries{};
+    std::array<int, Capacity> m_slots{};
+    std::uint32_t m_seed = 0;
+};
+
+template <typename Value, std::size_t N>
+constexpr Table<Value, N> makeTable(const Entry<Value> (&entries)[N])
+{
+    return Table<Value, N>(entries);
+}
+
+// Precedencias de C++ para los operadores binarios.
+inline constexpr auto binaryPrecedences = makeTable<int>({
+    {"||", 1},
+    {"&&", 2},
+    {"==", 3},
+    {"!=", 3},
+    {"<", 4},
+    {">", 4},
+    {"<=", 4},
+    {">=", 4},
+    {"+", 5},
+    {"-", 5},
+    {"*", 6},
+    {"/", 6},
+    {"%", 6},
+});
+static_assert(binaryPrecedences.isPerfect(), "Operadores binarios repetidos");
+
+struct OperatorPhrase {
+    std::string_view words;
+    const char *op = "";
+};
+
+// Frases operador de las expresiones en español, agrupadas por su primera palabra y, dentro de
+// cada grupo, de la más larga a la más corta.
+inline constexpr OperatorPhrase operatorPhrases[] = {
+    {"mayor o igual que", ">="},
+    {"mayor o igual a", ">="},
+    {"mayor que", ">"},
+    {"menor o igual que", "<="},
+    {"menor o igual a", "<="},
+    {"menor que", "<"},
+    {"igual a", "=="},
+    {"igual que", "=="},
+    {"diferente de", "!="},
+    {"distinto de", "!="},
+    {"multiplicado por", "*"},
+    {"dividido entre", "/"},
+    {"dividido por", "/"},
+    {"dividir", "/"},
+    {"entre", "/"},
+    {"modulo", "%"},
+    {"mas", "+"},
+    {"menos", "-"},
+    {"y", "&&"},
+    {"o", "||"},
+    {"no", "!"},
+};
+
+constexpr std::string_view firstWord(std::string_view phrase)
+{
+    return phrase.substr(0, phrase.find(' '));
+}
+
+constexpr int firstPhraseStartingWith(std::string_view word)
+{
+    for (std::size_t i = 0; i < std::size(operatorPhrases); ++i) {
+        if (firstWord(operatorPhrases[i].words) == word) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Primera frase de cada grupo; el grupo sigue mientras la primera palabra coincida.
+inline constexpr auto operatorPhraseStarts = makeTable<int>({
+    {"mayor", firstPhraseStartingWith("mayor")},
+    {"menor", firstPhraseStartingWith("menor")},
+    {"igual", firstPhraseStartingWith("igual")},
+    {"diferente", firstPhraseStartingWith("diferente")},
+    {"distinto", firstPhraseStartingWith("distinto")},
+    {"multiplicado", firstPhraseStartingWith("multiplicado")},
+    {"dividido", firstPhraseStartingWith("dividido")},
+    {"dividir", firstPhraseStartingWith("dividir")},
+    {"entre", firstPhraseStartingWith("entre")},
+    {"modulo", firstPhraseStartingWith("modulo")},
+    {"mas", firstPhraseStartingWith("mas")},
+    {"menos", firstPhraseStartingWith("menos")},
+    {"y", firstPhraseStartingWith("y")},
+    {"o", firstPhraseStartingWith("o")},
+    {"no", firstPhraseStartingWith("no")},
+});
+static_assert(operatorPhraseStarts.isPerfect(), "Primeras palabras de frases operador repetidas");
+
+constexpr bool operatorPhrasesAreGrouped()
+{
+    for (std::size_t i = 0; i < std::size(operatorPhrases); ++i) {
+        const std::string_view word = firstWord(operatorPhrases[i].words);
+        const int *start = operatorPhraseStarts.findKey(word);
+        if (!start || *start < 0) {
+            return false;
+        }
+        for (std::size_t j = static_cast<std::size_t>(*start); j < i; ++j) {
+            if (firstWord(operatorPhrases[j].words) != word) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+static_assert(operatorPhrasesAreGrouped(), "Cada frase operador debe estar en el grupo de su primera palabra");
+
+struct DeclaredType {
+    const char *cppType = "";
+    bool floating = false;
+};
+
+// Tipos que acepta "crear variable <tipo> <nombre>".
+inline constexpr auto variableTypes = makeTable<DeclaredType>({
+    {"numero decimal", {"double", true}},
+    {"numero entero", {"int", false}},
+    {"texto", {"std::string", false}},
+    {"cadena", {"std::string", false}},
+    {"booleano", {"bool", false}},
+});
+static_assert(variableTypes.isPerfect(), "Tipos de variable repetidos");
+
+struct TypeWord {
+    const char *cppType = "";
+    int rank = 0;
+};
+
+// Palabras que fijan el tipo de un parámetro, elemento o campo; si aparecen varias gana la de
+// menor rango, de modo que "numero decimal" es double y "cadena de texto" es std::string.
+inline constexpr auto typeWords = makeTable<TypeWord>({
+    {"texto", {"std::string", 0}},
+    {"textos", {"std::string", 0}},
+    {"cadena", {"std::string", 0}},
+    {"cadenas", {"std::string", 0}},
+    {"decimal", {"double", 1}},
+    {"decimales", {"double", 1}},
+    {"entero", {"int", 2}},
+    {"enteros", {"int", 2}},
+    {"booleano", {"bool", 3}},
+    {"booleanos", {"bool", 3}},
+    {"numero", {"int", 4}},
+    {"numeros", {"int", 4}},
+});
+static_assert(typeWords.isPerfect(), "Palabras de tipo repetidas");
+
+struct ArithmeticVerb {
+    const char *op = "";
+    bool useEntre = false;
+};
+
+inline constexpr auto arithmeticVerbs = makeTable<ArithmeticVerb>({
+    {"sumar", {"+", false}},
+    {"restar", {"-", false}},
+    {"multiplicar", {"*", false}},
+    {"dividir", {"/", true}},
+});
+static_assert(arithmeticVerbs.isPerfect(), "Verbos aritméticos repetidos");
+
+// Posición de un ordinal; -1 indica el último elemento.
+inline constexpr auto ordinals = makeTable<int>({
+    {"primer", 0},
+    {"segundo", 1},
+    {"tercer", 2},
+    {"cuarto", 3},
+    {"quinto", 4},
+    {"sexto", 5},
+    {"septimo", 6},
+    {"octavo", 7},
+    {"noveno", 8},
+    {"decimo", 9},
+    {"ultimo", -1},
+});
+static_assert(ordinals.isPerfect(), "Ordinales repetidos");
+
+}
+
+#endif
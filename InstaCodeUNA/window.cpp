@@ -13,10 +13,18 @@
 #include <QGraphicsDropShadowEffect>
 #include <QStyle>
 #include <QFileInfo>
+#include <QDir>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QColor>
 #include <QResizeEvent>
 #include <QEvent>
+#include <QInputDialog>
+#include <QtConcurrent>
 
 #include "parser.h"
+#include "interpreter.h"
+#include "runner.h"
 
 Window::Window(QWidget *parent)
     : QMainWindow(parent), isDarkTheme(false)
@@ -60,6 +68,20 @@ void Window::setupUI()
     dataButton = new QPushButton(" Cargar datos .txt");
     convertButton = new QPushButton(" Convertir a C++");
     exportButton = new QPushButton(" Exportar archivo .cpp");
+    runButton = new QPushButton(" Ejecutar programa");
+    compileRunButton = new QPushButton(" Compilar y ejecutar");
+    optimizationComboBox = new QComboBox;
+    optimizationComboBox->addItem("-O0", static_cast<int>(Runner::OptimizationLevel::O0));
+    optimizationComboBox->addItem("-O2", static_cast<int>(Runner::OptimizationLevel::O2));
+    optimizationComboBox->addItem("-O3 -march=native", static_cast<int>(Runner::OptimizationLevel::O3Native));
+    optimizationComboBox->setCurrentIndex(1);
+    optimizationComboBox->setToolTip("Nivel de optimización del compilador");
+    multipleFilesCheckBox = new QCheckBox("Varios archivos");
+    multipleFilesCheckBox->setToolTip("Separa funciones, tablas de datos y main en archivos propios para compilar en paralelo con make -j");
+    profileCheckBox = new QCheckBox("Perfilar");
+    profileCheckBox->setToolTip("Mide cuántas veces y cuánto tiempo se ejecuta cada línea de instrucciones");
+    precompiledHeaderCheckBox = new QCheckBox("PCH");
+    precompiledHeaderCheckBox->setToolTip("Genera un encabezado paraguas precompilado que se reutiliza entre compilaciones");
     themeButton = new QPushButton(" Cambiar Tema");
 
     QIcon loadIcon(":/images/folder.png");
@@ -71,6 +93,8 @@ void Window::setupUI()
     dataButton->setIcon(loadIcon);
     convertButton->setIcon(convertIcon);
     exportButton->setIcon(exportIcon);
+    runButton->setIcon(style()->standardIcon(QStyle::SP_MediaPlay));
+    compileRunButton->setIcon(convertIcon);
     themeButton->setIcon(themeIcon);
 
     QSize iconSize(17, 17);
@@ -78,12 +102,20 @@ void Window::setupUI()
     dataButton->setIconSize(iconSize);
     convertButton->setIconSize(iconSize);
     exportButton->setIconSize(iconSize);
+    runButton->setIconSize(iconSize);
+    compileRunButton->setIconSize(iconSize);
     themeButton->setIconSize(iconSize);
 
     loadButton->setObjectName("loadButton");
     dataButton->setObjectName("dataButton");
     convertButton->setObjectName("convertButton");
     exportButton->setObjectName("exportButton");
+    runButton->setObjectName("runButton");
+    compileRunButton->setObjectName("compileRunButton");
+    optimizationComboBox->setObjectName("optimizationComboBox");
+    precompiledHeaderCheckBox->setObjectName("precompiledHeaderCheckBox");
+    multipleFilesCheckBox->setObjectName("multipleFilesCheckBox");
+    profileCheckBox->setObjectName("profileCheckBox");
     themeButton->setObjectName("themeButton");
 
     QVBoxLayout *leftLayout = new QVBoxLayout;
@@ -94,7 +126,17 @@ void Window::setupUI()
 
     QVBoxLayout *rightLayout = new QVBoxLayout;
     rightLayout->addWidget(outputTextEdit);
-    rightLayout->addWidget(exportButton);
+    QHBoxLayout *exportLayout = new QHBoxLayout;
+    exportLayout->addWidget(exportButton, 1);
+    exportLayout->addWidget(multipleFilesCheckBox);
+    rightLayout->addLayout(exportLayout);
+    rightLayout->addWidget(runButton);
+    QHBoxLayout *compileLayout = new QHBoxLayout;
+    compileLayout->addWidget(compileRunButton, 1);
+    compileLayout->addWidget(optimizationComboBox);
+    compileLayout->addWidget(precompiledHeaderCheckBox);
+    compileLayout->addWidget(profileCheckBox);
+    rightLayout->addLayout(compileLayout);
     rightLayout->addWidget(themeButton);
 
     QHBoxLayout *centerLayout = new QHBoxLayout;
@@ -116,7 +158,25 @@ void Window::setupUI()
     connect(dataButton, &QPushButton::clicked, this, &Window::loadDataFile);
     connect(convertButton, &QPushButton::clicked, this, &Window::convertToCpp);
     connect(exportButton, &QPushButton::clicked, this, &Window::exportCppFile);
+    connect(runButton, &QPushButton::clicked, this, &Window::runProgram);
+    connect(&m_interpreterWatcher, &QFutureWatcher<Interpreter::Output>::finished, this, &Window::showInterpreterResult);
+    connect(compileRunButton, &QPushButton::clicked, this, &Window::compileAndRun);
     connect(themeButton, &QPushButton::clicked, this, &Window::toggleTheme);
+    connect(inputTextEdit, &QTextEdit::textChanged, this, [this]
+            {
+                diagnosticSelections.clear();
+                profileSelections.clear();
+                applyInputSelections();
+                sourceGeneratedLines.clear();
+            });
+    connect(outputTextEdit, &QTextEdit::textChanged, this, [this]
+            {
+                outputTextEdit->setExtraSelections(QList<QTextEdit::ExtraSelection>());
+                generatedSourceLines.clear();
+                generatedFiles.clear();
+            });
+    connect(inputTextEdit, &QTextEdit::cursorPositionChanged, this, &Window::followInputCursor);
+    connect(outputTextEdit, &QTextEdit::cursorPositionChanged, this, &Window::followOutputCursor);
 }
 
 void Window::loadFile()
@@ -169,6 +229,17 @@ void Window::loadDataFile()
     }
 }
 
+Parser::Input Window::currentParserInput() const
+{
+    Parser::Input parserInput;
+    parserInput.instructions = inputTextEdit->toPlainText();
+    parserInput.dataFileContents = dataFileContents;
+    parserInput.dataFileName = dataFilePath.isEmpty() ? QString() : QFileInfo(dataFilePath).fileName();
+    parserInput.umbrellaHeader = precompiledHeaderCheckBox->isChecked();
+    parserInput.multipleFiles = multipleFilesCheckBox->isChecked();
+    return parserInput;
+}
+
 void Window::convertToCpp()
 {
     hideAlert();
@@ -180,13 +251,19 @@ void Window::convertToCpp()
         outputTextEdit->clear();
         return;
     }
-    Parser::Input parserInput;
-    parserInput.instructions = input;
-    parserInput.dataFileContents = dataFileContents;
-    parserInput.dataFileName = dataFilePath.isEmpty() ? QString() : QFileInfo(dataFilePath).fileName();
-
-    Parser::Output parserOutput = Parser::convert(parserInput);
+    Parser::Output parserOutput = Parser::convert(currentParserInput());
     outputTextEdit->setPlainText(parserOutput.code);
+    generatedIncludes = parserOutput.includes;
+    generatedFiles = parserOutput.files;
+    generatedSourceLines = parserOutput.sourceLines;
+    sourceGeneratedLines = parserOutput.generatedLines;
+    showDiagnosticsOverlay(parserOutput.diagnostics);
+
+    QStringList diagnostics;
+    for (const Parser::Diagnostic &diagnostic : parserOutput.diagnostics)
+    {
+        diagnostics << Parser::describeDiagnostic(diagnostic);
+    }
 
     if (!parserOutput.success)
     {
@@ -200,6 +277,18 @@ void Window::convertToCpp()
                   "Conversión con observaciones",
                   parserOutput.issues.join("\n"));
     }
+    else if (!diagnostics.isEmpty())
+    {
+        showAlert(AlertType::Warning,
+                  "Posibles problemas de rendimiento",
+                  diagnostics.join("\n"));
+    }
+    else if (!parserOutput.optimizationNotes.isEmpty())
+    {
+        showAlert(AlertType::Success,
+                  "Conversión completada",
+                  "El código C++ se generó correctamente.\n\n" + parserOutput.optimizationNotes.join("\n"));
+    }
     else
     {
         showAlert(AlertType::Success,
@@ -211,6 +300,11 @@ void Window::convertToCpp()
 
 void Window::exportCppFile()
 {
+    if (multipleFilesCheckBox->isChecked())
+    {
+        exportSourceDirectory();
+        return;
+    }
     QString fileName = QFileDialog::getSaveFileName(this, "Guardar archivo como", "codigo_generado.cpp", "C++ Files (*.cpp)");
     if (!fileName.isEmpty())
     {
@@ -220,6 +314,18 @@ void Window::exportCppFile()
             QTextStream out(&file);
             out << outputTextEdit->toPlainText();
             file.close();
+            if (outputTextEdit->toPlainText().contains(Parser::umbrellaHeaderName()))
+            {
+                QFile header(QFileInfo(fileName).dir().filePath(Parser::umbrellaHeaderName()));
+                if (!header.open(QIODevice::WriteOnly | QIODevice::Text))
+                {
+                    showAlert(AlertType::Error, "No se pudo guardar",
+                              "No se pudo escribir " + Parser::umbrellaHeaderName() + " junto al archivo C++.");
+                    return;
+                }
+                QTextStream headerOut(&header);
+                headerOut << Parser::umbrellaHeaderContents(generatedIncludes);
+            }
             showAlert(AlertType::Success, "Exportación completada",
                       "El archivo C++ se guardó correctamente.", 2500);
         }
@@ -231,6 +337,297 @@ void Window::exportCppFile()
     }
 }
 
+void Window::exportSourceDirectory()
+{
+    if (generatedFiles.isEmpty())
+    {
+        showAlert(AlertType::Warning, "Sin archivos",
+                  "Convierte las instrucciones con \"Varios archivos\" marcado antes de exportar. "
+                  "Si editaste el código, vuelve a convertir: los archivos separados no incluyen los cambios.");
+        return;
+    }
+    QString directory = QFileDialog::getExistingDirectory(this, "Carpeta donde guardar el proyecto");
+    if (directory.isEmpty())
+    {
+        return;
+    }
+
+    QList<Parser::SourceFile> files = generatedFiles;
+    if (outputTextEdit->toPlainText().contains(Parser::umbrellaHeaderName()))
+    {
+        files.append({Parser::umbrellaHeaderName(), Parser::umbrellaHeaderContents(generatedIncludes)});
+    }
+    for (const Parser::SourceFile &source : files)
+    {
+        QFile file(QDir(directory).filePath(source.name));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            showAlert(AlertType::Error, "No se pudo guardar",
+                      "No se pudo escribir " + source.name + ". Intenta otra ubicación o revisa permisos.");
+            return;
+        }
+        QTextStream out(&file);
+        out << source.contents;
+    }
+    showAlert(AlertType::Success, "Exportación completada",
+              QString("Se guardaron %1 archivos. Compila con \"make -j\" dentro de la carpeta.").arg(files.size()),
+              3500);
+}
+
+bool Window::askProgramInput(const QString &code, QString &input)
+{
+    if (!code.contains("cin >>"))
+    {
+        input.clear();
+        return true;
+    }
+    bool accepted = false;
+    const QString text = QInputDialog::getMultiLineText(this, "Entrada del programa",
+                                                        "Valores que leerá el programa (separados por espacios o saltos de línea):",
+                                                        programInput, &accepted);
+    if (!accepted)
+    {
+        return false;
+    }
+    programInput = text;
+    input = text;
+    return true;
+}
+
+QString Window::outputPreview(const QString &output) const
+{
+    QStringList lines = output.split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty())
+    {
+        lines.removeLast();
+    }
+    const int shownLines = 40;
+    QString shown = QStringList(lines.mid(0, shownLines)).join("\n");
+    if (lines.size() > shownLines)
+    {
+        shown += QString("\n… (%1 líneas más)").arg(lines.size() - shownLines);
+    }
+    return shown.isEmpty() ? QString("El programa no mostró ninguna salida.") : shown;
+}
+
+void Window::runProgram()
+{
+    hideAlert();
+    const QString code = outputTextEdit->toPlainText();
+    if (code.trimmed().isEmpty())
+    {
+        showAlert(AlertType::Warning, "Sin código",
+                  "Primero convierte las instrucciones a C++.");
+        return;
+    }
+
+    Interpreter::Input interpreterInput;
+    interpreterInput.code = code;
+    if (!askProgramInput(code, interpreterInput.standardInput))
+    {
+        return;
+    }
+
+    runButton->setEnabled(false);
+    QApplication::setOverrideCursor(Qt::BusyCursor);
+    m_interpreterTimer.start();
+    m_interpreterWatcher.setFuture(QtConcurrent::run(Interpreter::run, interpreterInput));
+}
+
+void Window::showInterpreterResult()
+{
+    QApplication::restoreOverrideCursor();
+    runButton->setEnabled(true);
+    const Interpreter::Output result = m_interpreterWatcher.result();
+    const qint64 elapsed = m_interpreterTimer.elapsed();
+
+    const QString summary = QString("%1 instrucciones ejecutadas en %2 ms.")
+                                .arg(result.executedInstructions)
+                                .arg(elapsed);
+    if (!result.success)
+    {
+        QString message = result.errors.join("\n");
+        if (!result.standardOutput.isEmpty())
+        {
+            message += "\n\nSalida parcial:\n" + outputPreview(result.standardOutput);
+        }
+        showAlert(AlertType::Error, "Error durante la ejecución", message + "\n\n" + summary);
+        return;
+    }
+    showAlert(AlertType::Success,
+              "Ejecución completada",
+              outputPreview(result.standardOutput) + "\n\n" + summary);
+}
+
+void Window::compileAndRun()
+{
+    hideAlert();
+    const QString code = outputTextEdit->toPlainText();
+    if (code.trimmed().isEmpty())
+    {
+        showAlert(AlertType::Warning, "Sin código",
+                  "Primero convierte las instrucciones a C++.");
+        return;
+    }
+
+    Runner::Input runnerInput;
+    runnerInput.code = code;
+    runnerInput.includes = generatedIncludes;
+    runnerInput.optimization = static_cast<Runner::OptimizationLevel>(optimizationComboBox->currentData().toInt());
+    if (profileCheckBox->isChecked())
+    {
+        Parser::Input parserInput = currentParserInput();
+        parserInput.multipleFiles = false;
+        parserInput.profile = true;
+        const Parser::Output instrumented = Parser::convert(parserInput);
+        if (!instrumented.success)
+        {
+            showAlert(AlertType::Error, "No se pudo perfilar", instrumented.issues.join("\n"));
+            return;
+        }
+        runnerInput.code = instrumented.code;
+        runnerInput.includes = instrumented.includes;
+    }
+    if (!askProgramInput(code, runnerInput.standardInput))
+    {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const Runner::Output result = Runner::run(runnerInput);
+    QApplication::restoreOverrideCursor();
+    showProfileOverlay(result.profile);
+
+    if (!result.compiled)
+    {
+        QStringList messages = result.compilerMessages.split('\n');
+        if (messages.size() > 20)
+        {
+            messages = QStringList(messages.mid(0, 20)) << "…";
+        }
+        showAlert(AlertType::Error, "No se pudo compilar",
+                  result.errors.join("\n") + (result.compilerMessages.isEmpty() ? QString() : "\n\n" + messages.join("\n")));
+        return;
+    }
+
+    const Runner::CacheStatistics cache = Runner::cacheStatistics();
+    QString summary = Runner::describe(result) +
+                      QString("\nCaché: %1 aciertos, %2 fallos en esta sesión.").arg(cache.hits).arg(cache.misses);
+    if (!result.profile.isEmpty())
+    {
+        summary += "\n\nLíneas más costosas:\n" + Runner::describeProfile(result.profile, 5);
+    }
+    if (!result.success)
+    {
+        QString message = result.errors.join("\n");
+        if (!result.standardOutput.isEmpty())
+        {
+            message += "\n\nSalida parcial:\n" + outputPreview(result.standardOutput);
+        }
+        showAlert(AlertType::Error, "Error durante la ejecución", message + "\n\n" + summary);
+        return;
+    }
+    showAlert(AlertType::Success,
+              "Ejecución completada",
+              outputPreview(result.standardOutput) + "\n\n" + summary);
+}
+
+void Window::showProfileOverlay(const QList<Runner::ProfileLine> &profile)
+{
+    qint64 hottest = 0;
+    for (const Runner::ProfileLine &line : profile)
+    {
+        hottest = qMax(hottest, line.nanoseconds);
+    }
+
+    profileSelections.clear();
+    for (const Runner::ProfileLine &line : profile)
+    {
+        const QTextBlock block = inputTextEdit->document()->findBlockByNumber(line.line - 1);
+        if (!block.isValid() || hottest == 0)
+        {
+            continue;
+        }
+        const double heat = static_cast<double>(line.nanoseconds) / hottest;
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = QTextCursor(block);
+        selection.format.setBackground(QColor(230, 70, 40, 25 + static_cast<int>(175 * heat)));
+        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+        profileSelections.append(selection);
+    }
+    applyInputSelections();
+}
+
+void Window::showDiagnosticsOverlay(const QList<Parser::Diagnostic> &diagnostics)
+{
+    diagnosticSelections.clear();
+    for (const Parser::Diagnostic &diagnostic : diagnostics)
+    {
+        const QTextBlock block = inputTextEdit->document()->findBlockByNumber(diagnostic.line);
+        if (!block.isValid())
+        {
+            continue;
+        }
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = QTextCursor(block);
+        selection.cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        selection.format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+        selection.format.setUnderlineColor(QColor(230, 150, 20));
+        diagnosticSelections.append(selection);
+    }
+    applyInputSelections();
+}
+
+void Window::applyInputSelections()
+{
+    inputTextEdit->setExtraSelections(profileSelections + diagnosticSelections);
+}
+
+void Window::followInputCursor()
+{
+    const int line = inputTextEdit->textCursor().blockNumber();
+    if (syncingPanes || line >= sourceGeneratedLines.size() || generatedSourceLines.isEmpty())
+    {
+        return;
+    }
+    const int first = sourceGeneratedLines[line];
+    QList<QTextEdit::ExtraSelection> selections;
+    if (first >= 0)
+    {
+        QTextBlock block = outputTextEdit->document()->findBlockByNumber(first);
+        for (int i = first; block.isValid() && i < generatedSourceLines.size() && generatedSourceLines[i] == line; ++i)
+        {
+            QTextEdit::ExtraSelection selection;
+            selection.cursor = QTextCursor(block);
+            selection.format.setBackground(QColor(60, 140, 220, 60));
+            selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+            selections.append(selection);
+            block = block.next();
+        }
+
+        syncingPanes = true;
+        QTextCursor cursor(outputTextEdit->document()->findBlockByNumber(first));
+        outputTextEdit->setTextCursor(cursor);
+        outputTextEdit->ensureCursorVisible();
+        syncingPanes = false;
+    }
+    outputTextEdit->setExtraSelections(selections);
+}
+
+void Window::followOutputCursor()
+{
+    const int line = outputTextEdit->textCursor().blockNumber();
+    if (syncingPanes || line >= generatedSourceLines.size() || generatedSourceLines[line] < 0 || sourceGeneratedLines.isEmpty())
+    {
+        return;
+    }
+    syncingPanes = true;
+    QTextCursor cursor(inputTextEdit->document()->findBlockByNumber(generatedSourceLines[line]));
+    inputTextEdit->setTextCursor(cursor);
+    inputTextEdit->ensureCursorVisible();
+    syncingPanes = false;
+}
+
 void Window::toggleTheme()
 {
     isDarkTheme = !isDarkTheme;
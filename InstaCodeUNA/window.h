@@ -4,12 +4,21 @@
 #include <QMainWindow>
 #include <QTextEdit>
 #include <QPushButton>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QStringList>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QWidget>
 #include <QString>
 #include <QLabel>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+
+#include "interpreter.h"
+#include "parser.h"
+#include "runner.h"
 
 class Window : public QMainWindow
 {
@@ -32,6 +41,9 @@ private slots:
     void loadDataFile();
     void convertToCpp();
     void exportCppFile();
+    void runProgram();
+    void showInterpreterResult();
+    void compileAndRun();
     void toggleTheme();
 
     void showAlert(AlertType type,
@@ -50,6 +62,15 @@ private:
 
     void setupUI();
     void applyStylesheet(const QString &path);
+    bool askProgramInput(const QString &code, QString &input);
+    QString outputPreview(const QString &output) const;
+    void exportSourceDirectory();
+    Parser::Input currentParserInput() const;
+    void showProfileOverlay(const QList<Runner::ProfileLine> &profile);
+    void showDiagnosticsOverlay(const QList<Parser::Diagnostic> &diagnostics);
+    void applyInputSelections();
+    void followInputCursor();
+    void followOutputCursor();
 
     QTextEdit *inputTextEdit;
     QTextEdit *outputTextEdit;
@@ -57,11 +78,25 @@ private:
     QPushButton *dataButton;
     QPushButton *convertButton;
     QPushButton *exportButton;
+    QPushButton *runButton;
+    QPushButton *compileRunButton;
+    QComboBox *optimizationComboBox;
+    QCheckBox *precompiledHeaderCheckBox;
+    QCheckBox *multipleFilesCheckBox;
+    QCheckBox *profileCheckBox;
     QPushButton *themeButton;
 
     bool isDarkTheme;
     QString dataFilePath;
     QString dataFileContents;
+    QString programInput;
+    QStringList generatedIncludes;
+    QList<Parser::SourceFile> generatedFiles;
+    QVector<int> generatedSourceLines;
+    QVector<int> sourceGeneratedLines;
+    QList<QTextEdit::ExtraSelection> diagnosticSelections;
+    QList<QTextEdit::ExtraSelection> profileSelections;
+    bool syncingPanes = false;
 
     QWidget *m_alertOverlay = nullptr;
     QWidget *m_alertCard = nullptr;
@@ -70,6 +105,9 @@ private:
     QLabel *m_alertMessage = nullptr;
     QPushButton *m_alertClose = nullptr;
     QTimer m_alertTimer;
+
+    QFutureWatcher<Interpreter::Output> m_interpreterWatcher;
+    QElapsedTimer m_interpreterTimer;
 };
 
 #endif